@@ -0,0 +1,411 @@
+#ifndef CompactLocationGraph_hpp
+#define CompactLocationGraph_hpp
+
+// Подключение стандартных библиотек
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+// Подключение внутренних типов
+#include "CalcNumber.hpp"
+#include "LocationGraphNode.hpp"
+#include "LocationGraph.hpp"
+
+/// Неизменяемое компактное представление графа локации. Узлы пронумерованы плотными 32-битными индексами в порядке массива LocationGraph::nodePs. Границы узлов хранятся в отдельных непрерывных массивах (структура массивов), связи всех узлов - в одном непрерывном массиве в сжатом строчном формате (CSR): связи узла занимают в нем непрерывный диапазон, для каждой связи хранится индекс смежного узла и сторона узла, на которой он лежит. Перебор смежных узлов не требует выделения памяти, а все массивы состоят из тривиально копируемых элементов, поэтому копирование представления сводится к копированию блоков памяти. Представление строится после окончания изменения графа локации и при последующих изменениях графа не обновляется.
+class CompactLocationGraph {
+    
+public:
+    
+    // MARK: - Вспомогательные типы
+    
+    /// Сторона узла, на которой лежит смежный узел.
+    enum Side {
+        
+        /// Смежный узел лежит слева.
+        leftSide,
+        
+        /// Смежный узел лежит справа.
+        rightSide,
+        
+        /// Смежный узел лежит снизу.
+        bottomSide,
+        
+        /// Смежный узел лежит сверху.
+        topSide
+        
+    };
+    
+    /// Связь узла со смежным узлом.
+    struct Edge {
+        
+        /// Индекс смежного узла.
+        unsigned int nodeIndex;
+        
+        /// Сторона узла, на которой лежит смежный узел.
+        Side side;
+        
+    };
+    
+    /// Диапазон связей узла. Ссылается на массив связей представления и действителен, пока существует представление.
+    struct EdgeRange {
+        
+        /// Указатель на первую связь диапазона.
+        const Edge * beginP;
+        
+        /// Указатель на позицию за последней связью диапазона.
+        const Edge * endP;
+        
+        /// Вернуть указатель на первую связь диапазона.
+        ///
+        /// \return Указатель на первую связь.
+        const Edge * begin() const;
+        
+        /// Вернуть указатель на позицию за последней связью диапазона.
+        ///
+        /// \return Указатель на позицию за последней связью.
+        const Edge * end() const;
+        
+        /// Вернуть число связей в диапазоне.
+        ///
+        /// \return Число связей.
+        unsigned long size() const;
+        
+    };
+    
+    // MARK: - Открытые объекты
+    
+    /// Значение индекса, обозначающее отсутствие узла.
+    static constexpr unsigned int noIndex = std::numeric_limits<unsigned int>::max();
+    
+private:
+    
+    // MARK: - Скрытые объекты
+    
+    /// X-координаты левых краев узлов (единица измерения - мм.).
+    std::vector<CalcNumber> lefts;
+    
+    /// X-координаты правых краев узлов (единица измерения - мм.).
+    std::vector<CalcNumber> rights;
+    
+    /// Y-координаты нижних краев узлов (единица измерения - мм.).
+    std::vector<CalcNumber> bottoms;
+    
+    /// Y-координаты верхних краев узлов (единица измерения - мм.).
+    std::vector<CalcNumber> tops;
+    
+    /// Начала диапазонов связей узлов в массиве edges. Диапазон узла с индексом index занимает позиции от edgesStarts[index] до edgesStarts[index + 1].
+    std::vector<unsigned int> edgesStarts;
+    
+    /// Связи всех узлов. Связи узла упорядочены так же, как в LocationGraphNode::adjacentNodesIds(): левые, правые, нижние, верхние.
+    std::vector<Edge> edges;
+    
+    /// Указатели на узлы исходного графа локации по индексу.
+    std::vector<const LocationGraphNode*> nodePs;
+    
+    /// Индексы узлов по идентификатору. Для отсутствующих идентификаторов содержит noIndex.
+    std::vector<unsigned int> indexForId;
+    
+public:
+    
+    // MARK: - Конструкторы
+    
+    /// Конструктор. Создается пустое представление, не содержащее узлов.
+    explicit CompactLocationGraph();
+    
+    /// Конструктор. Представление строится по текущим узлам и связям графа локации.
+    ///
+    /// \param locationGraph Граф локации. Идентификаторы узлов графа должны быть уникальны.
+    explicit CompactLocationGraph(const LocationGraph & locationGraph);
+    
+    // MARK: - Открытые методы
+    
+    /// Вернуть число узлов.
+    ///
+    /// \return Число узлов.
+    unsigned int nodesCount() const;
+    
+    /// Вернуть индекс узла.
+    ///
+    /// \param nodeP Указатель на узел графа локации.
+    ///
+    /// \return Индекс узла или noIndex, если узел отсутствовал в графе при построении представления.
+    unsigned int indexOf(const LocationGraphNode * nodeP) const;
+    
+    /// Вернуть указатель на узел исходного графа локации по индексу.
+    ///
+    /// \param index Индекс узла.
+    ///
+    /// \return Указатель на узел.
+    const LocationGraphNode * nodeP(unsigned int index) const;
+    
+    /// Вернуть X-координату левого края узла.
+    ///
+    /// \param index Индекс узла.
+    ///
+    /// \return X-координата левого края узла (единица измерения - мм.).
+    CalcNumber left(unsigned int index) const;
+    
+    /// Вернуть X-координату правого края узла.
+    ///
+    /// \param index Индекс узла.
+    ///
+    /// \return X-координата правого края узла (единица измерения - мм.).
+    CalcNumber right(unsigned int index) const;
+    
+    /// Вернуть Y-координату нижнего края узла.
+    ///
+    /// \param index Индекс узла.
+    ///
+    /// \return Y-координата нижнего края узла (единица измерения - мм.).
+    CalcNumber bottom(unsigned int index) const;
+    
+    /// Вернуть Y-координату верхнего края узла.
+    ///
+    /// \param index Индекс узла.
+    ///
+    /// \return Y-координата верхнего края узла (единица измерения - мм.).
+    CalcNumber top(unsigned int index) const;
+    
+    /// Вернуть диапазон связей узла.
+    ///
+    /// \param index Индекс узла.
+    ///
+    /// \return Диапазон связей узла.
+    EdgeRange edgesOf(unsigned int index) const;
+    
+    /// Вернуть общее число связей всех узлов.
+    ///
+    /// \return Число связей.
+    unsigned int edgesCount() const;
+    
+    /// Вернуть индекс связи в массиве связей всех узлов. Индексы связей плотные, поэтому могут использоваться для хранения сведений о связях в отдельных массивах.
+    ///
+    /// \param edge Связь из диапазона, возвращенного методом edgesOf.
+    ///
+    /// \return Индекс связи.
+    unsigned int edgeIndexOf(const Edge & edge) const;
+    
+    /// Найти сторону узла с индексом index, на которой лежит смежный узел с индексом adjacentIndex.
+    ///
+    /// \param index Индекс узла.
+    /// \param adjacentIndex Индекс смежного узла.
+    /// \param side Найденная сторона.
+    ///
+    /// \return true, если узлы смежны, иначе false.
+    bool findSide(unsigned int index, unsigned int adjacentIndex, Side & side) const;
+    
+};
+
+// MARK: - Реализация
+
+/// Вернуть указатель на первую связь диапазона.
+///
+/// \return Указатель на первую связь.
+const CompactLocationGraph::Edge * CompactLocationGraph::EdgeRange::begin() const {
+    
+    return beginP;
+    
+}
+
+/// Вернуть указатель на позицию за последней связью диапазона.
+///
+/// \return Указатель на позицию за последней связью.
+const CompactLocationGraph::Edge * CompactLocationGraph::EdgeRange::end() const {
+    
+    return endP;
+    
+}
+
+/// Вернуть число связей в диапазоне.
+///
+/// \return Число связей.
+unsigned long CompactLocationGraph::EdgeRange::size() const {
+    
+    return endP - beginP;
+    
+}
+
+/// Конструктор. Создается пустое представление, не содержащее узлов.
+CompactLocationGraph::CompactLocationGraph(): edgesStarts(1, 0) {}
+
+/// Конструктор. Представление строится по текущим узлам и связям графа локации.
+///
+/// \param locationGraph Граф локации. Идентификаторы узлов графа должны быть уникальны.
+CompactLocationGraph::CompactLocationGraph(const LocationGraph & locationGraph) {
+    
+    unsigned int count = static_cast<unsigned int>(locationGraph.nodePs.size());
+    unsigned int maxId = 0;
+    
+    lefts.reserve(count);
+    rights.reserve(count);
+    bottoms.reserve(count);
+    tops.reserve(count);
+    nodePs.reserve(count);
+    edgesStarts.reserve(count + 1);
+    edgesStarts.push_back(0);
+    
+    for (const LocationGraphNode * locationNodeP : locationGraph.nodePs) {
+        lefts.push_back(locationNodeP->left);
+        rights.push_back(locationNodeP->right);
+        bottoms.push_back(locationNodeP->bottom);
+        tops.push_back(locationNodeP->top);
+        nodePs.push_back(locationNodeP);
+        edgesStarts.push_back(edgesStarts[edgesStarts.size() - 1] + static_cast<unsigned int>(locationNodeP->leftNodesIds.size() + locationNodeP->rightNodesIds.size() + locationNodeP->bottomNodesIds.size() + locationNodeP->topNodesIds.size()));
+        maxId = std::max(maxId, locationNodeP->id);
+    }
+    
+    indexForId.assign(maxId + 1, noIndex);
+    for (unsigned int index = 0; index < count; index++) {
+        indexForId[nodePs[index]->id] = index;
+    }
+    
+    edges.reserve(edgesStarts[count]);
+    for (const LocationGraphNode * locationNodeP : locationGraph.nodePs) {
+        for (unsigned int adjacentNodeId : locationNodeP->leftNodesIds) {
+            edges.push_back(Edge { indexForId[adjacentNodeId], leftSide });
+        }
+        for (unsigned int adjacentNodeId : locationNodeP->rightNodesIds) {
+            edges.push_back(Edge { indexForId[adjacentNodeId], rightSide });
+        }
+        for (unsigned int adjacentNodeId : locationNodeP->bottomNodesIds) {
+            edges.push_back(Edge { indexForId[adjacentNodeId], bottomSide });
+        }
+        for (unsigned int adjacentNodeId : locationNodeP->topNodesIds) {
+            edges.push_back(Edge { indexForId[adjacentNodeId], topSide });
+        }
+    }
+    
+}
+
+/// Вернуть число узлов.
+///
+/// \return Число узлов.
+unsigned int CompactLocationGraph::nodesCount() const {
+    
+    return static_cast<unsigned int>(nodePs.size());
+    
+}
+
+/// Вернуть индекс узла.
+///
+/// \param nodeP Указатель на узел графа локации.
+///
+/// \return Индекс узла или noIndex, если узел отсутствовал в графе при построении представления.
+unsigned int CompactLocationGraph::indexOf(const LocationGraphNode * nodeP) const {
+    
+    if (nodeP->id >= indexForId.size()) {
+        return noIndex;
+    }
+    
+    unsigned int index = indexForId[nodeP->id];
+    return (index != noIndex && nodePs[index] == nodeP) ? index : noIndex;
+    
+}
+
+/// Вернуть указатель на узел исходного графа локации по индексу.
+///
+/// \param index Индекс узла.
+///
+/// \return Указатель на узел.
+const LocationGraphNode * CompactLocationGraph::nodeP(unsigned int index) const {
+    
+    return nodePs[index];
+    
+}
+
+/// Вернуть X-координату левого края узла.
+///
+/// \param index Индекс узла.
+///
+/// \return X-координата левого края узла (единица измерения - мм.).
+CalcNumber CompactLocationGraph::left(unsigned int index) const {
+    
+    return lefts[index];
+    
+}
+
+/// Вернуть X-координату правого края узла.
+///
+/// \param index Индекс узла.
+///
+/// \return X-координата правого края узла (единица измерения - мм.).
+CalcNumber CompactLocationGraph::right(unsigned int index) const {
+    
+    return rights[index];
+    
+}
+
+/// Вернуть Y-координату нижнего края узла.
+///
+/// \param index Индекс узла.
+///
+/// \return Y-координата нижнего края узла (единица измерения - мм.).
+CalcNumber CompactLocationGraph::bottom(unsigned int index) const {
+    
+    return bottoms[index];
+    
+}
+
+/// Вернуть Y-координату верхнего края узла.
+///
+/// \param index Индекс узла.
+///
+/// \return Y-координата верхнего края узла (единица измерения - мм.).
+CalcNumber CompactLocationGraph::top(unsigned int index) const {
+    
+    return tops[index];
+    
+}
+
+/// Вернуть диапазон связей узла.
+///
+/// \param index Индекс узла.
+///
+/// \return Диапазон связей узла.
+CompactLocationGraph::EdgeRange CompactLocationGraph::edgesOf(unsigned int index) const {
+    
+    return EdgeRange { edges.data() + edgesStarts[index], edges.data() + edgesStarts[index + 1] };
+    
+}
+
+/// Вернуть общее число связей всех узлов.
+///
+/// \return Число связей.
+unsigned int CompactLocationGraph::edgesCount() const {
+    
+    return static_cast<unsigned int>(edges.size());
+    
+}
+
+/// Вернуть индекс связи в массиве связей всех узлов. Индексы связей плотные, поэтому могут использоваться для хранения сведений о связях в отдельных массивах.
+///
+/// \param edge Связь из диапазона, возвращенного методом edgesOf.
+///
+/// \return Индекс связи.
+unsigned int CompactLocationGraph::edgeIndexOf(const Edge & edge) const {
+    
+    return static_cast<unsigned int>(&edge - edges.data());
+    
+}
+
+/// Найти сторону узла с индексом index, на которой лежит смежный узел с индексом adjacentIndex.
+///
+/// \param index Индекс узла.
+/// \param adjacentIndex Индекс смежного узла.
+/// \param side Найденная сторона.
+///
+/// \return true, если узлы смежны, иначе false.
+bool CompactLocationGraph::findSide(unsigned int index, unsigned int adjacentIndex, Side & side) const {
+    
+    for (const Edge & edge : edgesOf(index)) {
+        if (edge.nodeIndex == adjacentIndex) {
+            side = edge.side;
+            return true;
+        }
+    }
+    
+    return false;
+    
+}
+
+#endif /* CompactLocationGraph_hpp */
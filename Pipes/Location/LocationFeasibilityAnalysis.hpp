@@ -0,0 +1,232 @@
+#ifndef LocationFeasibilityAnalysis_hpp
+#define LocationFeasibilityAnalysis_hpp
+
+// Подключение стандартных библиотек
+#include <vector>
+#include <string>
+#include <utility>
+#include <algorithm>
+#include <chrono>
+
+// Подключение внутренних типов
+#include "CalcNumber.hpp"
+#include "Exception.hpp"
+#include "LocationGraphNode.hpp"
+#include "CompactLocationGraph.hpp"
+#include "LocationPassabilityTable.hpp"
+
+/// Предварительный анализ выполнимости построения трассы по графу локации с добавленными объектами подключения воды. Анализ находит компоненты связности графа, проверяет достижимость стока из узла каждого источника по проходам, ширина которых не меньше внешнего диаметра источника, и находит узлы-сочленения - узлы, удаление которых нарушает связность графа (все пути между частями графа проходят через такие узлы). Все найденные проблемы собираются в один отчет, поэтому некорректные исходные данные отвергаются за время O(n + e) без поиска путей.
+class LocationFeasibilityAnalysis {
+    
+public:
+    
+    // MARK: - Открытые объекты
+    
+    /// Число компонент связности графа локации без учета ширины проходов.
+    unsigned int componentsCount;
+    
+    /// Указатели на узлы-сочленения графа локации без учета ширины проходов в порядке индексов компактного представления.
+    std::vector<const LocationGraphNode*> articulationNodePs;
+    
+    /// Описания найденных проблем, препятствующих построению трассы.
+    std::vector<std::string> problems;
+    
+    /// Время, затраченное на анализ (единица измерения - мс.).
+    CalcNumber durationMilliseconds;
+    
+    // MARK: - Конструкторы
+    
+    /// Конструктор. Анализ выполняется при создании объекта.
+    ///
+    /// \param compactLocationGraph Компактное представление графа локации с добавленными объектами подключения воды.
+    /// \param locationPassabilityTable Таблица проходимости, построенная по тому же компактному представлению.
+    /// \param waterDestinationNodeP Указатель на узел графа локации, содержащий сток, или nullptr.
+    explicit LocationFeasibilityAnalysis(const CompactLocationGraph & compactLocationGraph, const LocationPassabilityTable & locationPassabilityTable, const LocationGraphNode * waterDestinationNodeP);
+    
+    // MARK: - Открытые методы
+    
+    /// Проверить, найдены ли проблемы, препятствующие построению трассы.
+    ///
+    /// \return true, если проблемы не найдены, иначе false.
+    bool isFeasible() const;
+    
+    /// Бросить Exception-исключение, содержащее описания всех найденных проблем, если они есть.
+    void throwIfNotFeasible() const;
+    
+private:
+    
+    // MARK: - Скрытые методы
+    
+    /// Найти узлы-сочленения (алгоритм Тарьяна, обход в глубину без рекурсии).
+    ///
+    /// \param compactLocationGraph Компактное представление графа локации.
+    void findArticulationNodes(const CompactLocationGraph & compactLocationGraph);
+    
+};
+
+// MARK: - Реализация
+
+/// Конструктор. Анализ выполняется при создании объекта.
+///
+/// \param compactLocationGraph Компактное представление графа локации с добавленными объектами подключения воды.
+/// \param locationPassabilityTable Таблица проходимости, построенная по тому же компактному представлению.
+/// \param waterDestinationNodeP Указатель на узел графа локации, содержащий сток, или nullptr.
+LocationFeasibilityAnalysis::LocationFeasibilityAnalysis(const CompactLocationGraph & compactLocationGraph, const LocationPassabilityTable & locationPassabilityTable, const LocationGraphNode * waterDestinationNodeP): componentsCount(0), durationMilliseconds(0) {
+    
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    unsigned int nodesCount = compactLocationGraph.nodesCount();
+    
+    // 1. Компоненты связности без учета ширины проходов.
+    
+    std::vector<unsigned int> componentForNode(nodesCount, CompactLocationGraph::noIndex);
+    std::vector<unsigned int> stack;
+    for (unsigned int startIndex = 0; startIndex < nodesCount; startIndex++) {
+        if (componentForNode[startIndex] != CompactLocationGraph::noIndex) {
+            continue;
+        }
+        componentForNode[startIndex] = componentsCount;
+        stack.push_back(startIndex);
+        while (stack.size() > 0) {
+            unsigned int nodeIndex = stack[stack.size() - 1];
+            stack.pop_back();
+            for (const CompactLocationGraph::Edge & edge : compactLocationGraph.edgesOf(nodeIndex)) {
+                if (componentForNode[edge.nodeIndex] == CompactLocationGraph::noIndex) {
+                    componentForNode[edge.nodeIndex] = componentsCount;
+                    stack.push_back(edge.nodeIndex);
+                }
+            }
+        }
+        componentsCount++;
+    }
+    
+    // 2. Проверка достижимости стока из узла каждого источника.
+    
+    unsigned int waterDestinationNodeIndex = (waterDestinationNodeP == nullptr) ? CompactLocationGraph::noIndex : compactLocationGraph.indexOf(waterDestinationNodeP);
+    if (waterDestinationNodeIndex == CompactLocationGraph::noIndex) {
+        problems.push_back("Сток отсутствует в графе локации.");
+    }
+    
+    for (unsigned int nodeIndex = 0; nodeIndex < nodesCount; nodeIndex++) {
+        for (const WaterSource * waterSourceP : compactLocationGraph.nodeP(nodeIndex)->waterSourcesPs) {
+            if (waterDestinationNodeIndex == CompactLocationGraph::noIndex) {
+                continue;
+            }
+            if (componentForNode[nodeIndex] != componentForNode[waterDestinationNodeIndex]) {
+                problems.push_back("Сток недостижим из источника \"" + waterSourceP->name() + "\": узлы источника и стока лежат в разных компонентах связности графа локации.");
+                continue;
+            }
+            unsigned int diameterIndex = locationPassabilityTable.diameterIndexOf(waterSourceP->diameter());
+            if (diameterIndex != LocationPassabilityTable::noIndex && locationPassabilityTable.destinationIsReachable(diameterIndex, nodeIndex) == false) {
+                problems.push_back("Сток недостижим из источника \"" + waterSourceP->name() + "\" через проходы, ширина которых не меньше внешнего диаметра источника.");
+            }
+        }
+    }
+    
+    // 3. Поиск узлов-сочленений.
+    
+    findArticulationNodes(compactLocationGraph);
+    
+    durationMilliseconds = std::chrono::duration<CalcNumber, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    
+}
+
+/// Проверить, найдены ли проблемы, препятствующие построению трассы.
+///
+/// \return true, если проблемы не найдены, иначе false.
+bool LocationFeasibilityAnalysis::isFeasible() const {
+    
+    return problems.size() == 0;
+    
+}
+
+/// Бросить Exception-исключение, содержащее описания всех найденных проблем, если они есть.
+void LocationFeasibilityAnalysis::throwIfNotFeasible() const {
+    
+    if (isFeasible()) {
+        return;
+    }
+    
+    std::string message = "Ошибка при анализе выполнимости построения трассы. Найдено проблем: " + std::to_string(problems.size()) + ".";
+    for (unsigned int i = 0; i < problems.size(); i++) {
+        message += "\n" + std::to_string(i + 1) + ". " + problems[i];
+    }
+    throw Exception(message);
+    
+}
+
+/// Найти узлы-сочленения (алгоритм Тарьяна, обход в глубину без рекурсии).
+///
+/// \param compactLocationGraph Компактное представление графа локации.
+void LocationFeasibilityAnalysis::findArticulationNodes(const CompactLocationGraph & compactLocationGraph) {
+    
+    unsigned int nodesCount = compactLocationGraph.nodesCount();
+    
+    // время входа в узел при обходе в глубину (0 - узел не посещен) и наименьшее время входа, достижимое из поддерева узла по одной обратной связи
+    std::vector<unsigned int> entryTimes(nodesCount, 0), lowTimes(nodesCount, 0);
+    std::vector<unsigned char> isArticulation(nodesCount, 0);
+    unsigned int time = 0;
+    
+    // стек обхода хранит пары (узел, позиция следующей просматриваемой связи)
+    std::vector<std::pair<unsigned int, unsigned int>> stack;
+    std::vector<unsigned int> parents(nodesCount, CompactLocationGraph::noIndex);
+    
+    for (unsigned int rootIndex = 0; rootIndex < nodesCount; rootIndex++) {
+        
+        if (entryTimes[rootIndex] != 0) {
+            continue;
+        }
+        
+        unsigned int rootChildrenCount = 0;
+        entryTimes[rootIndex] = lowTimes[rootIndex] = ++time;
+        stack.push_back(std::make_pair(rootIndex, 0));
+        
+        while (stack.size() > 0) {
+            
+            unsigned int nodeIndex = stack[stack.size() - 1].first;
+            CompactLocationGraph::EdgeRange edges = compactLocationGraph.edgesOf(nodeIndex);
+            
+            if (stack[stack.size() - 1].second < edges.size()) {
+                const CompactLocationGraph::Edge & edge = edges.begin()[stack[stack.size() - 1].second++];
+                if (entryTimes[edge.nodeIndex] == 0) {
+                    // переход по связи дерева обхода
+                    parents[edge.nodeIndex] = nodeIndex;
+                    entryTimes[edge.nodeIndex] = lowTimes[edge.nodeIndex] = ++time;
+                    stack.push_back(std::make_pair(edge.nodeIndex, 0));
+                    if (nodeIndex == rootIndex) {
+                        rootChildrenCount++;
+                    }
+                } else if (edge.nodeIndex != parents[nodeIndex]) {
+                    // обратная связь
+                    lowTimes[nodeIndex] = std::min(lowTimes[nodeIndex], entryTimes[edge.nodeIndex]);
+                }
+                continue;
+            }
+            
+            // возврат из узла: узел, отличный от корня, является сочленением, если поддерево потомка не имеет обратных связей выше узла
+            stack.pop_back();
+            unsigned int parentIndex = parents[nodeIndex];
+            if (parentIndex != CompactLocationGraph::noIndex) {
+                lowTimes[parentIndex] = std::min(lowTimes[parentIndex], lowTimes[nodeIndex]);
+                if (parentIndex != rootIndex && lowTimes[nodeIndex] >= entryTimes[parentIndex]) {
+                    isArticulation[parentIndex] = 1;
+                }
+            }
+            
+        }
+        
+        // корень является сочленением, если имеет более одного потомка в дереве обхода
+        if (rootChildrenCount > 1) {
+            isArticulation[rootIndex] = 1;
+        }
+        
+    }
+    
+    for (unsigned int nodeIndex = 0; nodeIndex < nodesCount; nodeIndex++) {
+        if (isArticulation[nodeIndex] != 0) {
+            articulationNodePs.push_back(compactLocationGraph.nodeP(nodeIndex));
+        }
+    }
+    
+}
+
+#endif /* LocationFeasibilityAnalysis_hpp */
@@ -6,14 +6,21 @@
 #include <map>
 #include <set>
 #include <algorithm>
+#include <memory>
+#include <limits>
+#include <chrono>
 
 // Подключение внутренних типов
 #include "LocationGraphNode.hpp"
+#include "LocationSpatialIndex.hpp"
+#include "LocationPolygonDecomposer.hpp"
 #include "WaterConnectionObjects.hpp"
 #include "PipeObjectsBag.hpp"
 #include "OptimizationParameters.hpp"
 
 /// Граф локации, состоящий из узлов и ребер. Каждый узел графа представляет прямоугольную область, в которой могут проходить трубы трассы системы водоотведения. Ребра соединяют граничащие узлы. Узлы могут пересекаться только границами.
+///
+/// Копия графа является дешевым снимком: узлы и пространственный индекс разделяются между копиями и копируются только при первом изменении в данной копии (копирование при записи). Поэтому добавление объектов подключения воды и разделение узлов в копии копирует лишь затронутые узлы, не изменяя исходный граф.
 struct LocationGraph {
     
     // MARK: - Вспомогательные типы
@@ -25,7 +32,41 @@ struct LocationGraph {
         Point point;
         
         /// Узел, содержащий точку.
-        LocationGraphNode * nodeP;
+        const LocationGraphNode * nodeP;
+        
+    };
+    
+    /// Край узла, лежащий на прямой, параллельной одной из осей координат. Используется при поиске граничащих узлов.
+    struct NodeSide {
+        
+        /// Координата прямой, на которой лежит край (единица измерения - мм.).
+        CalcNumber coordinate;
+        
+        /// Меньшая координата края вдоль прямой (единица измерения - мм.).
+        CalcNumber start;
+        
+        /// Большая координата края вдоль прямой (единица измерения - мм.).
+        CalcNumber end;
+        
+        /// Индекс узла в массиве nodePs.
+        int nodeIndex;
+        
+        /// true, если край является правым (верхним) краем узла, false, если левым (нижним).
+        bool isUpperSide;
+        
+    };
+    
+    /// Статистика разделения узлов, содержащих точки входа нескольких источников.
+    struct SeparationStatistics {
+        
+        /// Число выполненных разделений узлов.
+        unsigned int separationsCount;
+        
+        /// Число проверок возможности разделения узлов.
+        unsigned int checkedNodesCount;
+        
+        /// Время, затраченное на разделение узлов (единица измерения - мс.).
+        CalcNumber durationMilliseconds;
         
     };
     
@@ -36,6 +77,18 @@ private:
     /// Последний сгенерированный уникальный идентификатор узла.
     unsigned int lastGeneratedId = 0;
     
+    /// Узлы графа во владении графа, в порядке массива nodePs. Узел может разделяться с другими снимками графа.
+    std::vector<std::shared_ptr<LocationGraphNode>> nodeHolders;
+    
+    /// Индексы узлов в массиве nodePs по идентификатору. Для отсутствующих идентификаторов хранится noNodeIndex.
+    std::vector<unsigned int> nodeIndexForId;
+    
+    /// Пространственный индекс узлов графа. Обновляется при добавлении и разделении узлов, может разделяться с другими снимками графа.
+    std::shared_ptr<LocationSpatialIndex> spatialIndexP;
+    
+    /// Значение индекса узла, означающее отсутствие узла.
+    static constexpr unsigned int noNodeIndex = std::numeric_limits<unsigned int>::max();
+    
 public:
     
     // MARK: - Открытые объекты
@@ -46,11 +99,8 @@ public:
     /// Указатель на параметры алгоритма оптимизации.
     const OptimizationParameters * optimizationParametersP;
     
-    /// Указатели на узлы графа.
-    std::vector<LocationGraphNode*> nodePs;
-    
-    /// Указатели на узлы по идентификатору.
-    std::map<unsigned int, LocationGraphNode*> nodePForId;
+    /// Указатели на узлы графа, доступные только для чтения. Узлы могут разделяться с другими снимками графа, поэтому изменяются только методами графа, которые предварительно копируют разделяемый узел (см. mutableNodeP).
+    std::vector<const LocationGraphNode*> nodePs;
     
     /// Указатель на узел графа локации, содержащий сток.
     const LocationGraphNode * waterDestinationNodeP;
@@ -63,20 +113,17 @@ public:
     /// \param optimizationParametersP Указатель на параметры алгоритма оптимизации.
     explicit LocationGraph(const PipeObjectsBag * pipeObjectsBagP, const OptimizationParameters * optimizationParametersP);
     
-    /// Конструктор копирования.
+    /// Конструктор копирования. Создается снимок графа, разделяющий узлы с копируемым графом.
     ///
     /// \param anotherLocationGraph Копируемый граф локации.
     LocationGraph(const LocationGraph & anotherLocationGraph);
     
-    /// Деструктор.
-    ~LocationGraph();
-    
     // MARK: - Открытые методы
     
     /// Очистить граф локации. При очищении удаляются существующие узлы.
     void clear();
     
-    /// Оператор копирования.
+    /// Оператор копирования. Граф становится снимком копируемого графа, разделяющим с ним узлы.
     ///
     /// \param anotherLocationGraph Копируемый граф локации.
     LocationGraph & operator=(const LocationGraph & anotherLocationGraph);
@@ -86,7 +133,7 @@ public:
     /// \return Уникальный идентификатор узла.
     unsigned int generateNewNodeId();
     
-    /// Добавить новый узел в граф локации. Метод бросает Exception-исключение, если координаты узла некорректны или добавляемый узел имеет пересечение положительной площади с существующим узлом графа.
+    /// Добавить новый узел в граф локации. Пересечение с существующими узлами проверяется с помощью пространственного индекса. Метод бросает Exception-исключение, если координаты узла некорректны или добавляемый узел имеет пересечение положительной площади с существующим узлом графа.
     ///
     /// \param left X-координата левого края узла (единица измерения - мм.).
     /// \param right X-координата правого края узла (единица измерения - мм.).
@@ -96,11 +143,23 @@ public:
     /// \return Уникальный идентификатор нового узла.
     unsigned int addNodeAndReturnId(CalcNumber left, CalcNumber right, CalcNumber bottom, CalcNumber top);
     
+    /// Найти узел по идентификатору.
+    ///
+    /// \param id Идентификатор узла.
+    ///
+    /// \return Указатель на узел или nullptr, если узла с данным идентификатором нет в графе.
+    const LocationGraphNode * nodePWithId(unsigned int id) const;
+    
     /// Загрузить граф локации из файла. Метод бросает Exception-исключение в случае некорректных данных.
     ///
     /// \param fileName Имя файла в формате CSV, в котором хранится локация в виде прямоугольных областей, в которой могут проходить трубы трассы системы водоотведения. Области не должны пересекаться.
     void loadFromFile(const std::string & fileName);
     
+    /// Загрузить граф локации из файла с контурами помещений. Контуры разбиваются на прямоугольники с помощью LocationPolygonDecomposer, каждый прямоугольник становится узлом графа. Метод бросает Exception-исключение в случае некорректных данных.
+    ///
+    /// \param fileName Имя файла в формате CSV, в котором хранятся вершины прямолинейных контуров (столбцы "Номер контура", "X (мм.)", "Y (мм.)"). Вершины одного контура перечисляются в порядке обхода. Контур, лежащий внутри другого контура, задает вырез.
+    void loadFromPolygonsFile(const std::string & fileName);
+    
     /// Соединить два узла связью типа левый-правый. Метод бросает Exception-исключение, если узлов с данными идентификаторами нет в графе или узлы не обладают данной связью или если данная связь уже зафиксирована.
     ///
     /// \param leftNodeId Идентификатор левого узла.
@@ -113,23 +172,35 @@ public:
     /// \param topNodeId Идентификатор верхнего узла.
     void connectBottomAndTopNodes(unsigned int bottomNodeId, unsigned int topNodeId);
     
-    /// Соединить все имеющиеся в графе узлы связями. Связи находятся автоматически. При вызове метода связи в узлах не должны быть установлены. Метод бросает Exception-исключение, если при вызове метода некоторые связи уже установлены в графе локации.
+    /// Соединить все имеющиеся в графе узлы связями. Связи находятся автоматически заметающей прямой по отсортированным краям узлов за время O(n log n + e), где n - число узлов, e - число связей. При вызове метода связи в узлах не должны быть установлены. Метод бросает Exception-исключение, если при вызове метода некоторые связи уже установлены в графе локации или если некоторые узлы касаются друг друга только углами.
     void connectAllNodes();
     
-    /// Найти ближайшую к точке point точку, принадлежащую локации.
+    /// Найти ближайшую к точке point точку, принадлежащую локации. Ближайший узел находится с помощью пространственного индекса.
     ///
     /// \param point Исходная точка (единица измерения - мм.).
     ///
     /// \return Ближайшая к точке point точка, принадлежащая локации (единица измерения - мм.).
-    FindPointResult findClosestPoint(const Point & point);
+    FindPointResult findClosestPoint(const Point & point) const;
+    
+    /// Найти узлы графа, пересекающиеся с прямоугольником. Касание границами считается пересечением. Узлы отбираются с помощью пространственного индекса.
+    ///
+    /// \param left X-координата левого края прямоугольника (единица измерения - мм.).
+    /// \param right X-координата правого края прямоугольника (единица измерения - мм.).
+    /// \param bottom Y-координата нижнего края прямоугольника (единица измерения - мм.).
+    /// \param top Y-координата верхнего края прямоугольника (единица измерения - мм.).
+    ///
+    /// \return Указатели на найденные узлы в порядке массива nodePs.
+    std::vector<const LocationGraphNode*> findNodePsIntersectedWithRectangle(CalcNumber left, CalcNumber right, CalcNumber bottom, CalcNumber top) const;
     
     /// Добавить в граф локации объекты подключения воды. Метод бросает Exception-исключение, если среди объектов подключения отсутствуют источники или сток или если сток не принадлежит полностью (с учетом внешнего диаметра) некоторому узлу локации.
     ///
     /// \param waterConnectionObjects Объекты подключения воды.
     void addWaterConnectionObjects(const WaterConnectionObjects & waterConnectionObjects);
     
-    /// Разделить узлы, содержащие точки входа нескольких источников. Узел, содержащий несколько точек входа, разделяется при условии, что 1) разделяющее узел сечение проходит посередине между разделяемыми точками входа, 2) расстояние между разделяемыми точками входа не меньше параметра minSourceDistanceToSeparate, 3) ширина сечения не превосходит параметр maxNodeWidthToSeparate, 4) образуемое сечение не пересекает точки входа источников в узел, 5) образуемое сечение не пересекает сток (с учетом его внешнего диаметра), 6) между разделяемыми точками входа нет других точек входа.
-    void separateWaterSources();
+    /// Разделить узлы, содержащие точки входа нескольких источников. Узел, содержащий несколько точек входа, разделяется при условии, что 1) разделяющее узел сечение проходит посередине между разделяемыми точками входа, 2) расстояние между разделяемыми точками входа не меньше параметра minSourceDistanceToSeparate, 3) ширина сечения не превосходит параметр maxNodeWidthToSeparate, 4) образуемое сечение не пересекает точки входа источников в узел, 5) образуемое сечение не пересекает сток (с учетом его внешнего диаметра), 6) между разделяемыми точками входа нет других точек входа. Узлы обрабатываются через рабочий список узлов с несколькими точками входа: после разделения в список возвращаются только два получившихся узла.
+    ///
+    /// \return Статистика разделения узлов.
+    SeparationStatistics separateWaterSources();
     
     /// Найти для каждого узла списка узлов, ведущих в сторону стока, а также минимального расстояния до стока для каждого возможного пути.
     void findPathsDoDestination();
@@ -138,21 +209,50 @@ private:
     
     // MARK: - Скрытые методы
     
-    /// Разделить узел node на два вдоль прямой x = separationX.
+    /// Вернуть узел, доступный для изменения в данном снимке графа. Если узел разделяется с другими снимками, он предварительно копируется.
+    ///
+    /// \param id Идентификатор узла. Узел должен содержаться в графе.
+    ///
+    /// \return Указатель на узел, принадлежащий только данному снимку графа.
+    LocationGraphNode * mutableNodeP(unsigned int id);
+    
+    /// Вернуть пространственный индекс, доступный для изменения в данном снимке графа. Если индекс разделяется с другими снимками, он предварительно копируется.
+    ///
+    /// \return Пространственный индекс, принадлежащий только данному снимку графа.
+    LocationSpatialIndex & mutableSpatialIndex();
+    
+    /// Создать узел с новым идентификатором и добавить его в граф и в пространственный индекс. Связи узла не устанавливаются, пересечение с существующими узлами не проверяется.
     ///
-    /// \param node Разделяемый узел.
+    /// \param left X-координата левого края узла (единица измерения - мм.).
+    /// \param right X-координата правого края узла (единица измерения - мм.).
+    /// \param bottom Y-координата нижнего края узла (единица измерения - мм.).
+    /// \param top Y-координата верхнего края узла(единица измерения - мм.).
+    ///
+    /// \return Указатель на созданный узел.
+    LocationGraphNode * createNodeAndReturnP(CalcNumber left, CalcNumber right, CalcNumber bottom, CalcNumber top);
+    
+    /// Разделить узел на два вдоль прямой x = separationX.
+    ///
+    /// \param nodeId Идентификатор разделяемого узла.
     /// \param separationX X-координата сечения (единица измерения - мм.).
-    void separateNodeX(LocationGraphNode & node, CalcNumber separationX);
+    void separateNodeX(unsigned int nodeId, CalcNumber separationX);
     
-    /// Разделить узел node на два вдоль прямой y = separationY.
+    /// Разделить узел на два вдоль прямой y = separationY.
     ///
-    /// \param node Разделяемый узел.
+    /// \param nodeId Идентификатор разделяемого узла.
     /// \param separationY Y-координата сечения (единица измерения - мм.).
-    void separateNodeY(LocationGraphNode & node, CalcNumber separationY);
+    void separateNodeY(unsigned int nodeId, CalcNumber separationY);
     
     /// Пересчитать указатель на узел графа локации, содержащий сток.
     void recalculateWaterDestinationNodeP();
     
+    /// Найти пары узлов, граничащих по отрезку положительной длины, лежащему на вертикальной или горизонтальной прямой. Края узлов сортируются по прямой и началу края, после чего края на каждой прямой обходятся заметающей точкой. Метод бросает Exception-исключение, если некоторые узлы касаются друг друга только углами.
+    ///
+    /// \param isVertical true, если ищутся связи типа левый-правый (общий край вертикален), false, если связи типа нижний-верхний.
+    ///
+    /// \return Пары индексов узлов в массиве nodePs: (левый, правый) или (нижний, верхний), упорядоченные по возрастанию меньшего, затем большего индекса.
+    std::vector<std::pair<int, int>> findAdjacentNodeIndexPairs(bool isVertical) const;
+    
 };
 
 // MARK: - Реализация
@@ -161,9 +261,9 @@ private:
 ///
 /// \param pipeObjectsBagP Указатель на хранилище, содержащее доступные к использованию объекты системы водоотведения.
 /// \param optimizationParametersP Указатель на параметры алгоритма оптимизации.
-LocationGraph::LocationGraph(const PipeObjectsBag * pipeObjectsBagP, const OptimizationParameters * optimizationParametersP): pipeObjectsBagP(pipeObjectsBagP), optimizationParametersP(optimizationParametersP), waterDestinationNodeP(nullptr) {}
+LocationGraph::LocationGraph(const PipeObjectsBag * pipeObjectsBagP, const OptimizationParameters * optimizationParametersP): spatialIndexP(std::make_shared<LocationSpatialIndex>(optimizationParametersP->locationIndexCellSize)), pipeObjectsBagP(pipeObjectsBagP), optimizationParametersP(optimizationParametersP), waterDestinationNodeP(nullptr) {}
     
-/// Конструктор копирования.
+/// Конструктор копирования. Создается снимок графа, разделяющий узлы с копируемым графом.
 ///
 /// \param anotherLocationGraph Копируемый граф локации.
 LocationGraph::LocationGraph(const LocationGraph & anotherLocationGraph) {
@@ -172,63 +272,32 @@ LocationGraph::LocationGraph(const LocationGraph & anotherLocationGraph) {
     
 }
 
-/// Оператор копирования.
+/// Оператор копирования. Граф становится снимком копируемого графа, разделяющим с ним узлы.
 ///
 /// \param anotherLocationGraph Копируемый граф локации.
 LocationGraph & LocationGraph::operator=(const LocationGraph & anotherLocationGraph) {
     
     lastGeneratedId = anotherLocationGraph.lastGeneratedId;
+    nodeHolders = anotherLocationGraph.nodeHolders;
+    nodeIndexForId = anotherLocationGraph.nodeIndexForId;
+    spatialIndexP = anotherLocationGraph.spatialIndexP;
     pipeObjectsBagP = anotherLocationGraph.pipeObjectsBagP;
     optimizationParametersP = anotherLocationGraph.optimizationParametersP;
-    nodePs.clear();
-    nodePForId.clear();
-    
-    for (LocationGraphNode * nodeP : anotherLocationGraph.nodePs) {
-        LocationGraphNode * newNodeP = new LocationGraphNode(*nodeP);
-        nodePs.push_back(newNodeP);
-        nodePForId[nodeP->id] = newNodeP;
-    }
-    
-    for (int i = 0; i < nodePs.size(); i++) {
-        const LocationGraphNode * anotherGraphNodeP = anotherLocationGraph.nodePs[i];
-        for (int j = 0; j < anotherGraphNodeP->leftNodesPs.size(); j++) {
-            nodePs[i]->leftNodesPs[j] = nodePForId[anotherGraphNodeP->leftNodesPs[j]->id];
-        }
-        for (int j = 0; j < anotherGraphNodeP->rightNodesPs.size(); j++) {
-            nodePs[i]->rightNodesPs[j] = nodePForId[anotherGraphNodeP->rightNodesPs[j]->id];
-        }
-        for (int j = 0; j < anotherGraphNodeP->bottomNodesPs.size(); j++) {
-            nodePs[i]->bottomNodesPs[j] = nodePForId[anotherGraphNodeP->bottomNodesPs[j]->id];
-        }
-        for (int j = 0; j < anotherGraphNodeP->topNodesPs.size(); j++) {
-            nodePs[i]->topNodesPs[j] = nodePForId[anotherGraphNodeP->topNodesPs[j]->id];
-        }
-    }
-    waterDestinationNodeP = (anotherLocationGraph.waterDestinationNodeP == nullptr) ? nullptr : nodePForId[anotherLocationGraph.waterDestinationNodeP->id];
+    nodePs = anotherLocationGraph.nodePs;
+    waterDestinationNodeP = anotherLocationGraph.waterDestinationNodeP;
     
     return *this;
     
 }
 
-/// Деструктор.
-LocationGraph::~LocationGraph() {
-    
-    for (LocationGraphNode * nodeP : nodePs) {
-        delete nodeP;
-    }
-    
-}
-
 /// Очистить граф локации. При очищении удаляются существующие узлы.
 void LocationGraph::clear() {
     
-    for (LocationGraphNode * nodeP : nodePs) {
-        delete nodeP;
-    }
-    
     lastGeneratedId = 0;
+    nodeHolders.clear();
+    nodeIndexForId.clear();
+    spatialIndexP = std::make_shared<LocationSpatialIndex>(optimizationParametersP->locationIndexCellSize);
     nodePs.clear();
-    nodePForId.clear();
     waterDestinationNodeP = nullptr;
     
 }
@@ -242,7 +311,7 @@ unsigned int LocationGraph::generateNewNodeId() {
     
 }
 
-/// Добавить новый узел в граф локации. Метод бросает Exception-исключение, если если координаты узла некорректны или добавляемый узел имеет пересечение положительной площади с существующим узлом графа.
+/// Добавить новый узел в граф локации. Пересечение с существующими узлами проверяется с помощью пространственного индекса. Метод бросает Exception-исключение, если если координаты узла некорректны или добавляемый узел имеет пересечение положительной площади с существующим узлом графа.
 ///
 /// \param left X-координата левого края узла (единица измерения - мм.).
 /// \param right X-координата правого края узла (единица измерения - мм.).
@@ -256,17 +325,27 @@ unsigned int LocationGraph::addNodeAndReturnId(CalcNumber left, CalcNumber right
         throw Exception("Ошибка при добавлении нового узла в граф локации. Добавляемый узел имеет некорректные границы. Добавляемый узел: " + LocationGraphNode(0, left, right, bottom, top).positionStr() + ".");
     }
     
-    for (const LocationGraphNode * nodeP: nodePs) {
-        if ((left >= nodeP->right || right <= nodeP->left || bottom >= nodeP->top || top <= nodeP->bottom) == false) {
-            throw Exception("Ошибка при добавлении нового узла в граф локации. Добавляемый узел имеет пересечение положительной площади с существующим узлом графа. Добавляемый узел: " + LocationGraphNode(0, left, right, bottom, top).positionStr() + "; существующий узел: " + nodeP->positionStr() + ".");
-        }
+    unsigned int intersectedNodeId = spatialIndexP->findNodeIdWithNonZeroIntersectionArea(left, right, bottom, top);
+    if (intersectedNodeId != 0) {
+        throw Exception("Ошибка при добавлении нового узла в граф локации. Добавляемый узел имеет пересечение положительной площади с существующим узлом графа. Добавляемый узел: " + LocationGraphNode(0, left, right, bottom, top).positionStr() + "; существующий узел: " + nodePWithId(intersectedNodeId)->positionStr() + ".");
     }
     
-    unsigned int newId = generateNewNodeId();
-    LocationGraphNode * newNodeP = new LocationGraphNode(newId, left, right, bottom, top);
-    nodePs.push_back(newNodeP);
-    nodePForId[newId] = newNodeP;
-    return newId;
+    return createNodeAndReturnP(left, right, bottom, top)->id;
+    
+}
+
+/// Найти узел по идентификатору.
+///
+/// \param id Идентификатор узла.
+///
+/// \return Указатель на узел или nullptr, если узла с данным идентификатором нет в графе.
+const LocationGraphNode * LocationGraph::nodePWithId(unsigned int id) const {
+    
+    if (id >= nodeIndexForId.size() || nodeIndexForId[id] == noNodeIndex) {
+        return nullptr;
+    }
+    
+    return nodePs[nodeIndexForId[id]];
     
 }
 
@@ -366,6 +445,107 @@ void LocationGraph::loadFromFile(const std::string & fileName) {
     
 }
 
+/// Загрузить граф локации из файла с контурами помещений. Контуры разбиваются на прямоугольники с помощью LocationPolygonDecomposer, каждый прямоугольник становится узлом графа. Метод бросает Exception-исключение в случае некорректных данных.
+///
+/// \param fileName Имя файла в формате CSV, в котором хранятся вершины прямолинейных контуров (столбцы "Номер контура", "X (мм.)", "Y (мм.)"). Вершины одного контура перечисляются в порядке обхода. Контур, лежащий внутри другого контура, задает вырез.
+void LocationGraph::loadFromPolygonsFile(const std::string & fileName) {
+    
+    // 1. Удаление существующих узлов локации.
+    
+    clear();
+    
+    // 2. Загрузка контуров из файла.
+    
+    /// Вершины контуров по номерам контуров.
+    std::map<int, std::vector<Point>> verticesForContourNumber;
+    
+    try {
+        
+        std::ifstream stream(fileName);
+        if (stream.fail()) {
+            throw Exception("Ошибка при открытии CSV-файла с контурами локации.");
+        }
+        std::string line;
+        
+        /// Разделитель, использующийся в файле.
+        const char delimeter = ';';
+        
+        // считывание заголовка файла
+        line = "";
+        std::getline(stream, line);
+        
+        int lineNumber = 2;
+        line = "";
+        while (std::getline(stream, line)) {
+            
+            std::string lineErrorMessagePrefix = "Ошибка при чтении CSV-файла с контурами локации в строке " + std::to_string(lineNumber);
+            
+            if (line.empty()) {
+                lineNumber++;
+                continue;
+            }
+            
+            std::istringstream lineStream(line);
+            
+            std::string readingColumnName, extraStr;
+            int contourNumber;
+            CalcNumber x, y;
+            
+            try {
+                
+                // чтение поля contourNumber
+                readingColumnName = "Номер контура";
+                extraStr = "";
+                std::getline(lineStream, extraStr, delimeter);
+                contourNumber = std::stoi(extraStr);
+                
+                // чтение поля x
+                readingColumnName = "X (мм.)";
+                extraStr = "";
+                std::getline(lineStream, extraStr, delimeter);
+                x = std::stold(extraStr);
+                
+                // чтение поля y
+                readingColumnName = "Y (мм.)";
+                extraStr = "";
+                std::getline(lineStream, extraStr, delimeter);
+                y = std::stold(extraStr);
+                
+                verticesForContourNumber[contourNumber].push_back(Point(x, y, 0));
+                
+            }
+            catch (...) {
+                throw Exception(lineErrorMessagePrefix + " в поле \"" + readingColumnName + "\". Некорректный формат поля.");
+            }
+            
+            lineNumber++;
+            line = "";
+            
+        }
+        
+        stream.close();
+        
+    }
+    catch (const Exception & exception) {
+        throw exception;
+    }
+    catch (...) {
+        throw Exception("Ошибка при чтении CSV-файла с контурами локации.");
+    }
+    
+    // 3. Разбиение контуров на прямоугольники и добавление узлов локации.
+    
+    std::vector<std::vector<Point>> contours;
+    for (const auto & contourVertices : verticesForContourNumber) {
+        contours.push_back(contourVertices.second);
+    }
+    
+    for (const LocationPolygonDecomposer::Rectangle & rectangle : LocationPolygonDecomposer::decompose(contours)) {
+        addNodeAndReturnId(rectangle.left, rectangle.right, rectangle.bottom, rectangle.top);
+    }
+    
+}
+
 /// Соединить два узла связью типа левый-правый. Метод бросает Exception-исключение, если узлов с данными идентификаторами нет в графе или узлы не обладают данной связью или если данная связь уже зафиксирована.
 ///
 /// \param leftNodeId Идентификатор левого узла.
@@ -374,24 +554,24 @@ void LocationGraph::connectLeftAndRightNodes(unsigned int leftNodeId, unsigned i
     
     std::string exceptionPrefix = "Ошибка при соединении двух узлов связью типа \"левый-правый\".";// в графе локации с узлами идентификаторов " + std::to_string(leftNodeId) + " и " + std::to_string(rightNodeId) + ".";
     
-    if (nodePForId.find(leftNodeId) == nodePForId.end()) {
+    if (nodePWithId(leftNodeId) == nullptr) {
         throw Exception(exceptionPrefix + " Узел с идентификатором " + std::to_string(leftNodeId) + " отсутствует в графе локации.");
     }
     
-    if (nodePForId.find(rightNodeId) == nodePForId.end()) {
+    if (nodePWithId(rightNodeId) == nullptr) {
         throw Exception(exceptionPrefix + " Узел с идентификатором " + std::to_string(rightNodeId) + " отсутствует в графе локации.");
     }
     
-    LocationGraphNode * leftNodeP = nodePForId[leftNodeId];
-    LocationGraphNode * rightNodeP = nodePForId[rightNodeId];
+    const LocationGraphNode * leftNodeP = nodePWithId(leftNodeId);
+    const LocationGraphNode * rightNodeP = nodePWithId(rightNodeId);
     
     exceptionPrefix = "Ошибка при соединении двух узлов связью типа \"левый-правый\".";// в графе локации с узлами идентификаторов " + std::to_string(leftNodeId) + " и " + std::to_string(rightNodeId) + " (" + leftNodeP->positionStr() + " и " + rightNodeP->positionStr() + ").";
     
-    if (std::find(leftNodeP->rightNodesPs.begin(), leftNodeP->rightNodesPs.end(), rightNodeP) != leftNodeP->rightNodesPs.end()) {
+    if (std::find(leftNodeP->rightNodesIds.begin(), leftNodeP->rightNodesIds.end(), rightNodeId) != leftNodeP->rightNodesIds.end()) {
         throw Exception(exceptionPrefix + " Данная связь уже установлена в графе локации.");
     }
     
-    if (std::find(rightNodeP->leftNodesPs.begin(), rightNodeP->leftNodesPs.end(), leftNodeP) != rightNodeP->leftNodesPs.end()) {
+    if (std::find(rightNodeP->leftNodesIds.begin(), rightNodeP->leftNodesIds.end(), leftNodeId) != rightNodeP->leftNodesIds.end()) {
         throw Exception(exceptionPrefix + " Данная связь уже установлена в графе локации.");
     }
     
@@ -399,8 +579,8 @@ void LocationGraph::connectLeftAndRightNodes(unsigned int leftNodeId, unsigned i
         throw Exception(exceptionPrefix + " Узлы не обладают данной связью.");
     }
     
-    leftNodeP->rightNodesPs.push_back(rightNodeP);
-    rightNodeP->leftNodesPs.push_back(leftNodeP);
+    mutableNodeP(leftNodeId)->rightNodesIds.push_back(rightNodeId);
+    mutableNodeP(rightNodeId)->leftNodesIds.push_back(leftNodeId);
     
 }
 
@@ -412,24 +592,24 @@ void LocationGraph::connectBottomAndTopNodes(unsigned int bottomNodeId, unsigned
     
     std::string exceptionPrefix = "Ошибка при соединении двух узлов связью типа \"нижний-верхний\".";// в графе локации с узлами идентификаторов " + std::to_string(bottomNodeId) + " и " + std::to_string(topNodeId) + ".";
     
-    if (nodePForId.find(bottomNodeId) == nodePForId.end()) {
+    if (nodePWithId(bottomNodeId) == nullptr) {
         throw Exception(exceptionPrefix + " Узел с идентификатором " + std::to_string(bottomNodeId) + " отсутствует в графе локации.");
     }
     
-    if (nodePForId.find(topNodeId) == nodePForId.end()) {
+    if (nodePWithId(topNodeId) == nullptr) {
         throw Exception(exceptionPrefix + " Узел с идентификатором " + std::to_string(topNodeId) + " отсутствует в графе локации.");
     }
     
-    LocationGraphNode * bottomNodeP = nodePForId[bottomNodeId];
-    LocationGraphNode * topNodeP = nodePForId[topNodeId];
+    const LocationGraphNode * bottomNodeP = nodePWithId(bottomNodeId);
+    const LocationGraphNode * topNodeP = nodePWithId(topNodeId);
     
     exceptionPrefix = "Ошибка при соединении двух узлов связью типа \"нижний-верхний\".";// в графе локации с узлами идентификаторов " + std::to_string(bottomNodeId) + " и " + std::to_string(topNodeId) + " (" + bottomNodeP->positionStr() + " и " + topNodeP->positionStr() + ").";
     
-    if (std::find(bottomNodeP->topNodesPs.begin(), bottomNodeP->topNodesPs.end(), topNodeP) != bottomNodeP->topNodesPs.end()) {
+    if (std::find(bottomNodeP->topNodesIds.begin(), bottomNodeP->topNodesIds.end(), topNodeId) != bottomNodeP->topNodesIds.end()) {
         throw Exception(exceptionPrefix + " Данная связь уже установлена в графе локации.");
     }
     
-    if (std::find(topNodeP->bottomNodesPs.begin(), topNodeP->bottomNodesPs.end(), bottomNodeP) != topNodeP->bottomNodesPs.end()) {
+    if (std::find(topNodeP->bottomNodesIds.begin(), topNodeP->bottomNodesIds.end(), bottomNodeId) != topNodeP->bottomNodesIds.end()) {
         throw Exception(exceptionPrefix + " Данная связь уже установлена в графе локации.");
     }
     
@@ -437,58 +617,79 @@ void LocationGraph::connectBottomAndTopNodes(unsigned int bottomNodeId, unsigned
         throw Exception(exceptionPrefix + " Узлы не обладают данной связью.");
     }
     
-    bottomNodeP->topNodesPs.push_back(topNodeP);
-    topNodeP->bottomNodesPs.push_back(bottomNodeP);
+    mutableNodeP(bottomNodeId)->topNodesIds.push_back(topNodeId);
+    mutableNodeP(topNodeId)->bottomNodesIds.push_back(bottomNodeId);
     
 }
 
-/// Соединить все имеющиеся в графе узлы связями. Связи находятся автоматически. При вызове метода связи в узлах не должны быть установлены. Метод бросает Exception-исключение, если при вызове метода некоторые связи уже установлены в графе локации.
+/// Соединить все имеющиеся в графе узлы связями. Связи находятся автоматически заметающей прямой по отсортированным краям узлов за время O(n log n + e), где n - число узлов, e - число связей. При вызове метода связи в узлах не должны быть установлены. Метод бросает Exception-исключение, если при вызове метода некоторые связи уже установлены в графе локации или если некоторые узлы касаются друг друга только углами.
 void LocationGraph::connectAllNodes() {
     
-    for (int i = 0; i < nodePs.size() - 1; i++) {
-        for (int j = i + 1; j < nodePs.size(); j++) {
-            if (nodePs[i]->intersectWith(*(nodePs[j]))) {
-                LocationGraphNode * node1P = nodePs[i];
-                LocationGraphNode * node2P = nodePs[j];
-                if (node1P->left == node2P->right) {
-                    connectLeftAndRightNodes(node2P->id, node1P->id);
-                } else if (node1P->right == node2P->left) {
-                    connectLeftAndRightNodes(node1P->id, node2P->id);
-                } else if (node1P->bottom == node2P->top) {
-                    connectBottomAndTopNodes(node2P->id, node1P->id);
-                } else {
-                    connectBottomAndTopNodes(node1P->id, node2P->id);
-                }
-            }
+    for (const LocationGraphNode * nodeP : nodePs) {
+        if (nodeP->leftNodesIds.size() != 0 || nodeP->rightNodesIds.size() != 0 || nodeP->bottomNodesIds.size() != 0 || nodeP->topNodesIds.size() != 0) {
+            throw Exception("Ошибка при соединении узлов графа локации. Некоторые связи уже установлены в графе локации. Узел: " + nodeP->positionStr() + ".");
         }
     }
     
+    // пары найдены без повторов, поэтому проверки наличия связи не требуются; порядок пар совпадает с порядком попарного перебора узлов
+    for (const std::pair<int, int> & nodeIndexPair : findAdjacentNodeIndexPairs(true)) {
+        unsigned int leftNodeId = nodePs[nodeIndexPair.first]->id, rightNodeId = nodePs[nodeIndexPair.second]->id;
+        mutableNodeP(leftNodeId)->rightNodesIds.push_back(rightNodeId);
+        mutableNodeP(rightNodeId)->leftNodesIds.push_back(leftNodeId);
+    }
+    
+    for (const std::pair<int, int> & nodeIndexPair : findAdjacentNodeIndexPairs(false)) {
+        unsigned int bottomNodeId = nodePs[nodeIndexPair.first]->id, topNodeId = nodePs[nodeIndexPair.second]->id;
+        mutableNodeP(bottomNodeId)->topNodesIds.push_back(topNodeId);
+        mutableNodeP(topNodeId)->bottomNodesIds.push_back(bottomNodeId);
+    }
+    
 }
 
-/// Найти ближайшую к точке point точку, принадлежащую локации.
+/// Найти ближайшую к точке point точку, принадлежащую локации. Ближайший узел находится с помощью пространственного индекса.
 ///
 /// \param point Исходная точка (единица измерения - мм.).
 ///
 /// \return Ближайшая к точке point точка, принадлежащая локации (единица измерения - мм.).
-LocationGraph::FindPointResult LocationGraph::findClosestPoint(const Point & point) {
+LocationGraph::FindPointResult LocationGraph::findClosestPoint(const Point & point) const {
     
     FindPointResult result;
-    CalcNumber minDistance = 999999999.0;
-    
-    for (LocationGraphNode * nodeP : nodePs) {
-        Point closestPoint = nodeP->findClosestPoint(point);
-        CalcNumber distance = closestPoint.distanceToPoint(point);
-        if (distance < minDistance) {
-            minDistance = distance;
-            result.point = closestPoint;
-            result.nodeP = nodeP;
-        }
+    result.nodeP = nodePWithId(spatialIndexP->findClosestNodeId(point));
+    
+    if (result.nodeP != nullptr) {
+        result.point = result.nodeP->findClosestPoint(point);
     }
     
     return result;
     
 }
 
+/// Найти узлы графа, пересекающиеся с прямоугольником. Касание границами считается пересечением. Узлы отбираются с помощью пространственного индекса.
+///
+/// \param left X-координата левого края прямоугольника (единица измерения - мм.).
+/// \param right X-координата правого края прямоугольника (единица измерения - мм.).
+/// \param bottom Y-координата нижнего края прямоугольника (единица измерения - мм.).
+/// \param top Y-координата верхнего края прямоугольника (единица измерения - мм.).
+///
+/// \return Указатели на найденные узлы в порядке массива nodePs.
+std::vector<const LocationGraphNode*> LocationGraph::findNodePsIntersectedWithRectangle(CalcNumber left, CalcNumber right, CalcNumber bottom, CalcNumber top) const {
+    
+    std::vector<unsigned int> nodeIndexes;
+    for (unsigned int id : spatialIndexP->findNodeIdsIntersectedWithRectangle(left, right, bottom, top)) {
+        nodeIndexes.push_back(nodeIndexForId[id]);
+    }
+    std::sort(nodeIndexes.begin(), nodeIndexes.end());
+    
+    std::vector<const LocationGraphNode*> foundNodePs;
+    foundNodePs.reserve(nodeIndexes.size());
+    for (unsigned int nodeIndex : nodeIndexes) {
+        foundNodePs.push_back(nodePs[nodeIndex]);
+    }
+    
+    return foundNodePs;
+    
+}
+
 /// Добавить в граф локации объекты подключения воды. Метод бросает Exception-исключение, если среди объектов подключения отсутствуют источники или сток или если сток не принадлежит полностью (с учетом внешнего диаметра) некоторому узлу локации.
 ///
 /// \param waterConnectionObjects Объекты подключения воды.
@@ -504,7 +705,7 @@ void LocationGraph::addWaterConnectionObjects(const WaterConnectionObjects & wat
     
     for (const WaterSource & waterSource : waterConnectionObjects.waterSources) {
         FindPointResult findPointResult = findClosestPoint(waterSource.point());
-        LocationGraphNode * node = findPointResult.nodeP;
+        LocationGraphNode * node = mutableNodeP(findPointResult.nodeP->id);
         CalcNumber externalDiameterHalfed = pipeObjectsBagP->getExternalDiameter(waterSource.diameter()) / 2;
         Point connectionPoint = findPointResult.point;
         if (connectionPoint.x == node->left) {
@@ -524,7 +725,7 @@ void LocationGraph::addWaterConnectionObjects(const WaterConnectionObjects & wat
     const WaterDestination * waterDestinationP = &(waterConnectionObjects.waterDestination);
     const Point waterDestinationPoint = waterDestinationP->point();
     FindPointResult findPointResult = findClosestPoint(waterDestinationPoint);
-    LocationGraphNode * nodeP = findPointResult.nodeP;
+    LocationGraphNode * nodeP = mutableNodeP(findPointResult.nodeP->id);
     nodeP->waterDestinationP = waterDestinationP;
     waterDestinationNodeP = nodeP;
     CalcNumber waterDestinationExternalRadius = pipeObjectsBagP->getExternalDiameter(waterDestinationP->diameter()) / 2;
@@ -539,126 +740,206 @@ void LocationGraph::addWaterConnectionObjects(const WaterConnectionObjects & wat
     
 }
 
-/// Разделить узлы, содержащие точки входа нескольких источников. Узел, содержащий несколько точек входа, разделяется при условии, что 1) разделяющее узел сечение проходит посередине между разделяемыми точками входа, 2) расстояние между разделяемыми точками входа не меньше параметра minSourceDistanceToSeparate, 3) ширина сечения не превосходит параметр maxNodeWidthToSeparate, 4) образуемое сечение не пересекает точки входа источников в узел, 5) образуемое сечение не пересекает сток (с учетом его внешнего диаметра), 6) между разделяемыми точками входа нет других точек входа.
-void LocationGraph::separateWaterSources() {
+/// Разделить узлы, содержащие точки входа нескольких источников. Узел, содержащий несколько точек входа, разделяется при условии, что 1) разделяющее узел сечение проходит посередине между разделяемыми точками входа, 2) расстояние между разделяемыми точками входа не меньше параметра minSourceDistanceToSeparate, 3) ширина сечения не превосходит параметр maxNodeWidthToSeparate, 4) образуемое сечение не пересекает точки входа источников в узел, 5) образуемое сечение не пересекает сток (с учетом его внешнего диаметра), 6) между разделяемыми точками входа нет других точек входа. Узлы обрабатываются через рабочий список узлов с несколькими точками входа: после разделения в список возвращаются только два получившихся узла.
+///
+/// \return Статистика разделения узлов.
+LocationGraph::SeparationStatistics LocationGraph::separateWaterSources() {
     
-    bool successSeparation = true;
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    SeparationStatistics statistics { 0, 0, 0 };
     
-    while (successSeparation) {
+    // индексы узлов с несколькими точками входа; узел с наименьшим индексом обрабатывается первым, поэтому разделения выполняются в том же порядке, что и при повторном просмотре всех узлов после каждого разделения
+    std::set<unsigned int> worklist;
+    for (unsigned int i = 0; i < nodePs.size(); i++) {
+        if (nodePs[i]->waterSourcesPs.size() > 1) {
+            worklist.insert(i);
+        }
+    }
+    
+    while (worklist.size() > 0) {
         
-        successSeparation = false;
+        unsigned int nodeIndex = *worklist.begin();
+        worklist.erase(worklist.begin());
+        const LocationGraphNode * nodeP = nodePs[nodeIndex];
+        statistics.checkedNodesCount++;
         
-        for (LocationGraphNode * nodeP : nodePs) {
-            
-            if (nodeP->waterSourcesPs.size() > 1) {
-                
-                std::set<CalcNumber> xsSet, ysSet;
-                for (const Point & connectionPoint : nodeP->waterSourcesConnectionPoints) {
-                    xsSet.insert(connectionPoint.x);
-                    ysSet.insert(connectionPoint.y);
-                }
-                
-                std::vector<CalcNumber> xsArr, ysArr;
-                std::copy(xsSet.begin(), xsSet.end(), std::back_inserter(xsArr));
-                std::copy(ysSet.begin(), ysSet.end(), std::back_inserter(ysArr));
-                std::sort(xsArr.begin(), xsArr.end());
-                std::sort(ysArr.begin(), ysArr.end());
-                
-                // проверка возможности разделения вдоль прямой x = ...
-                if (xsArr.size() > 1 && nodeP->sizeY() <= optimizationParametersP->maxNodeWidthToSeparate) {
-                    bool needToSeparate = false;
-                    CalcNumber separationX = 0;
-                    for (int i = 1; i < xsArr.size(); i++) {
-                        if (xsArr[i] - xsArr[i-1] >= optimizationParametersP->minSourceDistanceToSeparate) {
-                            separationX = (xsArr[i-1] + xsArr[i]) / 2;
-                            if (nodeP->waterDestinationP == nullptr) {
-                                needToSeparate = true;
-                                break;
-                            } else {
-                                const WaterDestination * waterDestinationP = nodeP->waterDestinationP;
-                                Point waterDestinationPoint = waterDestinationP->point();
-                                CalcNumber waterDestinationExternalRadius = pipeObjectsBagP->getExternalDiameter(waterDestinationP->diameter()) / 2;
-                                if (separationX < waterDestinationPoint.x - waterDestinationExternalRadius || separationX > waterDestinationPoint.x + waterDestinationExternalRadius) {
-                                    needToSeparate = true;
-                                    break;
-                                }
-                            }
-                        }
-                    }
-                    if (needToSeparate) {
-                        separateNodeX(*nodeP, separationX);
-                        successSeparation = true;
+        // разделение затрагивает только точки входа самого узла, поэтому узел, который нельзя разделить, не возвращается в список
+        bool isSeparated = false;
+        
+        std::vector<CalcNumber> xsArr, ysArr;
+        for (const Point & connectionPoint : nodeP->waterSourcesConnectionPoints) {
+            xsArr.push_back(connectionPoint.x);
+            ysArr.push_back(connectionPoint.y);
+        }
+        std::sort(xsArr.begin(), xsArr.end());
+        std::sort(ysArr.begin(), ysArr.end());
+        xsArr.erase(std::unique(xsArr.begin(), xsArr.end()), xsArr.end());
+        ysArr.erase(std::unique(ysArr.begin(), ysArr.end()), ysArr.end());
+        
+        // проверка возможности разделения вдоль прямой x = ...
+        if (xsArr.size() > 1 && nodeP->sizeY() <= optimizationParametersP->maxNodeWidthToSeparate) {
+            bool needToSeparate = false;
+            CalcNumber separationX = 0;
+            for (int i = 1; i < xsArr.size(); i++) {
+                if (xsArr[i] - xsArr[i-1] >= optimizationParametersP->minSourceDistanceToSeparate) {
+                    separationX = (xsArr[i-1] + xsArr[i]) / 2;
+                    if (nodeP->waterDestinationP == nullptr) {
+                        needToSeparate = true;
                         break;
-                    }
-                }
-                
-                // проверка возможности разделения вдоль прямой y = ...
-                if (ysArr.size() > 1 && nodeP->sizeX() <= optimizationParametersP->maxNodeWidthToSeparate) {
-                    bool needToSeparate = false;
-                    CalcNumber separationY = 0;
-                    for (int i = 1; i < ysArr.size(); i++) {
-                        if (ysArr[i] - ysArr[i-1] >= optimizationParametersP->minSourceDistanceToSeparate) {
-                            separationY = (ysArr[i-1] + ysArr[i]) / 2;
-                            if (nodeP->waterDestinationP == nullptr) {
-                                needToSeparate = true;
-                                break;
-                            } else {
-                                const WaterDestination * waterDestinationP = nodeP->waterDestinationP;
-                                Point waterDestinationPoint = waterDestinationP->point();
-                                CalcNumber waterDestinationExternalRadius = pipeObjectsBagP->getExternalDiameter(waterDestinationP->diameter()) / 2;
-                                if (separationY < waterDestinationPoint.y - waterDestinationExternalRadius || separationY > waterDestinationPoint.y + waterDestinationExternalRadius) {
-                                    needToSeparate = true;
-                                    break;
-                                }
-                            }
+                    } else {
+                        const WaterDestination * waterDestinationP = nodeP->waterDestinationP;
+                        Point waterDestinationPoint = waterDestinationP->point();
+                        CalcNumber waterDestinationExternalRadius = pipeObjectsBagP->getExternalDiameter(waterDestinationP->diameter()) / 2;
+                        if (separationX < waterDestinationPoint.x - waterDestinationExternalRadius || separationX > waterDestinationPoint.x + waterDestinationExternalRadius) {
+                            needToSeparate = true;
+                            break;
                         }
                     }
-                    if (needToSeparate) {
-                        separateNodeY(*nodeP, separationY);
-                        successSeparation = true;
+                }
+            }
+            if (needToSeparate) {
+                separateNodeX(nodeP->id, separationX);
+                isSeparated = true;
+            }
+        }
+        
+        // проверка возможности разделения вдоль прямой y = ...
+        if (isSeparated == false && ysArr.size() > 1 && nodeP->sizeX() <= optimizationParametersP->maxNodeWidthToSeparate) {
+            bool needToSeparate = false;
+            CalcNumber separationY = 0;
+            for (int i = 1; i < ysArr.size(); i++) {
+                if (ysArr[i] - ysArr[i-1] >= optimizationParametersP->minSourceDistanceToSeparate) {
+                    separationY = (ysArr[i-1] + ysArr[i]) / 2;
+                    if (nodeP->waterDestinationP == nullptr) {
+                        needToSeparate = true;
                         break;
+                    } else {
+                        const WaterDestination * waterDestinationP = nodeP->waterDestinationP;
+                        Point waterDestinationPoint = waterDestinationP->point();
+                        CalcNumber waterDestinationExternalRadius = pipeObjectsBagP->getExternalDiameter(waterDestinationP->diameter()) / 2;
+                        if (separationY < waterDestinationPoint.y - waterDestinationExternalRadius || separationY > waterDestinationPoint.y + waterDestinationExternalRadius) {
+                            needToSeparate = true;
+                            break;
+                        }
                     }
                 }
-                
             }
-            
+            if (needToSeparate) {
+                separateNodeY(nodeP->id, separationY);
+                isSeparated = true;
+            }
+        }
+        
+        // в список возвращаются разделенный узел и новый узел, если в них осталось несколько точек входа
+        if (isSeparated) {
+            statistics.separationsCount++;
+            for (unsigned int index : { nodeIndex, static_cast<unsigned int>(nodePs.size() - 1) }) {
+                if (nodePs[index]->waterSourcesPs.size() > 1) {
+                    worklist.insert(index);
+                }
+            }
         }
         
     }
     
     recalculateWaterDestinationNodeP();
     
+    statistics.durationMilliseconds = std::chrono::duration<CalcNumber, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    return statistics;
+    
 }
 
-/// Разделить узел node на два вдоль прямой x = separationX.
+/// Вернуть узел, доступный для изменения в данном снимке графа. Если узел разделяется с другими снимками, он предварительно копируется.
 ///
-/// \param node Разделяемый узел.
-/// \param separationX X-координата сечения (единица измерения - мм.).
-void LocationGraph::separateNodeX(LocationGraphNode & node, CalcNumber separationX) {
+/// \param id Идентификатор узла. Узел должен содержаться в графе.
+///
+/// \return Указатель на узел, принадлежащий только данному снимку графа.
+LocationGraphNode * LocationGraph::mutableNodeP(unsigned int id) {
+    
+    unsigned int index = nodeIndexForId[id];
+    
+    if (nodeHolders[index].use_count() > 1) {
+        const LocationGraphNode * sharedNodeP = nodeHolders[index].get();
+        nodeHolders[index] = std::make_shared<LocationGraphNode>(*sharedNodeP);
+        nodePs[index] = nodeHolders[index].get();
+        if (waterDestinationNodeP == sharedNodeP) {
+            waterDestinationNodeP = nodePs[index];
+        }
+    }
+    
+    return nodeHolders[index].get();
+    
+}
+
+/// Вернуть пространственный индекс, доступный для изменения в данном снимке графа. Если индекс разделяется с другими снимками, он предварительно копируется.
+///
+/// \return Пространственный индекс, принадлежащий только данному снимку графа.
+LocationSpatialIndex & LocationGraph::mutableSpatialIndex() {
+    
+    if (spatialIndexP.use_count() > 1) {
+        spatialIndexP = std::make_shared<LocationSpatialIndex>(*spatialIndexP);
+    }
+    
+    return *spatialIndexP;
+    
+}
+
+/// Создать узел с новым идентификатором и добавить его в граф и в пространственный индекс. Связи узла не устанавливаются, пересечение с существующими узлами не проверяется.
+///
+/// \param left X-координата левого края узла (единица измерения - мм.).
+/// \param right X-координата правого края узла (единица измерения - мм.).
+/// \param bottom Y-координата нижнего края узла (единица измерения - мм.).
+/// \param top Y-координата верхнего края узла(единица измерения - мм.).
+///
+/// \return Указатель на созданный узел.
+LocationGraphNode * LocationGraph::createNodeAndReturnP(CalcNumber left, CalcNumber right, CalcNumber bottom, CalcNumber top) {
     
-    // создается новый узел (правый)
     unsigned int newId = generateNewNodeId();
-    LocationGraphNode * newNodeP = new LocationGraphNode(newId, separationX, node.right, node.bottom, node.top);
+    nodeHolders.push_back(std::make_shared<LocationGraphNode>(newId, left, right, bottom, top));
+    LocationGraphNode * newNodeP = nodeHolders[nodeHolders.size() - 1].get();
     nodePs.push_back(newNodeP);
-    nodePForId[newId] = newNodeP;
-    newNodeP->leftNodesPs.push_back(&node);
-    newNodeP->rightNodesPs = node.rightNodesPs;
-    for (LocationGraphNode * rightNodeP : node.rightNodesPs) {
-        auto iter = std::find(rightNodeP->leftNodesPs.begin(), rightNodeP->leftNodesPs.end(), &node);
-        *iter = newNodeP;
-    }
-    for (LocationGraphNode * bottomNodeP : node.bottomNodesPs) {
-        if (bottomNodeP->right > separationX) {
-            newNodeP->bottomNodesPs.push_back(bottomNodeP);
-            auto iter = std::find(bottomNodeP->topNodesPs.begin(), bottomNodeP->topNodesPs.end(), &node);
-            *iter = newNodeP;
+    
+    if (nodeIndexForId.size() <= newId) {
+        nodeIndexForId.resize(newId + 1, noNodeIndex);
+    }
+    nodeIndexForId[newId] = static_cast<unsigned int>(nodePs.size() - 1);
+    
+    mutableSpatialIndex().addNode(newNodeP);
+    return newNodeP;
+    
+}
+
+/// Разделить узел на два вдоль прямой x = separationX.
+///
+/// \param nodeId Идентификатор разделяемого узла.
+/// \param separationX X-координата сечения (единица измерения - мм.).
+void LocationGraph::separateNodeX(unsigned int nodeId, CalcNumber separationX) {
+    
+    LocationGraphNode & node = *mutableNodeP(nodeId);
+    
+    // создается новый узел (правый)
+    LocationGraphNode * newNodeP = createNodeAndReturnP(separationX, node.right, node.bottom, node.top);
+    newNodeP->leftNodesIds.push_back(node.id);
+    newNodeP->rightNodesIds = node.rightNodesIds;
+    for (unsigned int rightNodeId : node.rightNodesIds) {
+        LocationGraphNode * rightNodeP = mutableNodeP(rightNodeId);
+        auto iter = std::find(rightNodeP->leftNodesIds.begin(), rightNodeP->leftNodesIds.end(), node.id);
+        *iter = newNodeP->id;
+    }
+    for (unsigned int bottomNodeId : node.bottomNodesIds) {
+        if (nodePWithId(bottomNodeId)->right > separationX) {
+            newNodeP->bottomNodesIds.push_back(bottomNodeId);
+            LocationGraphNode * bottomNodeP = mutableNodeP(bottomNodeId);
+            auto iter = std::find(bottomNodeP->topNodesIds.begin(), bottomNodeP->topNodesIds.end(), node.id);
+            *iter = newNodeP->id;
         }
     }
-    for (LocationGraphNode * topNodeP : node.topNodesPs) {
-        if (topNodeP->right > separationX) {
-            newNodeP->topNodesPs.push_back(topNodeP);
-            auto iter = std::find(topNodeP->bottomNodesPs.begin(), topNodeP->bottomNodesPs.end(), &node);
-            *iter = newNodeP;
+    for (unsigned int topNodeId : node.topNodesIds) {
+        if (nodePWithId(topNodeId)->right > separationX) {
+            newNodeP->topNodesIds.push_back(topNodeId);
+            LocationGraphNode * topNodeP = mutableNodeP(topNodeId);
+            auto iter = std::find(topNodeP->bottomNodesIds.begin(), topNodeP->bottomNodesIds.end(), node.id);
+            *iter = newNodeP->id;
         }
     }
     for (int i = 0; i < node.waterSourcesPs.size(); i++) {
@@ -672,17 +953,20 @@ void LocationGraph::separateNodeX(LocationGraphNode & node, CalcNumber separatio
     }
     
     // корректируется имеющийся узел (левый)
+    LocationSpatialIndex & spatialIndex = mutableSpatialIndex();
+    spatialIndex.removeNode(&node);
     node.right = separationX;
-    node.rightNodesPs.clear();
-    node.rightNodesPs.push_back(newNodeP);
-    for (int i = static_cast<int>(node.bottomNodesPs.size()) - 1; i >= 0; i--) {
-        if (node.bottomNodesPs[i]->left > separationX) {
-            node.bottomNodesPs.erase(node.bottomNodesPs.begin() + i);
+    spatialIndex.addNode(&node);
+    node.rightNodesIds.clear();
+    node.rightNodesIds.push_back(newNodeP->id);
+    for (int i = static_cast<int>(node.bottomNodesIds.size()) - 1; i >= 0; i--) {
+        if (nodePWithId(node.bottomNodesIds[i])->left > separationX) {
+            node.bottomNodesIds.erase(node.bottomNodesIds.begin() + i);
         }
     }
-    for (int i = static_cast<int>(node.topNodesPs.size()) - 1; i >= 0; i--) {
-        if (node.topNodesPs[i]->left > separationX) {
-            node.topNodesPs.erase(node.topNodesPs.begin() + i);
+    for (int i = static_cast<int>(node.topNodesIds.size()) - 1; i >= 0; i--) {
+        if (nodePWithId(node.topNodesIds[i])->left > separationX) {
+            node.topNodesIds.erase(node.topNodesIds.begin() + i);
         }
     }
     for (int i = static_cast<int>(node.waterSourcesPs.size()) - 1; i >= 0 ; i--) {
@@ -697,36 +981,38 @@ void LocationGraph::separateNodeX(LocationGraphNode & node, CalcNumber separatio
     
 }
 
-/// Разделить узел node на два вдоль прямой y = separationY.
+/// Разделить узел на два вдоль прямой y = separationY.
 ///
-/// \param node Разделяемый узел.
+/// \param nodeId Идентификатор разделяемого узла.
 /// \param separationY Y-координата сечения (единица измерения - мм.).
-void LocationGraph::separateNodeY(LocationGraphNode & node, CalcNumber separationY) {
+void LocationGraph::separateNodeY(unsigned int nodeId, CalcNumber separationY) {
+    
+    LocationGraphNode & node = *mutableNodeP(nodeId);
     
     // создается новый узел (верхний)
-    unsigned int newId = generateNewNodeId();
-    LocationGraphNode * newNodeP = new LocationGraphNode(newId, node.left, node.right, separationY, node.top);
-    nodePs.push_back(newNodeP);
-    nodePForId[newId] = newNodeP;
-    for (LocationGraphNode * leftNodeP : node.leftNodesPs) {
-        if (leftNodeP->top > separationY) {
-            newNodeP->leftNodesPs.push_back(leftNodeP);
-            auto iter = std::find(leftNodeP->rightNodesPs.begin(), leftNodeP->rightNodesPs.end(), &node);
-            *iter = newNodeP;
+    LocationGraphNode * newNodeP = createNodeAndReturnP(node.left, node.right, separationY, node.top);
+    for (unsigned int leftNodeId : node.leftNodesIds) {
+        if (nodePWithId(leftNodeId)->top > separationY) {
+            newNodeP->leftNodesIds.push_back(leftNodeId);
+            LocationGraphNode * leftNodeP = mutableNodeP(leftNodeId);
+            auto iter = std::find(leftNodeP->rightNodesIds.begin(), leftNodeP->rightNodesIds.end(), node.id);
+            *iter = newNodeP->id;
         }
     }
-    for (LocationGraphNode * rightNodeP : node.rightNodesPs) {
-        if (rightNodeP->top > separationY) {
-            newNodeP->rightNodesPs.push_back(rightNodeP);
-            auto iter = std::find(rightNodeP->leftNodesPs.begin(), rightNodeP->leftNodesPs.end(), &node);
-            *iter = newNodeP;
+    for (unsigned int rightNodeId : node.rightNodesIds) {
+        if (nodePWithId(rightNodeId)->top > separationY) {
+            newNodeP->rightNodesIds.push_back(rightNodeId);
+            LocationGraphNode * rightNodeP = mutableNodeP(rightNodeId);
+            auto iter = std::find(rightNodeP->leftNodesIds.begin(), rightNodeP->leftNodesIds.end(), node.id);
+            *iter = newNodeP->id;
         }
     }
-    newNodeP->bottomNodesPs.push_back(&node);
-    newNodeP->topNodesPs = node.topNodesPs;
-    for (LocationGraphNode * topNodeP : node.topNodesPs) {
-        auto iter = std::find(topNodeP->bottomNodesPs.begin(), topNodeP->bottomNodesPs.end(), &node);
-        *iter = newNodeP;
+    newNodeP->bottomNodesIds.push_back(node.id);
+    newNodeP->topNodesIds = node.topNodesIds;
+    for (unsigned int topNodeId : node.topNodesIds) {
+        LocationGraphNode * topNodeP = mutableNodeP(topNodeId);
+        auto iter = std::find(topNodeP->bottomNodesIds.begin(), topNodeP->bottomNodesIds.end(), node.id);
+        *iter = newNodeP->id;
     }
     for (int i = 0; i < node.waterSourcesPs.size(); i++) {
         if (node.waterSourcesConnectionPoints[i].y > separationY) {
@@ -739,19 +1025,22 @@ void LocationGraph::separateNodeY(LocationGraphNode & node, CalcNumber separatio
     }
     
     // корректируется имеющийся узел (нижний)
+    LocationSpatialIndex & spatialIndex = mutableSpatialIndex();
+    spatialIndex.removeNode(&node);
     node.top = separationY;
-    for (int i = static_cast<int>(node.leftNodesPs.size()) - 1; i >= 0; i--) {
-        if (node.leftNodesPs[i]->bottom > separationY) {
-            node.leftNodesPs.erase(node.leftNodesPs.begin() + i);
+    spatialIndex.addNode(&node);
+    for (int i = static_cast<int>(node.leftNodesIds.size()) - 1; i >= 0; i--) {
+        if (nodePWithId(node.leftNodesIds[i])->bottom > separationY) {
+            node.leftNodesIds.erase(node.leftNodesIds.begin() + i);
         }
     }
-    for (int i = static_cast<int>(node.rightNodesPs.size()) - 1; i >= 0; i--) {
-        if (node.rightNodesPs[i]->bottom > separationY) {
-            node.rightNodesPs.erase(node.rightNodesPs.begin() + i);
+    for (int i = static_cast<int>(node.rightNodesIds.size()) - 1; i >= 0; i--) {
+        if (nodePWithId(node.rightNodesIds[i])->bottom > separationY) {
+            node.rightNodesIds.erase(node.rightNodesIds.begin() + i);
         }
     }
-    node.topNodesPs.clear();
-    node.topNodesPs.push_back(newNodeP);
+    node.topNodesIds.clear();
+    node.topNodesIds.push_back(newNodeP->id);
     for (int i = static_cast<int>(node.waterSourcesPs.size()) - 1; i >= 0 ; i--) {
         if (node.waterSourcesConnectionPoints[i].y > separationY) {
             node.waterSourcesPs.erase(node.waterSourcesPs.begin() + i);
@@ -775,4 +1064,84 @@ void LocationGraph::recalculateWaterDestinationNodeP() {
     
 }
 
+/// Найти пары узлов, граничащих по отрезку положительной длины, лежащему на вертикальной или горизонтальной прямой. Края узлов сортируются по прямой и началу края, после чего края на каждой прямой обходятся заметающей точкой. Метод бросает Exception-исключение, если некоторые узлы касаются друг друга только углами.
+///
+/// \param isVertical true, если ищутся связи типа левый-правый (общий край вертикален), false, если связи типа нижний-верхний.
+///
+/// \return Пары индексов узлов в массиве nodePs: (левый, правый) или (нижний, верхний), упорядоченные по возрастанию меньшего, затем большего индекса.
+std::vector<std::pair<int, int>> LocationGraph::findAdjacentNodeIndexPairs(bool isVertical) const {
+    
+    std::vector<NodeSide> sides;
+    sides.reserve(2 * nodePs.size());
+    
+    for (int i = 0; i < nodePs.size(); i++) {
+        const LocationGraphNode * nodeP = nodePs[i];
+        if (isVertical) {
+            sides.push_back(NodeSide { nodeP->right, nodeP->bottom, nodeP->top, i, true });
+            sides.push_back(NodeSide { nodeP->left, nodeP->bottom, nodeP->top, i, false });
+        } else {
+            sides.push_back(NodeSide { nodeP->top, nodeP->left, nodeP->right, i, true });
+            sides.push_back(NodeSide { nodeP->bottom, nodeP->left, nodeP->right, i, false });
+        }
+    }
+    
+    std::sort(sides.begin(), sides.end(), [] (const NodeSide & side1, const NodeSide & side2) {
+        if (side1.coordinate != side2.coordinate) {
+            return side1.coordinate < side2.coordinate;
+        }
+        return side1.start < side2.start;
+    });
+    
+    std::vector<std::pair<int, int>> nodeIndexPairs;
+    
+    // края, еще не закончившиеся на текущей прямой: правые (верхние) края узлов по одну сторону прямой и левые (нижние) - по другую; края одной стороны не перекрываются, поэтому массивы остаются короткими
+    std::vector<const NodeSide*> activeUpperSidePs;
+    std::vector<const NodeSide*> activeLowerSidePs;
+    
+    for (int i = 0; i < sides.size(); i++) {
+        
+        const NodeSide & side = sides[i];
+        
+        if (i == 0 || sides[i - 1].coordinate != side.coordinate) {
+            activeUpperSidePs.clear();
+            activeLowerSidePs.clear();
+        }
+        
+        // края, закончившиеся до начала текущего края, больше не могут с ним граничить
+        auto isFinished = [&side] (const NodeSide * activeSideP) { return activeSideP->end < side.start; };
+        activeUpperSidePs.erase(std::remove_if(activeUpperSidePs.begin(), activeUpperSidePs.end(), isFinished), activeUpperSidePs.end());
+        activeLowerSidePs.erase(std::remove_if(activeLowerSidePs.begin(), activeLowerSidePs.end(), isFinished), activeLowerSidePs.end());
+        
+        for (const NodeSide * oppositeSideP : (side.isUpperSide ? activeLowerSidePs : activeUpperSidePs)) {
+            
+            const NodeSide & lowerNodeSide = side.isUpperSide ? side : *oppositeSideP;
+            const NodeSide & upperNodeSide = side.isUpperSide ? *oppositeSideP : side;
+            const LocationGraphNode * lowerNodeP = nodePs[lowerNodeSide.nodeIndex];
+            const LocationGraphNode * upperNodeP = nodePs[upperNodeSide.nodeIndex];
+            
+            // край активен, только если он не закончился до начала текущего края, поэтому края пересекаются; касание в одной точке означает касание узлов углами
+            if (std::min(side.end, oppositeSideP->end) == side.start) {
+                if (isVertical) {
+                    throw Exception("Ошибка при соединении двух узлов связью типа \"левый-правый\". Узлы не обладают данной связью. Узлы: " + lowerNodeP->positionStr() + " и " + upperNodeP->positionStr() + ".");
+                } else {
+                    throw Exception("Ошибка при соединении двух узлов связью типа \"нижний-верхний\". Узлы не обладают данной связью. Узлы: " + lowerNodeP->positionStr() + " и " + upperNodeP->positionStr() + ".");
+                }
+            }
+            
+            nodeIndexPairs.push_back(std::pair<int, int>(lowerNodeSide.nodeIndex, upperNodeSide.nodeIndex));
+            
+        }
+        
+        (side.isUpperSide ? activeUpperSidePs : activeLowerSidePs).push_back(&side);
+        
+    }
+    
+    std::sort(nodeIndexPairs.begin(), nodeIndexPairs.end(), [] (const std::pair<int, int> & pair1, const std::pair<int, int> & pair2) {
+        return std::make_pair(std::min(pair1.first, pair1.second), std::max(pair1.first, pair1.second)) < std::make_pair(std::min(pair2.first, pair2.second), std::max(pair2.first, pair2.second));
+    });
+    
+    return nodeIndexPairs;
+    
+}
+
 #endif /* LocationGraph_hpp */
@@ -11,7 +11,7 @@
 #include "WaterSource.hpp"
 #include "WaterDestination.hpp"
 
-/// Узел графа локации. Представляет прямоугольную область, в которой могут проходить трубы трассы системы водоотведения.
+/// Узел графа локации. Представляет прямоугольную область, в которой могут проходить трубы трассы системы водоотведения. Связи узла хранятся в виде идентификаторов смежных узлов, поэтому узел может одновременно принадлежать нескольким снимкам графа локации.
 struct LocationGraphNode {
     
     // MARK: - Открытые объекты
@@ -31,17 +31,17 @@ struct LocationGraphNode {
     /// Y-координата верхнего края узла (единица измерения - мм.).
     CalcNumber top;
     
-    /// Указатели на левые узлы.
-    std::vector<LocationGraphNode*> leftNodesPs;
+    /// Идентификаторы левых узлов.
+    std::vector<unsigned int> leftNodesIds;
     
-    /// Указатели на правые узлы.
-    std::vector<LocationGraphNode*> rightNodesPs;
+    /// Идентификаторы правых узлов.
+    std::vector<unsigned int> rightNodesIds;
     
-    /// Указатели на нижние узлы.
-    std::vector<LocationGraphNode*> bottomNodesPs;
+    /// Идентификаторы нижних узлов.
+    std::vector<unsigned int> bottomNodesIds;
     
-    /// Указатели на верхние узлы.
-    std::vector<LocationGraphNode*> topNodesPs;
+    /// Идентификаторы верхних узлов.
+    std::vector<unsigned int> topNodesIds;
     
     /// Указатели на принадлежащие узлу источники воды.
     std::vector<const WaterSource*> waterSourcesPs;
@@ -75,10 +75,10 @@ struct LocationGraphNode {
     /// \return Толщина узла вдоль оси Oy (единица измерения - мм.).
     CalcNumber sizeY() const;
     
-    /// Вернуть массив указателей на все смежные узлы.
+    /// Вернуть массив идентификаторов всех смежных узлов.
     ///
-    /// \return Массив указателей на смежные узлы.
-    std::vector<LocationGraphNode*> adjacentNodes() const;
+    /// \return Массив идентификаторов смежных узлов.
+    std::vector<unsigned int> adjacentNodesIds() const;
     
     /// Вернуть строковое представление позиции узла на плоскости Oxy.
     ///
@@ -151,17 +151,17 @@ CalcNumber LocationGraphNode::sizeY() const {
     
 }
 
-/// Вернуть массив указателей на все смежные узлы.
+/// Вернуть массив идентификаторов всех смежных узлов.
 ///
-/// \return Массив указателей на смежные узлы.
-std::vector<LocationGraphNode*> LocationGraphNode::adjacentNodes() const {
+/// \return Массив идентификаторов смежных узлов.
+std::vector<unsigned int> LocationGraphNode::adjacentNodesIds() const {
     
-    std::vector<LocationGraphNode*> result;
+    std::vector<unsigned int> result;
     
-    result.insert(result.end(), leftNodesPs.begin(), leftNodesPs.end());
-    result.insert(result.end(), rightNodesPs.begin(), rightNodesPs.end());
-    result.insert(result.end(), bottomNodesPs.begin(), bottomNodesPs.end());
-    result.insert(result.end(), topNodesPs.begin(), topNodesPs.end());
+    result.insert(result.end(), leftNodesIds.begin(), leftNodesIds.end());
+    result.insert(result.end(), rightNodesIds.begin(), rightNodesIds.end());
+    result.insert(result.end(), bottomNodesIds.begin(), bottomNodesIds.end());
+    result.insert(result.end(), topNodesIds.begin(), topNodesIds.end());
     
     return result;
     
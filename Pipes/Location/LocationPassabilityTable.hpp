@@ -0,0 +1,229 @@
+#ifndef LocationPassabilityTable_hpp
+#define LocationPassabilityTable_hpp
+
+// Подключение стандартных библиотек
+#include <vector>
+#include <limits>
+
+// Подключение внутренних типов
+#include "CalcNumber.hpp"
+#include "LocationGraphNode.hpp"
+#include "CompactLocationGraph.hpp"
+#include "PipeObjectsBag.hpp"
+
+/// Таблица проходимости графа локации для каждого доступного диаметра труб. Связь между узлами считается проходимой для диаметра, если ширина общей границы узлов не меньше внешнего диаметра (то же условие, что и при построении портала между узлами). Для каждого диаметра узлы разбиты на компоненты связности по проходимым связям. Таблица строится один раз по компактному представлению графа локации и позволяет при поиске путей не рассматривать узкие проходы, а подключение источника, из компоненты которого недостижимы трасса и сток, отвергать без поиска.
+class LocationPassabilityTable {
+    
+public:
+    
+    // MARK: - Открытые объекты
+    
+    /// Значение индекса, обозначающее отсутствие диаметра или компоненты связности.
+    static constexpr unsigned int noIndex = std::numeric_limits<unsigned int>::max();
+    
+private:
+    
+    // MARK: - Скрытые объекты
+    
+    /// Диаметры, для которых построена таблица (единица измерения - мм.).
+    std::vector<unsigned int> diameters;
+    
+    /// Число связей компактного представления графа локации.
+    unsigned int edgesCount;
+    
+    /// Число узлов компактного представления графа локации.
+    unsigned int nodesCount;
+    
+    /// Флаги проходимости связей: для диаметра с индексом diameterIndex флаг связи с индексом edgeIndex хранится в позиции diameterIndex * edgesCount + edgeIndex.
+    std::vector<unsigned char> edgesPassability;
+    
+    /// Номера компонент связности узлов: для диаметра с индексом diameterIndex номер компоненты узла с индексом nodeIndex хранится в позиции diameterIndex * nodesCount + nodeIndex.
+    std::vector<unsigned int> componentForNode;
+    
+    /// Номера компонент связности, содержащих сток, для каждого диаметра, или noIndex, если сток отсутствует.
+    std::vector<unsigned int> destinationComponents;
+    
+public:
+    
+    // MARK: - Конструкторы
+    
+    /// Конструктор. Создается пустая таблица, не содержащая диаметров.
+    explicit LocationPassabilityTable();
+    
+    /// Конструктор. Таблица строится для всех доступных диаметров за время O(d * (n + e)), где d - число диаметров, n - число узлов, e - число связей.
+    ///
+    /// \param compactLocationGraph Компактное представление графа локации.
+    /// \param pipeObjectsBag Хранилище, содержащее доступные к использованию объекты системы водоотведения.
+    /// \param waterDestinationNodeP Указатель на узел графа локации, содержащий сток, или nullptr.
+    explicit LocationPassabilityTable(const CompactLocationGraph & compactLocationGraph, const PipeObjectsBag & pipeObjectsBag, const LocationGraphNode * waterDestinationNodeP);
+    
+    // MARK: - Открытые методы
+    
+    /// Вернуть число диаметров, для которых построена таблица.
+    ///
+    /// \return Число диаметров.
+    unsigned int getDiametersCount() const;
+    
+    /// Вернуть индекс диаметра в таблице.
+    ///
+    /// \param diameter Диаметр (единица измерения - мм.).
+    ///
+    /// \return Индекс диаметра или noIndex, если таблица для диаметра не построена.
+    unsigned int diameterIndexOf(unsigned int diameter) const;
+    
+    /// Проверить, проходима ли связь для диаметра.
+    ///
+    /// \param diameterIndex Индекс диаметра в таблице.
+    /// \param edgeIndex Индекс связи в компактном представлении графа локации.
+    ///
+    /// \return true, если ширина общей границы узлов не меньше внешнего диаметра, иначе false.
+    bool edgeIsPassable(unsigned int diameterIndex, unsigned int edgeIndex) const;
+    
+    /// Вернуть номер компоненты связности узла по проходимым для диаметра связям.
+    ///
+    /// \param diameterIndex Индекс диаметра в таблице.
+    /// \param nodeIndex Индекс узла в компактном представлении графа локации.
+    ///
+    /// \return Номер компоненты связности.
+    unsigned int componentOf(unsigned int diameterIndex, unsigned int nodeIndex) const;
+    
+    /// Проверить, достижим ли сток из узла по проходимым для диаметра связям.
+    ///
+    /// \param diameterIndex Индекс диаметра в таблице.
+    /// \param nodeIndex Индекс узла в компактном представлении графа локации.
+    ///
+    /// \return true, если узел и сток лежат в одной компоненте связности, иначе false.
+    bool destinationIsReachable(unsigned int diameterIndex, unsigned int nodeIndex) const;
+    
+};
+
+// MARK: - Реализация
+
+/// Конструктор. Создается пустая таблица, не содержащая диаметров.
+LocationPassabilityTable::LocationPassabilityTable(): edgesCount(0), nodesCount(0) {}
+
+/// Конструктор. Таблица строится для всех доступных диаметров за время O(d * (n + e)), где d - число диаметров, n - число узлов, e - число связей.
+///
+/// \param compactLocationGraph Компактное представление графа локации.
+/// \param pipeObjectsBag Хранилище, содержащее доступные к использованию объекты системы водоотведения.
+/// \param waterDestinationNodeP Указатель на узел графа локации, содержащий сток, или nullptr.
+LocationPassabilityTable::LocationPassabilityTable(const CompactLocationGraph & compactLocationGraph, const PipeObjectsBag & pipeObjectsBag, const LocationGraphNode * waterDestinationNodeP): diameters(*pipeObjectsBag.getDiametersP()), edgesCount(compactLocationGraph.edgesCount()), nodesCount(compactLocationGraph.nodesCount()) {
+    
+    edgesPassability.assign(diameters.size() * edgesCount, 0);
+    componentForNode.assign(diameters.size() * nodesCount, noIndex);
+    destinationComponents.assign(diameters.size(), noIndex);
+    
+    unsigned int waterDestinationNodeIndex = (waterDestinationNodeP == nullptr) ? noIndex : compactLocationGraph.indexOf(waterDestinationNodeP);
+    std::vector<unsigned int> stack;
+    
+    for (unsigned int diameterIndex = 0; diameterIndex < diameters.size(); diameterIndex++) {
+        
+        // половина внешнего диаметра вычисляется так же, как при построении портала, чтобы условия проходимости совпадали
+        CalcNumber externalDiameterHalfed = pipeObjectsBag.getExternalDiameter(diameters[diameterIndex]) / 2;
+        unsigned char * passabilityP = edgesPassability.data() + diameterIndex * edgesCount;
+        unsigned int * componentP = componentForNode.data() + diameterIndex * nodesCount;
+        
+        for (unsigned int nodeIndex = 0; nodeIndex < nodesCount; nodeIndex++) {
+            for (const CompactLocationGraph::Edge & edge : compactLocationGraph.edgesOf(nodeIndex)) {
+                CalcNumber width = 0;
+                if (edge.side == CompactLocationGraph::bottomSide || edge.side == CompactLocationGraph::topSide) {
+                    width = std::min(compactLocationGraph.right(nodeIndex), compactLocationGraph.right(edge.nodeIndex)) - std::max(compactLocationGraph.left(nodeIndex), compactLocationGraph.left(edge.nodeIndex));
+                } else {
+                    width = std::min(compactLocationGraph.top(nodeIndex), compactLocationGraph.top(edge.nodeIndex)) - std::max(compactLocationGraph.bottom(nodeIndex), compactLocationGraph.bottom(edge.nodeIndex));
+                }
+                passabilityP[compactLocationGraph.edgeIndexOf(edge)] = (width < 2 * externalDiameterHalfed) ? 0 : 1;
+            }
+        }
+        
+        // компоненты связности находятся обходом в глубину по проходимым связям; ширина общей границы не зависит от направления связи, поэтому компоненты корректны
+        unsigned int componentsCount = 0;
+        for (unsigned int startIndex = 0; startIndex < nodesCount; startIndex++) {
+            if (componentP[startIndex] != noIndex) {
+                continue;
+            }
+            componentP[startIndex] = componentsCount;
+            stack.push_back(startIndex);
+            while (stack.size() > 0) {
+                unsigned int nodeIndex = stack[stack.size() - 1];
+                stack.pop_back();
+                for (const CompactLocationGraph::Edge & edge : compactLocationGraph.edgesOf(nodeIndex)) {
+                    if (passabilityP[compactLocationGraph.edgeIndexOf(edge)] != 0 && componentP[edge.nodeIndex] == noIndex) {
+                        componentP[edge.nodeIndex] = componentsCount;
+                        stack.push_back(edge.nodeIndex);
+                    }
+                }
+            }
+            componentsCount++;
+        }
+        
+        if (waterDestinationNodeIndex != noIndex) {
+            destinationComponents[diameterIndex] = componentP[waterDestinationNodeIndex];
+        }
+        
+    }
+    
+}
+
+/// Вернуть число диаметров, для которых построена таблица.
+///
+/// \return Число диаметров.
+unsigned int LocationPassabilityTable::getDiametersCount() const {
+    
+    return static_cast<unsigned int>(diameters.size());
+    
+}
+
+/// Вернуть индекс диаметра в таблице.
+///
+/// \param diameter Диаметр (единица измерения - мм.).
+///
+/// \return Индекс диаметра или noIndex, если таблица для диаметра не построена.
+unsigned int LocationPassabilityTable::diameterIndexOf(unsigned int diameter) const {
+    
+    for (unsigned int diameterIndex = 0; diameterIndex < diameters.size(); diameterIndex++) {
+        if (diameters[diameterIndex] == diameter) {
+            return diameterIndex;
+        }
+    }
+    
+    return noIndex;
+    
+}
+
+/// Проверить, проходима ли связь для диаметра.
+///
+/// \param diameterIndex Индекс диаметра в таблице.
+/// \param edgeIndex Индекс связи в компактном представлении графа локации.
+///
+/// \return true, если ширина общей границы узлов не меньше внешнего диаметра, иначе false.
+bool LocationPassabilityTable::edgeIsPassable(unsigned int diameterIndex, unsigned int edgeIndex) const {
+    
+    return edgesPassability[diameterIndex * edgesCount + edgeIndex] != 0;
+    
+}
+
+/// Вернуть номер компоненты связности узла по проходимым для диаметра связям.
+///
+/// \param diameterIndex Индекс диаметра в таблице.
+/// \param nodeIndex Индекс узла в компактном представлении графа локации.
+///
+/// \return Номер компоненты связности.
+unsigned int LocationPassabilityTable::componentOf(unsigned int diameterIndex, unsigned int nodeIndex) const {
+    
+    return componentForNode[diameterIndex * nodesCount + nodeIndex];
+    
+}
+
+/// Проверить, достижим ли сток из узла по проходимым для диаметра связям.
+///
+/// \param diameterIndex Индекс диаметра в таблице.
+/// \param nodeIndex Индекс узла в компактном представлении графа локации.
+///
+/// \return true, если узел и сток лежат в одной компоненте связности, иначе false.
+bool LocationPassabilityTable::destinationIsReachable(unsigned int diameterIndex, unsigned int nodeIndex) const {
+    
+    return destinationComponents[diameterIndex] != noIndex && destinationComponents[diameterIndex] == componentOf(diameterIndex, nodeIndex);
+    
+}
+
+#endif /* LocationPassabilityTable_hpp */
@@ -0,0 +1,257 @@
+#ifndef LocationPolygonDecomposer_hpp
+#define LocationPolygonDecomposer_hpp
+
+// Подключение стандартных библиотек
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <utility>
+#include <algorithm>
+
+// Подключение внутренних типов
+#include "CalcNumber.hpp"
+#include "Point.hpp"
+#include "Exception.hpp"
+
+/// Разбиение свободного пространства, заданного прямолинейными многоугольниками, на прямоугольники. Многоугольники задаются замкнутыми контурами с ребрами, параллельными осям координат, и объединяются по правилу четности: контур, лежащий внутри другого контура, задает вырез (колонну, шахту). Используется эвристика полос: пространство режется прямыми, проходящими через вершины контуров, на полосы, внутри каждой полосы свободные участки объединяются в максимальные отрезки, а совпадающие отрезки соседних полос склеиваются в один прямоугольник. Разбиение строится вдоль обеих осей, и выбирается разбиение с меньшим числом прямоугольников. Точное минимальное разбиение не ищется, однако полученные прямоугольники, в отличие от произвольного жадного разбиения, никогда не касаются друг друга только углами (за исключением случаев, когда само свободное пространство касается себя в точке, - такие контуры отвергаются), поэтому по ним всегда можно построить связи графа локации.
+class LocationPolygonDecomposer {
+    
+public:
+    
+    // MARK: - Вспомогательные типы
+    
+    /// Прямоугольник разбиения.
+    struct Rectangle {
+        
+        /// X-координата левого края прямоугольника (единица измерения - мм.).
+        CalcNumber left;
+        
+        /// X-координата правого края прямоугольника (единица измерения - мм.).
+        CalcNumber right;
+        
+        /// Y-координата нижнего края прямоугольника (единица измерения - мм.).
+        CalcNumber bottom;
+        
+        /// Y-координата верхнего края прямоугольника (единица измерения - мм.).
+        CalcNumber top;
+        
+    };
+    
+private:
+    
+    /// Ребро контура, пересекающее полосы разбиения.
+    struct CrossingEdge {
+        
+        /// Координата ребра вдоль полосы (единица измерения - мм.).
+        CalcNumber position;
+        
+        /// Меньшая координата концов ребра поперек полосы (единица измерения - мм.).
+        CalcNumber begin;
+        
+        /// Большая координата концов ребра поперек полосы (единица измерения - мм.).
+        CalcNumber end;
+        
+    };
+    
+public:
+    
+    // MARK: - Открытые статические методы
+    
+    /// Разбить свободное пространство на прямоугольники. Метод бросает Exception-исключение, если контур содержит менее 4 различных вершин или ребро, не параллельное осям координат, или если свободное пространство касается себя в точке.
+    ///
+    /// \param contours Массив контуров. Каждый контур задается вершинами в порядке обхода, последняя вершина соединяется с первой. Координата z не учитывается.
+    ///
+    /// \return Непересекающиеся прямоугольники, упорядоченные по нижнему, затем по левому краю.
+    static std::vector<Rectangle> decompose(const std::vector<std::vector<Point>> & contours);
+    
+private:
+    
+    // MARK: - Скрытые статические методы
+    
+    /// Разбить свободное пространство на прямоугольники полосами, параллельными оси Ox (или оси Oy, если isTransposed == true).
+    ///
+    /// \param contours Массив проверенных контуров без повторяющихся соседних вершин.
+    /// \param isTransposed Флаг, указывающий, что полосы параллельны оси Oy.
+    ///
+    /// \return Непересекающиеся прямоугольники в исходных координатах.
+    static std::vector<Rectangle> decomposeIntoStrips(const std::vector<std::vector<Point>> & contours, bool isTransposed);
+    
+};
+
+// MARK: - Реализация
+
+/// Разбить свободное пространство на прямоугольники. Метод бросает Exception-исключение, если контур содержит менее 4 различных вершин или ребро, не параллельное осям координат, или если свободное пространство касается себя в точке.
+///
+/// \param contours Массив контуров. Каждый контур задается вершинами в порядке обхода, последняя вершина соединяется с первой. Координата z не учитывается.
+///
+/// \return Непересекающиеся прямоугольники, упорядоченные по нижнему, затем по левому краю.
+std::vector<LocationPolygonDecomposer::Rectangle> LocationPolygonDecomposer::decompose(const std::vector<std::vector<Point>> & contours) {
+    
+    // 1. Проверка контуров и удаление повторяющихся соседних вершин.
+    
+    std::vector<std::vector<Point>> checkedContours;
+    
+    for (unsigned int contourIndex = 0; contourIndex < contours.size(); contourIndex++) {
+        
+        std::string exceptionPrefix = "Ошибка при разбиении локации на прямоугольники. Контур с порядковым номером " + std::to_string(contourIndex + 1);
+        
+        std::vector<Point> vertices;
+        for (const Point & vertex : contours[contourIndex]) {
+            Point flatVertex(vertex.x, vertex.y, 0);
+            if (vertices.size() == 0 || vertices[vertices.size() - 1] != flatVertex) {
+                vertices.push_back(flatVertex);
+            }
+        }
+        if (vertices.size() > 1 && vertices[0] == vertices[vertices.size() - 1]) {
+            vertices.pop_back();
+        }
+        
+        if (vertices.size() < 4) {
+            throw Exception(exceptionPrefix + " содержит менее 4 различных вершин.");
+        }
+        
+        for (unsigned int vertexIndex = 0; vertexIndex < vertices.size(); vertexIndex++) {
+            const Point & vertex = vertices[vertexIndex];
+            const Point & nextVertex = vertices[(vertexIndex + 1) % vertices.size()];
+            if (vertex.x != nextVertex.x && vertex.y != nextVertex.y) {
+                throw Exception(exceptionPrefix + " содержит ребро, не параллельное осям координат: (" + std::to_string(vertex.x) + ", " + std::to_string(vertex.y) + ") - (" + std::to_string(nextVertex.x) + ", " + std::to_string(nextVertex.y) + ").");
+            }
+        }
+        
+        checkedContours.push_back(vertices);
+        
+    }
+    
+    // 2. Разбиение полосами вдоль обеих осей и выбор разбиения с меньшим числом прямоугольников.
+    
+    std::vector<Rectangle> rectangles = decomposeIntoStrips(checkedContours, false);
+    std::vector<Rectangle> transposedRectangles = decomposeIntoStrips(checkedContours, true);
+    if (transposedRectangles.size() < rectangles.size()) {
+        rectangles = transposedRectangles;
+    }
+    
+    std::sort(rectangles.begin(), rectangles.end(), [] (const Rectangle & a, const Rectangle & b) {
+        return (a.bottom < b.bottom) || (a.bottom == b.bottom && a.left < b.left);
+    });
+    
+    return rectangles;
+    
+}
+
+/// Разбить свободное пространство на прямоугольники полосами, параллельными оси Ox (или оси Oy, если isTransposed == true).
+///
+/// \param contours Массив проверенных контуров без повторяющихся соседних вершин.
+/// \param isTransposed Флаг, указывающий, что полосы параллельны оси Oy.
+///
+/// \return Непересекающиеся прямоугольники в исходных координатах.
+std::vector<LocationPolygonDecomposer::Rectangle> LocationPolygonDecomposer::decomposeIntoStrips(const std::vector<std::vector<Point>> & contours, bool isTransposed) {
+    
+    // далее u - координата вдоль полосы, v - координата поперек полосы
+    
+    // 1. Сбор ребер, пересекающих полосы, и границ полос.
+    
+    std::vector<CrossingEdge> crossingEdges;
+    std::set<CalcNumber> stripBordersSet;
+    
+    for (const std::vector<Point> & vertices : contours) {
+        for (unsigned int vertexIndex = 0; vertexIndex < vertices.size(); vertexIndex++) {
+            const Point & vertex = vertices[vertexIndex];
+            const Point & nextVertex = vertices[(vertexIndex + 1) % vertices.size()];
+            CalcNumber u = isTransposed ? vertex.y : vertex.x, nextU = isTransposed ? nextVertex.y : nextVertex.x;
+            CalcNumber v = isTransposed ? vertex.x : vertex.y, nextV = isTransposed ? nextVertex.x : nextVertex.y;
+            stripBordersSet.insert(v);
+            if (u == nextU) {
+                crossingEdges.push_back(CrossingEdge { u, std::min(v, nextV), std::max(v, nextV) });
+            }
+        }
+    }
+    
+    std::vector<CalcNumber> stripBorders(stripBordersSet.begin(), stripBordersSet.end());
+    std::sort(crossingEdges.begin(), crossingEdges.end(), [] (const CrossingEdge & a, const CrossingEdge & b) { return a.begin < b.begin; });
+    
+    // 2. Обход полос снизу вверх. Отрезки предыдущей полосы, еще не ставшие прямоугольниками, хранятся вместе с v-координатой начала.
+    
+    std::vector<Rectangle> rectangles;
+    std::map<std::pair<CalcNumber, CalcNumber>, CalcNumber> openSegments;
+    std::vector<CrossingEdge> activeEdges;
+    unsigned int nextEdgeIndex = 0;
+    
+    auto closeSegment = [&rectangles, isTransposed] (const std::pair<CalcNumber, CalcNumber> & segment, CalcNumber begin, CalcNumber end) {
+        if (isTransposed) {
+            rectangles.push_back(Rectangle { begin, end, segment.first, segment.second });
+        } else {
+            rectangles.push_back(Rectangle { segment.first, segment.second, begin, end });
+        }
+    };
+    
+    for (unsigned int stripIndex = 0; stripIndex + 1 < stripBorders.size(); stripIndex++) {
+        
+        CalcNumber stripBegin = stripBorders[stripIndex], stripEnd = stripBorders[stripIndex + 1];
+        
+        // активны ребра, целиком перекрывающие полосу
+        while (nextEdgeIndex < crossingEdges.size() && crossingEdges[nextEdgeIndex].begin <= stripBegin) {
+            activeEdges.push_back(crossingEdges[nextEdgeIndex]);
+            nextEdgeIndex++;
+        }
+        activeEdges.erase(std::remove_if(activeEdges.begin(), activeEdges.end(), [stripEnd] (const CrossingEdge & edge) { return edge.end < stripEnd; }), activeEdges.end());
+        
+        // свободные отрезки полосы по правилу четности; отрезки, касающиеся друг друга (общая стена соседних контуров), объединяются
+        std::vector<CalcNumber> positions;
+        for (const CrossingEdge & edge : activeEdges) {
+            positions.push_back(edge.position);
+        }
+        std::sort(positions.begin(), positions.end());
+        
+        std::vector<std::pair<CalcNumber, CalcNumber>> segments;
+        for (unsigned int positionIndex = 0; positionIndex + 1 < positions.size(); positionIndex += 2) {
+            if (positions[positionIndex] == positions[positionIndex + 1]) {
+                continue;
+            }
+            if (segments.size() > 0 && segments[segments.size() - 1].second == positions[positionIndex]) {
+                segments[segments.size() - 1].second = positions[positionIndex + 1];
+            } else {
+                segments.push_back(std::pair<CalcNumber, CalcNumber>(positions[positionIndex], positions[positionIndex + 1]));
+            }
+        }
+        
+        // отрезки соседних полос, касающиеся только концами, дали бы прямоугольники, касающиеся только углами
+        for (const std::pair<CalcNumber, CalcNumber> & segment : segments) {
+            for (const auto & openSegment : openSegments) {
+                if (openSegment.first.second == segment.first || openSegment.first.first == segment.second) {
+                    CalcNumber touchU = (openSegment.first.second == segment.first) ? segment.first : segment.second;
+                    CalcNumber touchX = isTransposed ? stripBegin : touchU, touchY = isTransposed ? touchU : stripBegin;
+                    throw Exception("Ошибка при разбиении локации на прямоугольники. Свободное пространство касается себя только в точке (" + std::to_string(touchX) + ", " + std::to_string(touchY) + ").");
+                }
+            }
+        }
+        
+        // совпадающие отрезки продолжаются, остальные отрезки предыдущей полосы становятся прямоугольниками
+        std::map<std::pair<CalcNumber, CalcNumber>, CalcNumber> nextOpenSegments;
+        for (const std::pair<CalcNumber, CalcNumber> & segment : segments) {
+            auto openSegmentIter = openSegments.find(segment);
+            if (openSegmentIter != openSegments.end()) {
+                nextOpenSegments[segment] = openSegmentIter->second;
+                openSegments.erase(openSegmentIter);
+            } else {
+                nextOpenSegments[segment] = stripBegin;
+            }
+        }
+        for (const auto & openSegment : openSegments) {
+            closeSegment(openSegment.first, openSegment.second, stripBegin);
+        }
+        openSegments = nextOpenSegments;
+        
+    }
+    
+    if (stripBorders.size() > 0) {
+        for (const auto & openSegment : openSegments) {
+            closeSegment(openSegment.first, openSegment.second, stripBorders[stripBorders.size() - 1]);
+        }
+    }
+    
+    return rectangles;
+    
+}
+
+#endif /* LocationPolygonDecomposer_hpp */
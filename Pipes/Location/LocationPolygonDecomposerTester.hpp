@@ -0,0 +1,155 @@
+#ifndef LocationPolygonDecomposerTester_hpp
+#define LocationPolygonDecomposerTester_hpp
+
+// Подключение стандартных библиотек
+#include <string>
+#include <vector>
+#include <iostream>
+#include <cassert>
+
+// Подключение внутренних типов
+#include "LocationPolygonDecomposer.hpp"
+
+/// Тестер для класса LocationPolygonDecomposer.
+class LocationPolygonDecomposerTester {
+    
+public:
+    
+    // MARK: - Открытые методы
+    
+    /// Тестировать класс LocationPolygonDecomposer.
+    void test();
+    
+private:
+    
+    // MARK: - Скрытые методы
+    
+    /// Вычислить суммарную площадь прямоугольников.
+    ///
+    /// \param rectangles Массив прямоугольников.
+    ///
+    /// \return Суммарная площадь прямоугольников.
+    CalcNumber calculateArea(const std::vector<LocationPolygonDecomposer::Rectangle> & rectangles);
+    
+    /// Проверить, что прямоугольники не пересекаются и никакие два прямоугольника не касаются друг друга только углами.
+    ///
+    /// \param rectangles Массив прямоугольников.
+    ///
+    /// \return true, если любые два прямоугольника либо не имеют общих точек, либо имеют общий отрезок положительной длины.
+    bool rectanglesAreConnectable(const std::vector<LocationPolygonDecomposer::Rectangle> & rectangles);
+    
+};
+
+// MARK: - Реализация
+
+/// Тестировать класс LocationPolygonDecomposer.
+void LocationPolygonDecomposerTester::test() {
+    
+    // прямоугольник
+    std::vector<LocationPolygonDecomposer::Rectangle> rectangles = LocationPolygonDecomposer::decompose({ { Point(0, 0, 0), Point(10, 0, 0), Point(10, 5, 0), Point(0, 5, 0) } });
+    assert(rectangles.size() == 1);
+    assert(rectangles[0].left == 0 && rectangles[0].right == 10 && rectangles[0].bottom == 0 && rectangles[0].top == 5);
+    
+    // повтор первой вершины в конце контура
+    rectangles = LocationPolygonDecomposer::decompose({ { Point(0, 0, 0), Point(10, 0, 0), Point(10, 5, 0), Point(0, 5, 0), Point(0, 0, 0) } });
+    assert(rectangles.size() == 1);
+    
+    // L-образное помещение
+    rectangles = LocationPolygonDecomposer::decompose({ { Point(0, 0, 0), Point(20, 0, 0), Point(20, 5, 0), Point(5, 5, 0), Point(5, 20, 0), Point(0, 20, 0) } });
+    assert(rectangles.size() == 2);
+    assert(calculateArea(rectangles) == 175);
+    assert(rectanglesAreConnectable(rectangles));
+    
+    // помещение с колонной
+    rectangles = LocationPolygonDecomposer::decompose({
+        { Point(0, 0, 0), Point(10, 0, 0), Point(10, 10, 0), Point(0, 10, 0) },
+        { Point(4, 4, 0), Point(6, 4, 0), Point(6, 6, 0), Point(4, 6, 0) }
+    });
+    assert(rectangles.size() == 4);
+    assert(calculateArea(rectangles) == 96);
+    assert(rectanglesAreConnectable(rectangles));
+    
+    // помещения с общей стеной объединяются
+    rectangles = LocationPolygonDecomposer::decompose({
+        { Point(0, 0, 0), Point(5, 0, 0), Point(5, 10, 0), Point(0, 10, 0) },
+        { Point(5, 0, 0), Point(10, 0, 0), Point(10, 10, 0), Point(5, 10, 0) }
+    });
+    assert(rectangles.size() == 1);
+    
+    // выбирается направление полос, дающее меньше прямоугольников: гребенка с зубцами вправо режется вертикальными полосами
+    rectangles = LocationPolygonDecomposer::decompose({ { Point(0, 0, 0), Point(20, 0, 0), Point(20, 10, 0), Point(10, 10, 0), Point(10, 20, 0), Point(20, 20, 0), Point(20, 30, 0), Point(10, 30, 0), Point(10, 40, 0), Point(20, 40, 0), Point(20, 50, 0), Point(0, 50, 0) } });
+    assert(rectangles.size() == 4);
+    assert(calculateArea(rectangles) == 800);
+    assert(rectanglesAreConnectable(rectangles));
+    
+    // ступенчатый коридор с вырезом: углы прямоугольников не должны касаться
+    rectangles = LocationPolygonDecomposer::decompose({
+        { Point(0, 0, 0), Point(30, 0, 0), Point(30, 30, 0), Point(10, 30, 0), Point(10, 20, 0), Point(0, 20, 0) },
+        { Point(20, 5, 0), Point(25, 5, 0), Point(25, 25, 0), Point(20, 25, 0) }
+    });
+    assert(calculateArea(rectangles) == 700);
+    assert(rectanglesAreConnectable(rectangles));
+    
+    // помещения, касающиеся только углом
+    bool isExceptionThrown = false;
+    try {
+        LocationPolygonDecomposer::decompose({
+            { Point(0, 0, 0), Point(5, 0, 0), Point(5, 5, 0), Point(0, 5, 0) },
+            { Point(5, 5, 0), Point(10, 5, 0), Point(10, 10, 0), Point(5, 10, 0) }
+        });
+    }
+    catch (const Exception & exception) {
+        isExceptionThrown = true;
+    }
+    assert(isExceptionThrown);
+    
+    // ребро, не параллельное осям координат
+    isExceptionThrown = false;
+    try {
+        LocationPolygonDecomposer::decompose({ { Point(0, 0, 0), Point(10, 0, 0), Point(10, 5, 0), Point(5, 10, 0), Point(0, 10, 0) } });
+    }
+    catch (const Exception & exception) {
+        isExceptionThrown = true;
+    }
+    assert(isExceptionThrown);
+    
+    std::cout << "Тестирование класса LocationPolygonDecomposer завершилось успешно.\n";
+    
+}
+
+/// Вычислить суммарную площадь прямоугольников.
+///
+/// \param rectangles Массив прямоугольников.
+///
+/// \return Суммарная площадь прямоугольников.
+CalcNumber LocationPolygonDecomposerTester::calculateArea(const std::vector<LocationPolygonDecomposer::Rectangle> & rectangles) {
+    
+    CalcNumber area = 0;
+    for (const LocationPolygonDecomposer::Rectangle & rectangle : rectangles) {
+        area += (rectangle.right - rectangle.left) * (rectangle.top - rectangle.bottom);
+    }
+    return area;
+    
+}
+
+/// Проверить, что прямоугольники не пересекаются и никакие два прямоугольника не касаются друг друга только углами.
+///
+/// \param rectangles Массив прямоугольников.
+///
+/// \return true, если любые два прямоугольника либо не имеют общих точек, либо имеют общий отрезок положительной длины.
+bool LocationPolygonDecomposerTester::rectanglesAreConnectable(const std::vector<LocationPolygonDecomposer::Rectangle> & rectangles) {
+    
+    for (unsigned int i = 0; i < rectangles.size(); i++) {
+        for (unsigned int j = i + 1; j < rectangles.size(); j++) {
+            CalcNumber overlapX = std::min(rectangles[i].right, rectangles[j].right) - std::max(rectangles[i].left, rectangles[j].left);
+            CalcNumber overlapY = std::min(rectangles[i].top, rectangles[j].top) - std::max(rectangles[i].bottom, rectangles[j].bottom);
+            if ((overlapX > 0 && overlapY > 0) || (overlapX == 0 && overlapY == 0)) {
+                return false;
+            }
+        }
+    }
+    return true;
+    
+}
+
+#endif /* LocationPolygonDecomposerTester_hpp */
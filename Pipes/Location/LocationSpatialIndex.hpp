@@ -0,0 +1,345 @@
+#ifndef LocationSpatialIndex_hpp
+#define LocationSpatialIndex_hpp
+
+// Подключение стандартных библиотек
+#include <vector>
+#include <map>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+
+// Подключение внутренних типов
+#include "CalcNumber.hpp"
+#include "Point.hpp"
+#include "LocationGraphNode.hpp"
+
+/// Пространственный индекс узлов графа локации на основе равномерной сетки. Каждый узел регистрируется во всех ячейках сетки, которые он покрывает (с учетом границ). Индекс хранит идентификаторы и границы узлов, а не указатели на них, поэтому может разделяться между снимками графа локации. Непустые ячейки хранятся в словаре, поэтому поиск ячейки занимает логарифмическое время, а запросы просматривают только ячейки вблизи запрашиваемой области. При равенстве результатов запроса выбирается узел с меньшим идентификатором, что соответствует порядку добавления узлов в граф.
+class LocationSpatialIndex {
+    
+    // MARK: - Вспомогательные типы
+    
+    /// Узел, зарегистрированный в ячейке сетки.
+    struct Entry {
+        
+        /// Идентификатор узла.
+        unsigned int id;
+        
+        /// X-координата левого края узла (единица измерения - мм.).
+        CalcNumber left;
+        
+        /// X-координата правого края узла (единица измерения - мм.).
+        CalcNumber right;
+        
+        /// Y-координата нижнего края узла (единица измерения - мм.).
+        CalcNumber bottom;
+        
+        /// Y-координата верхнего края узла (единица измерения - мм.).
+        CalcNumber top;
+        
+    };
+    
+    // MARK: - Скрытые объекты
+    
+    /// Размер ячейки сетки (единица измерения - мм.).
+    CalcNumber cellSize;
+    
+    /// Узлы, зарегистрированные в каждой непустой ячейке. Ключом является пара индексов ячейки вдоль осей Ox и Oy.
+    std::map<std::pair<long long, long long>, std::vector<Entry>> entriesForCell;
+    
+    /// Наименьший индекс ячейки вдоль оси Ox среди когда-либо занятых ячеек.
+    long long minCellX;
+    
+    /// Наибольший индекс ячейки вдоль оси Ox среди когда-либо занятых ячеек.
+    long long maxCellX;
+    
+    /// Наименьший индекс ячейки вдоль оси Oy среди когда-либо занятых ячеек.
+    long long minCellY;
+    
+    /// Наибольший индекс ячейки вдоль оси Oy среди когда-либо занятых ячеек.
+    long long maxCellY;
+    
+public:
+    
+    // MARK: - Конструкторы
+    
+    /// Конструктор. Создается пустой индекс.
+    ///
+    /// \param cellSize Размер ячейки сетки (единица измерения - мм.). Должен быть положительным.
+    explicit LocationSpatialIndex(CalcNumber cellSize);
+    
+    // MARK: - Открытые методы
+    
+    /// Очистить индекс.
+    void clear();
+    
+    /// Добавить узел в индекс. Запоминаются идентификатор и текущие границы узла.
+    ///
+    /// \param nodeP Указатель на добавляемый узел. Узел не должен содержаться в индексе.
+    void addNode(const LocationGraphNode * nodeP);
+    
+    /// Удалить узел из индекса. Узел находится по идентификатору. Метод должен вызываться до изменения границ узла.
+    ///
+    /// \param nodeP Указатель на удаляемый узел или на любую его копию.
+    void removeNode(const LocationGraphNode * nodeP);
+    
+    /// Найти узел, имеющий пересечение положительной площади с прямоугольником.
+    ///
+    /// \param left X-координата левого края прямоугольника (единица измерения - мм.).
+    /// \param right X-координата правого края прямоугольника (единица измерения - мм.).
+    /// \param bottom Y-координата нижнего края прямоугольника (единица измерения - мм.).
+    /// \param top Y-координата верхнего края прямоугольника (единица измерения - мм.).
+    ///
+    /// \return Наименьший идентификатор среди узлов, пересекающихся с прямоугольником, или 0, если таких узлов нет.
+    unsigned int findNodeIdWithNonZeroIntersectionArea(CalcNumber left, CalcNumber right, CalcNumber bottom, CalcNumber top) const;
+    
+    /// Найти узлы, пересекающиеся с прямоугольником. Касание границами считается пересечением.
+    ///
+    /// \param left X-координата левого края прямоугольника (единица измерения - мм.).
+    /// \param right X-координата правого края прямоугольника (единица измерения - мм.).
+    /// \param bottom Y-координата нижнего края прямоугольника (единица измерения - мм.).
+    /// \param top Y-координата верхнего края прямоугольника (единица измерения - мм.).
+    ///
+    /// \return Идентификаторы найденных узлов в порядке возрастания.
+    std::vector<unsigned int> findNodeIdsIntersectedWithRectangle(CalcNumber left, CalcNumber right, CalcNumber bottom, CalcNumber top) const;
+    
+    /// Найти узел, ближайший к точке point. Ячейки просматриваются кольцами возрастающего радиуса вокруг ячейки точки, пока следующее кольцо не может содержать более близкий узел.
+    ///
+    /// \param point Исходная точка (единица измерения - мм.).
+    ///
+    /// \return Идентификатор ближайшего узла (при равных расстояниях - наименьший) или 0, если индекс пуст.
+    unsigned int findClosestNodeId(const Point & point) const;
+    
+private:
+    
+    // MARK: - Скрытые методы
+    
+    /// Вычислить индекс ячейки, содержащей координату coordinate.
+    ///
+    /// \param coordinate Координата вдоль оси Ox или Oy (единица измерения - мм.).
+    ///
+    /// \return Индекс ячейки.
+    long long cellIndex(CalcNumber coordinate) const;
+    
+};
+
+// MARK: - Реализация
+
+/// Конструктор. Создается пустой индекс.
+///
+/// \param cellSize Размер ячейки сетки (единица измерения - мм.). Должен быть положительным.
+LocationSpatialIndex::LocationSpatialIndex(CalcNumber cellSize): cellSize(cellSize) {
+    
+    clear();
+    
+}
+
+/// Очистить индекс.
+void LocationSpatialIndex::clear() {
+    
+    entriesForCell.clear();
+    minCellX = minCellY = 0;
+    maxCellX = maxCellY = -1;
+    
+}
+
+/// Добавить узел в индекс. Запоминаются идентификатор и текущие границы узла.
+///
+/// \param nodeP Указатель на добавляемый узел. Узел не должен содержаться в индексе.
+void LocationSpatialIndex::addNode(const LocationGraphNode * nodeP) {
+    
+    long long leftCellX = cellIndex(nodeP->left), rightCellX = cellIndex(nodeP->right);
+    long long bottomCellY = cellIndex(nodeP->bottom), topCellY = cellIndex(nodeP->top);
+    
+    for (long long cellX = leftCellX; cellX <= rightCellX; cellX++) {
+        for (long long cellY = bottomCellY; cellY <= topCellY; cellY++) {
+            entriesForCell[std::make_pair(cellX, cellY)].push_back(Entry { nodeP->id, nodeP->left, nodeP->right, nodeP->bottom, nodeP->top });
+        }
+    }
+    
+    if (minCellX > maxCellX) {
+        minCellX = leftCellX;
+        maxCellX = rightCellX;
+        minCellY = bottomCellY;
+        maxCellY = topCellY;
+    } else {
+        minCellX = std::min(minCellX, leftCellX);
+        maxCellX = std::max(maxCellX, rightCellX);
+        minCellY = std::min(minCellY, bottomCellY);
+        maxCellY = std::max(maxCellY, topCellY);
+    }
+    
+}
+
+/// Удалить узел из индекса. Узел находится по идентификатору. Метод должен вызываться до изменения границ узла.
+///
+/// \param nodeP Указатель на удаляемый узел или на любую его копию.
+void LocationSpatialIndex::removeNode(const LocationGraphNode * nodeP) {
+    
+    for (long long cellX = cellIndex(nodeP->left); cellX <= cellIndex(nodeP->right); cellX++) {
+        for (long long cellY = cellIndex(nodeP->bottom); cellY <= cellIndex(nodeP->top); cellY++) {
+            auto cellIter = entriesForCell.find(std::make_pair(cellX, cellY));
+            if (cellIter == entriesForCell.end()) {
+                continue;
+            }
+            std::vector<Entry> & cellEntries = cellIter->second;
+            cellEntries.erase(std::remove_if(cellEntries.begin(), cellEntries.end(), [nodeP] (const Entry & entry) { return entry.id == nodeP->id; }), cellEntries.end());
+            if (cellEntries.size() == 0) {
+                entriesForCell.erase(cellIter);
+            }
+        }
+    }
+    
+}
+
+/// Найти узел, имеющий пересечение положительной площади с прямоугольником.
+///
+/// \param left X-координата левого края прямоугольника (единица измерения - мм.).
+/// \param right X-координата правого края прямоугольника (единица измерения - мм.).
+/// \param bottom Y-координата нижнего края прямоугольника (единица измерения - мм.).
+/// \param top Y-координата верхнего края прямоугольника (единица измерения - мм.).
+///
+/// \return Наименьший идентификатор среди узлов, пересекающихся с прямоугольником, или 0, если таких узлов нет.
+unsigned int LocationSpatialIndex::findNodeIdWithNonZeroIntersectionArea(CalcNumber left, CalcNumber right, CalcNumber bottom, CalcNumber top) const {
+    
+    unsigned int foundNodeId = 0;
+    
+    // рассматриваются только занятые ячейки
+    long long leftCellX = std::max(cellIndex(left), minCellX), rightCellX = std::min(cellIndex(right), maxCellX);
+    long long bottomCellY = std::max(cellIndex(bottom), minCellY), topCellY = std::min(cellIndex(top), maxCellY);
+    
+    for (long long cellX = leftCellX; cellX <= rightCellX; cellX++) {
+        for (long long cellY = bottomCellY; cellY <= topCellY; cellY++) {
+            auto cellIter = entriesForCell.find(std::make_pair(cellX, cellY));
+            if (cellIter == entriesForCell.end()) {
+                continue;
+            }
+            for (const Entry & entry : cellIter->second) {
+                if ((left >= entry.right || right <= entry.left || bottom >= entry.top || top <= entry.bottom) == false) {
+                    if (foundNodeId == 0 || entry.id < foundNodeId) {
+                        foundNodeId = entry.id;
+                    }
+                }
+            }
+        }
+    }
+    
+    return foundNodeId;
+    
+}
+
+/// Найти узлы, пересекающиеся с прямоугольником. Касание границами считается пересечением.
+///
+/// \param left X-координата левого края прямоугольника (единица измерения - мм.).
+/// \param right X-координата правого края прямоугольника (единица измерения - мм.).
+/// \param bottom Y-координата нижнего края прямоугольника (единица измерения - мм.).
+/// \param top Y-координата верхнего края прямоугольника (единица измерения - мм.).
+///
+/// \return Идентификаторы найденных узлов в порядке возрастания.
+std::vector<unsigned int> LocationSpatialIndex::findNodeIdsIntersectedWithRectangle(CalcNumber left, CalcNumber right, CalcNumber bottom, CalcNumber top) const {
+    
+    std::vector<unsigned int> foundNodeIds;
+    
+    // рассматриваются только занятые ячейки
+    long long leftCellX = std::max(cellIndex(left), minCellX), rightCellX = std::min(cellIndex(right), maxCellX);
+    long long bottomCellY = std::max(cellIndex(bottom), minCellY), topCellY = std::min(cellIndex(top), maxCellY);
+    
+    for (long long cellX = leftCellX; cellX <= rightCellX; cellX++) {
+        for (long long cellY = bottomCellY; cellY <= topCellY; cellY++) {
+            auto cellIter = entriesForCell.find(std::make_pair(cellX, cellY));
+            if (cellIter == entriesForCell.end()) {
+                continue;
+            }
+            for (const Entry & entry : cellIter->second) {
+                if ((left > entry.right || right < entry.left || bottom > entry.top || top < entry.bottom) == false) {
+                    foundNodeIds.push_back(entry.id);
+                }
+            }
+        }
+    }
+    
+    // узел, покрывающий несколько ячеек, найден в каждой из них
+    std::sort(foundNodeIds.begin(), foundNodeIds.end());
+    foundNodeIds.erase(std::unique(foundNodeIds.begin(), foundNodeIds.end()), foundNodeIds.end());
+    
+    return foundNodeIds;
+    
+}
+
+/// Найти узел, ближайший к точке point. Ячейки просматриваются кольцами возрастающего радиуса вокруг ячейки точки, пока следующее кольцо не может содержать более близкий узел.
+///
+/// \param point Исходная точка (единица измерения - мм.).
+///
+/// \return Идентификатор ближайшего узла (при равных расстояниях - наименьший) или 0, если индекс пуст.
+unsigned int LocationSpatialIndex::findClosestNodeId(const Point & point) const {
+    
+    if (entriesForCell.size() == 0) {
+        return 0;
+    }
+    
+    unsigned int closestNodeId = 0;
+    CalcNumber minDistance = 0;
+    
+    long long pointCellX = cellIndex(point.x), pointCellY = cellIndex(point.y);
+    
+    // кольца меньшего радиуса не содержат занятых ячеек, кольца большего радиуса лежат вне занятых ячеек
+    long long startRadius = std::max(std::max(minCellX - pointCellX, pointCellX - maxCellX), std::max(minCellY - pointCellY, pointCellY - maxCellY));
+    startRadius = std::max(startRadius, 0LL);
+    long long finishRadius = std::max(std::max(pointCellX - minCellX, maxCellX - pointCellX), std::max(pointCellY - minCellY, maxCellY - pointCellY));
+    
+    for (long long radius = startRadius; radius <= finishRadius; radius++) {
+        
+        long long bottomCellY = std::max(pointCellY - radius, minCellY), topCellY = std::min(pointCellY + radius, maxCellY);
+        
+        for (long long cellY = bottomCellY; cellY <= topCellY; cellY++) {
+            
+            // на нижней и верхней сторонах кольца просматриваются все ячейки, на остальных - только крайние
+            bool isWholeRow = (cellY == pointCellY - radius || cellY == pointCellY + radius);
+            long long leftCellX = std::max(pointCellX - radius, minCellX), rightCellX = std::min(pointCellX + radius, maxCellX);
+            
+            for (long long cellX = leftCellX; cellX <= rightCellX; cellX++) {
+                
+                if (isWholeRow == false && cellX != pointCellX - radius && cellX != pointCellX + radius) {
+                    cellX = pointCellX + radius - 1;
+                    continue;
+                }
+                
+                auto cellIter = entriesForCell.find(std::make_pair(cellX, cellY));
+                if (cellIter == entriesForCell.end()) {
+                    continue;
+                }
+                
+                for (const Entry & entry : cellIter->second) {
+                    CalcNumber distance = LocationGraphNode(entry.id, entry.left, entry.right, entry.bottom, entry.top).findClosestPoint(point).distanceToPoint(point);
+                    if (closestNodeId == 0 || distance < minDistance || (distance == minDistance && entry.id < closestNodeId)) {
+                        closestNodeId = entry.id;
+                        minDistance = distance;
+                    }
+                }
+                
+            }
+            
+        }
+        
+        // ячейки следующих колец удалены от точки не менее чем на radius * cellSize
+        if (closestNodeId != 0 && minDistance < radius * cellSize) {
+            break;
+        }
+        
+    }
+    
+    return closestNodeId;
+    
+}
+
+/// Вычислить индекс ячейки, содержащей координату coordinate.
+///
+/// \param coordinate Координата вдоль оси Ox или Oy (единица измерения - мм.).
+///
+/// \return Индекс ячейки.
+long long LocationSpatialIndex::cellIndex(CalcNumber coordinate) const {
+    
+    return static_cast<long long>(std::floor(coordinate / cellSize));
+    
+}
+
+#endif /* LocationSpatialIndex_hpp */
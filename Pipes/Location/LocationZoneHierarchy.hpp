@@ -0,0 +1,475 @@
+#ifndef LocationZoneHierarchy_hpp
+#define LocationZoneHierarchy_hpp
+
+// Подключение стандартных библиотек
+#include <vector>
+#include <map>
+#include <set>
+#include <queue>
+#include <functional>
+#include <utility>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+// Подключение внутренних типов
+#include "CalcNumber.hpp"
+#include "CompactLocationGraph.hpp"
+#include "LocationPassabilityTable.hpp"
+
+/// Двухуровневая иерархия графа локации для поиска путей в больших локациях. Узлы графа группируются в зоны: узлы, центры которых лежат в одной ячейке квадратной сетки, разбиваются на связные группы, каждая группа образует зону. Связи между узлами разных зон называются порталами, а узлы, имеющие такие связи, - портальными. Для каждого портального узла заранее вычисляются расстояния внутри его зоны до всех узлов зоны - отдельно для каждого диаметра таблицы проходимости (по проходимым для диаметра связям) и без учета проходимости, поэтому грубый поиск пути просматривает только порталы, а не все узлы графа. Найденная последовательность зон (коридор) расширяется смежными зонами и используется для ограничения точного поиска пути.
+///
+/// Длиной связи между узлами считается длина ломаной от центра узла через середину общей границы до центра смежного узла. Эта длина лишь приближает псевдодлину ломаной трубы, поэтому коридор является эвристикой: если точный поиск в коридоре неуспешен, его следует повторить по всему графу.
+class LocationZoneHierarchy {
+    
+public:
+    
+    // MARK: - Открытые объекты
+    
+    /// Значение индекса, обозначающее отсутствие зоны или узла.
+    static constexpr unsigned int noIndex = std::numeric_limits<unsigned int>::max();
+    
+private:
+    
+    // MARK: - Скрытые вспомогательные типы
+    
+    /// Элемент очереди с приоритетом при грубом поиске пути.
+    struct CoarseQueueItem {
+        
+        /// Длина пути (единица измерения - мм.).
+        CalcNumber length;
+        
+        /// Индекс узла входа в зону. Для завершающего элемента - индекс конечного узла.
+        unsigned int nodeIndex;
+        
+        /// Индекс узла входа в зону, из которой достигнут конечный узел, или noIndex, если конечный узел лежит в начальной зоне. Используется только для завершающего элемента.
+        unsigned int entryNodeIndex;
+        
+        /// Флаг завершающего элемента.
+        bool isFinal;
+        
+        /// Проверить, должен ли данный элемент извлекаться из очереди позже элемента anotherItem.
+        ///
+        /// \param anotherItem Другой элемент очереди.
+        ///
+        /// \return true, если данный элемент должен извлекаться позже, иначе false.
+        bool operator>(const CoarseQueueItem & anotherItem) const {
+            return (length != anotherItem.length) ? length > anotherItem.length : nodeIndex > anotherItem.nodeIndex;
+        }
+        
+    };
+    
+    /// Метка узла входа в зону при грубом поиске пути.
+    struct CoarseLabel {
+        
+        /// Длина пути от начального узла до узла входа (единица измерения - мм.).
+        CalcNumber length;
+        
+        /// Индекс предыдущего узла входа или noIndex, если предыдущей является начальная зона.
+        unsigned int previousEntryNodeIndex;
+        
+        /// Флаг окончательной обработки узла входа.
+        bool isSettled;
+        
+    };
+    
+    // MARK: - Скрытые объекты
+    
+    /// Число зон.
+    unsigned int zonesCount;
+    
+    /// Индексы зон узлов по индексам узлов компактного представления графа локации.
+    std::vector<unsigned int> zoneForNode;
+    
+    /// Индексы узлов внутри их зон.
+    std::vector<unsigned int> localIndexForNode;
+    
+    /// Число узлов в каждой зоне.
+    std::vector<unsigned int> zoneSizes;
+    
+    /// Число диаметров таблицы проходимости, по которой построена иерархия. Расстояния внутри зон хранятся для каждого диаметра и дополнительно для поиска без учета проходимости, всего - diametersCount + 1 вариантов.
+    unsigned int diametersCount;
+    
+    /// Начала диапазонов портальных узлов зон в массиве portalNodes. Диапазон зоны с индексом zoneIndex занимает позиции от portalNodesStarts[zoneIndex] до portalNodesStarts[zoneIndex + 1].
+    std::vector<unsigned int> portalNodesStarts;
+    
+    /// Индексы портальных узлов, сгруппированные по зонам.
+    std::vector<unsigned int> portalNodes;
+    
+    /// Начала массивов расстояний портальных узлов в массиве portalDistances или noIndex для непортальных узлов. Для варианта проходимости variantIndex (см. variantIndexOf) расстояние от портального узла до узла той же зоны с локальным индексом localIndex хранится в позиции portalDistancesStarts[variantIndex * n + nodeIndex] + localIndex, где n - число узлов.
+    std::vector<unsigned int> portalDistancesStarts;
+    
+    /// Расстояния внутри зон от портальных узлов до узлов их зон (единица измерения - мм.). Недостижимые узлы имеют расстояние, равное std::numeric_limits<CalcNumber>::max().
+    std::vector<CalcNumber> portalDistances;
+    
+public:
+    
+    // MARK: - Конструкторы
+    
+    /// Конструктор. Создается пустая иерархия, не содержащая зон.
+    explicit LocationZoneHierarchy();
+    
+    /// Конструктор. Иерархия строится по компактному представлению графа локации.
+    ///
+    /// \param compactLocationGraph Компактное представление графа локации.
+    /// \param locationPassabilityTable Таблица проходимости, построенная по тому же компактному представлению. Используется при вычислении расстояний внутри зон.
+    /// \param zoneSize Размер ячейки сетки, по которой узлы группируются в зоны (единица измерения - мм.). Должен быть положительным.
+    explicit LocationZoneHierarchy(const CompactLocationGraph & compactLocationGraph, const LocationPassabilityTable & locationPassabilityTable, CalcNumber zoneSize);
+    
+    // MARK: - Открытые методы
+    
+    /// Вернуть число зон.
+    ///
+    /// \return Число зон.
+    unsigned int getZonesCount() const;
+    
+    /// Вернуть число портальных узлов.
+    ///
+    /// \return Число портальных узлов.
+    unsigned int getPortalNodesCount() const;
+    
+    /// Найти коридор кратчайшего пути от узла до ближайшего из конечных узлов грубым поиском по порталам. Связи, непроходимые для диаметра, не рассматриваются ни между зонами, ни внутри зон.
+    ///
+    /// \param compactLocationGraph Компактное представление графа локации, по которому построена иерархия.
+    /// \param startNodeIndex Индекс начального узла.
+    /// \param targetNodeIndexes Индексы конечных узлов.
+    /// \param locationPassabilityTable Таблица проходимости связей графа локации, по которой построена иерархия.
+    /// \param diameterIndex Индекс диаметра в таблице проходимости или LocationPassabilityTable::noIndex, если проходимость не учитывается.
+    ///
+    /// \return Флаги принадлежности узлов коридору по индексам узлов компактного представления: коридор состоит из зон найденного пути и смежных с ними зон. Если путь не найден, возвращается пустой массив.
+    std::vector<unsigned char> findCorridor(const CompactLocationGraph & compactLocationGraph, unsigned int startNodeIndex, const std::vector<unsigned int> & targetNodeIndexes, const LocationPassabilityTable & locationPassabilityTable, unsigned int diameterIndex) const;
+    
+private:
+    
+    // MARK: - Скрытые методы
+    
+    /// Вычислить длину связи: длину ломаной от центра узла через середину общей границы до центра смежного узла.
+    ///
+    /// \param compactLocationGraph Компактное представление графа локации.
+    /// \param nodeIndex Индекс узла.
+    /// \param adjacentNodeIndex Индекс смежного узла.
+    ///
+    /// \return Длина связи (единица измерения - мм.).
+    static CalcNumber calculateEdgeLength(const CompactLocationGraph & compactLocationGraph, unsigned int nodeIndex, unsigned int adjacentNodeIndex);
+    
+    /// Вернуть индекс варианта проходимости, для которого хранятся расстояния внутри зон.
+    ///
+    /// \param diameterIndex Индекс диаметра в таблице проходимости или LocationPassabilityTable::noIndex.
+    ///
+    /// \return Индекс диаметра или diametersCount, если проходимость не учитывается.
+    unsigned int variantIndexOf(unsigned int diameterIndex) const;
+    
+    /// Вычислить расстояния внутри зоны от узла до всех узлов его зоны (алгоритм Дейкстры по связям, не выходящим из зоны и проходимым для диаметра).
+    ///
+    /// \param compactLocationGraph Компактное представление графа локации.
+    /// \param nodeIndex Индекс начального узла.
+    /// \param locationPassabilityTable Таблица проходимости связей графа локации.
+    /// \param diameterIndex Индекс диаметра в таблице проходимости или LocationPassabilityTable::noIndex, если проходимость не учитывается.
+    ///
+    /// \return Расстояния по локальным индексам узлов зоны (единица измерения - мм.). Недостижимые узлы имеют расстояние, равное std::numeric_limits<CalcNumber>::max().
+    std::vector<CalcNumber> calculateLocalDistances(const CompactLocationGraph & compactLocationGraph, unsigned int nodeIndex, const LocationPassabilityTable & locationPassabilityTable, unsigned int diameterIndex) const;
+    
+};
+
+// MARK: - Реализация
+
+/// Конструктор. Создается пустая иерархия, не содержащая зон.
+LocationZoneHierarchy::LocationZoneHierarchy(): zonesCount(0), diametersCount(0) {}
+
+/// Конструктор. Иерархия строится по компактному представлению графа локации.
+///
+/// \param compactLocationGraph Компактное представление графа локации.
+/// \param locationPassabilityTable Таблица проходимости, построенная по тому же компактному представлению. Используется при вычислении расстояний внутри зон.
+/// \param zoneSize Размер ячейки сетки, по которой узлы группируются в зоны (единица измерения - мм.). Должен быть положительным.
+LocationZoneHierarchy::LocationZoneHierarchy(const CompactLocationGraph & compactLocationGraph, const LocationPassabilityTable & locationPassabilityTable, CalcNumber zoneSize): zonesCount(0), diametersCount(locationPassabilityTable.getDiametersCount()) {
+    
+    unsigned int nodesCount = compactLocationGraph.nodesCount();
+    
+    // 1. Разбиение узлов на зоны: узлы одной ячейки сетки, связанные друг с другом внутри ячейки, образуют зону.
+    
+    std::vector<std::pair<long long, long long>> cellForNode(nodesCount);
+    for (unsigned int nodeIndex = 0; nodeIndex < nodesCount; nodeIndex++) {
+        CalcNumber centerX = (compactLocationGraph.left(nodeIndex) + compactLocationGraph.right(nodeIndex)) / 2;
+        CalcNumber centerY = (compactLocationGraph.bottom(nodeIndex) + compactLocationGraph.top(nodeIndex)) / 2;
+        cellForNode[nodeIndex] = std::make_pair(static_cast<long long>(std::floor(centerX / zoneSize)), static_cast<long long>(std::floor(centerY / zoneSize)));
+    }
+    
+    zoneForNode.assign(nodesCount, noIndex);
+    localIndexForNode.assign(nodesCount, noIndex);
+    std::vector<unsigned int> stack;
+    
+    for (unsigned int startIndex = 0; startIndex < nodesCount; startIndex++) {
+        if (zoneForNode[startIndex] != noIndex) {
+            continue;
+        }
+        zoneSizes.push_back(0);
+        zoneForNode[startIndex] = zonesCount;
+        stack.push_back(startIndex);
+        while (stack.size() > 0) {
+            unsigned int nodeIndex = stack[stack.size() - 1];
+            stack.pop_back();
+            localIndexForNode[nodeIndex] = zoneSizes[zonesCount]++;
+            for (const CompactLocationGraph::Edge & edge : compactLocationGraph.edgesOf(nodeIndex)) {
+                if (zoneForNode[edge.nodeIndex] == noIndex && cellForNode[edge.nodeIndex] == cellForNode[nodeIndex]) {
+                    zoneForNode[edge.nodeIndex] = zonesCount;
+                    stack.push_back(edge.nodeIndex);
+                }
+            }
+        }
+        zonesCount++;
+    }
+    
+    // 2. Поиск портальных узлов и группировка их по зонам.
+    
+    std::vector<std::vector<unsigned int>> portalNodesForZone(zonesCount);
+    for (unsigned int nodeIndex = 0; nodeIndex < nodesCount; nodeIndex++) {
+        for (const CompactLocationGraph::Edge & edge : compactLocationGraph.edgesOf(nodeIndex)) {
+            if (zoneForNode[edge.nodeIndex] != zoneForNode[nodeIndex]) {
+                portalNodesForZone[zoneForNode[nodeIndex]].push_back(nodeIndex);
+                break;
+            }
+        }
+    }
+    
+    portalNodesStarts.push_back(0);
+    for (const std::vector<unsigned int> & zonePortalNodes : portalNodesForZone) {
+        portalNodes.insert(portalNodes.end(), zonePortalNodes.begin(), zonePortalNodes.end());
+        portalNodesStarts.push_back(static_cast<unsigned int>(portalNodes.size()));
+    }
+    
+    // 3. Вычисление расстояний от портальных узлов до узлов их зон для каждого диаметра и без учета проходимости.
+    
+    portalDistancesStarts.assign((diametersCount + 1) * nodesCount, noIndex);
+    for (unsigned int variantIndex = 0; variantIndex <= diametersCount; variantIndex++) {
+        unsigned int diameterIndex = (variantIndex == diametersCount) ? LocationPassabilityTable::noIndex : variantIndex;
+        for (unsigned int portalNodeIndex : portalNodes) {
+            std::vector<CalcNumber> distances = calculateLocalDistances(compactLocationGraph, portalNodeIndex, locationPassabilityTable, diameterIndex);
+            portalDistancesStarts[variantIndex * nodesCount + portalNodeIndex] = static_cast<unsigned int>(portalDistances.size());
+            portalDistances.insert(portalDistances.end(), distances.begin(), distances.end());
+        }
+    }
+    
+}
+
+/// Вернуть число зон.
+///
+/// \return Число зон.
+unsigned int LocationZoneHierarchy::getZonesCount() const {
+    
+    return zonesCount;
+    
+}
+
+/// Вернуть число портальных узлов.
+///
+/// \return Число портальных узлов.
+unsigned int LocationZoneHierarchy::getPortalNodesCount() const {
+    
+    return static_cast<unsigned int>(portalNodes.size());
+    
+}
+
+/// Найти коридор кратчайшего пути от узла до ближайшего из конечных узлов грубым поиском по порталам. Связи, непроходимые для диаметра, не рассматриваются ни между зонами, ни внутри зон.
+///
+/// \param compactLocationGraph Компактное представление графа локации, по которому построена иерархия.
+/// \param startNodeIndex Индекс начального узла.
+/// \param targetNodeIndexes Индексы конечных узлов.
+/// \param locationPassabilityTable Таблица проходимости связей графа локации, по которой построена иерархия.
+/// \param diameterIndex Индекс диаметра в таблице проходимости или LocationPassabilityTable::noIndex, если проходимость не учитывается.
+///
+/// \return Флаги принадлежности узлов коридору по индексам узлов компактного представления: коридор состоит из зон найденного пути и смежных с ними зон. Если путь не найден, возвращается пустой массив.
+std::vector<unsigned char> LocationZoneHierarchy::findCorridor(const CompactLocationGraph & compactLocationGraph, unsigned int startNodeIndex, const std::vector<unsigned int> & targetNodeIndexes, const LocationPassabilityTable & locationPassabilityTable, unsigned int diameterIndex) const {
+    
+    // Грубый поиск - алгоритм Дейкстры, вершинами которого являются узлы входа в зоны. Из узла входа путь продолжается по заранее вычисленным расстояниям до портальных узлов его зоны и далее через порталы в узлы входа смежных зон. Метки хранятся в словаре, поэтому поиск затрагивает только просмотренные порталы.
+    
+    std::map<unsigned int, std::vector<unsigned int>> targetNodeIndexesForZone;
+    for (unsigned int targetNodeIndex : targetNodeIndexes) {
+        targetNodeIndexesForZone[zoneForNode[targetNodeIndex]].push_back(targetNodeIndex);
+    }
+    
+    std::map<unsigned int, CoarseLabel> labels;
+    std::priority_queue<CoarseQueueItem, std::vector<CoarseQueueItem>, std::greater<CoarseQueueItem>> queue;
+    
+    // продолжение пути из зоны, в которую выполнен вход в узел entryNodeIndex (или из начальной зоны, если entryNodeIndex == noIndex), по расстояниям distancesP внутри зоны
+    auto expandZone = [&] (unsigned int zoneIndex, unsigned int entryNodeIndex, CalcNumber entryLength, const CalcNumber * distancesP) {
+        auto targetsIter = targetNodeIndexesForZone.find(zoneIndex);
+        if (targetsIter != targetNodeIndexesForZone.end()) {
+            for (unsigned int targetNodeIndex : targetsIter->second) {
+                CalcNumber distance = distancesP[localIndexForNode[targetNodeIndex]];
+                if (distance != std::numeric_limits<CalcNumber>::max()) {
+                    queue.push(CoarseQueueItem { entryLength + distance, targetNodeIndex, entryNodeIndex, true });
+                }
+            }
+        }
+        for (unsigned int position = portalNodesStarts[zoneIndex]; position < portalNodesStarts[zoneIndex + 1]; position++) {
+            unsigned int portalNodeIndex = portalNodes[position];
+            CalcNumber distance = distancesP[localIndexForNode[portalNodeIndex]];
+            if (distance == std::numeric_limits<CalcNumber>::max()) {
+                continue;
+            }
+            for (const CompactLocationGraph::Edge & edge : compactLocationGraph.edgesOf(portalNodeIndex)) {
+                if (zoneForNode[edge.nodeIndex] == zoneIndex) {
+                    continue;
+                }
+                if (diameterIndex != LocationPassabilityTable::noIndex && locationPassabilityTable.edgeIsPassable(diameterIndex, compactLocationGraph.edgeIndexOf(edge)) == false) {
+                    continue;
+                }
+                CalcNumber newLength = entryLength + distance + calculateEdgeLength(compactLocationGraph, portalNodeIndex, edge.nodeIndex);
+                auto labelIter = labels.find(edge.nodeIndex);
+                if (labelIter == labels.end()) {
+                    labels[edge.nodeIndex] = CoarseLabel { newLength, entryNodeIndex, false };
+                    queue.push(CoarseQueueItem { newLength, edge.nodeIndex, noIndex, false });
+                } else if (labelIter->second.isSettled == false && newLength < labelIter->second.length) {
+                    labelIter->second = CoarseLabel { newLength, entryNodeIndex, false };
+                    queue.push(CoarseQueueItem { newLength, edge.nodeIndex, noIndex, false });
+                }
+            }
+        }
+    };
+    
+    unsigned int distancesOffset = variantIndexOf(diameterIndex) * compactLocationGraph.nodesCount();
+    std::vector<CalcNumber> startDistances = calculateLocalDistances(compactLocationGraph, startNodeIndex, locationPassabilityTable, diameterIndex);
+    expandZone(zoneForNode[startNodeIndex], noIndex, 0, startDistances.data());
+    
+    std::set<unsigned int> pathZones;
+    bool pathIsFound = false;
+    
+    while (queue.empty() == false) {
+        
+        CoarseQueueItem item = queue.top();
+        queue.pop();
+        
+        if (item.isFinal) {
+            // восстановление зон пути от конечной зоны до начальной
+            pathZones.insert(zoneForNode[item.nodeIndex]);
+            for (unsigned int entryNodeIndex = item.entryNodeIndex; entryNodeIndex != noIndex; entryNodeIndex = labels[entryNodeIndex].previousEntryNodeIndex) {
+                pathZones.insert(zoneForNode[entryNodeIndex]);
+            }
+            pathZones.insert(zoneForNode[startNodeIndex]);
+            pathIsFound = true;
+            break;
+        }
+        
+        CoarseLabel & label = labels[item.nodeIndex];
+        if (label.isSettled || item.length > label.length) {
+            // устаревший элемент очереди
+            continue;
+        }
+        label.isSettled = true;
+        
+        // расстояния от узла входа, не являющегося портальным узлом своей зоны, вычисляются при необходимости
+        std::vector<CalcNumber> entryDistances;
+        const CalcNumber * distancesP = nullptr;
+        if (portalDistancesStarts[distancesOffset + item.nodeIndex] != noIndex) {
+            distancesP = portalDistances.data() + portalDistancesStarts[distancesOffset + item.nodeIndex];
+        } else {
+            entryDistances = calculateLocalDistances(compactLocationGraph, item.nodeIndex, locationPassabilityTable, diameterIndex);
+            distancesP = entryDistances.data();
+        }
+        expandZone(zoneForNode[item.nodeIndex], item.nodeIndex, item.length, distancesP);
+        
+    }
+    
+    if (pathIsFound == false) {
+        return std::vector<unsigned char>();
+    }
+    
+    // расширение коридора смежными зонами
+    std::set<unsigned int> corridorZones = pathZones;
+    for (unsigned int zoneIndex : pathZones) {
+        for (unsigned int position = portalNodesStarts[zoneIndex]; position < portalNodesStarts[zoneIndex + 1]; position++) {
+            for (const CompactLocationGraph::Edge & edge : compactLocationGraph.edgesOf(portalNodes[position])) {
+                corridorZones.insert(zoneForNode[edge.nodeIndex]);
+            }
+        }
+    }
+    
+    std::vector<unsigned char> nodeIsInCorridor(compactLocationGraph.nodesCount(), 0);
+    for (unsigned int nodeIndex = 0; nodeIndex < compactLocationGraph.nodesCount(); nodeIndex++) {
+        if (corridorZones.find(zoneForNode[nodeIndex]) != corridorZones.end()) {
+            nodeIsInCorridor[nodeIndex] = 1;
+        }
+    }
+    
+    return nodeIsInCorridor;
+    
+}
+
+/// Вычислить длину связи: длину ломаной от центра узла через середину общей границы до центра смежного узла.
+///
+/// \param compactLocationGraph Компактное представление графа локации.
+/// \param nodeIndex Индекс узла.
+/// \param adjacentNodeIndex Индекс смежного узла.
+///
+/// \return Длина связи (единица измерения - мм.).
+CalcNumber LocationZoneHierarchy::calculateEdgeLength(const CompactLocationGraph & compactLocationGraph, unsigned int nodeIndex, unsigned int adjacentNodeIndex) {
+    
+    // середина общей границы - центр пересечения узлов, вырожденного в отрезок
+    CalcNumber borderX = (std::max(compactLocationGraph.left(nodeIndex), compactLocationGraph.left(adjacentNodeIndex)) + std::min(compactLocationGraph.right(nodeIndex), compactLocationGraph.right(adjacentNodeIndex))) / 2;
+    CalcNumber borderY = (std::max(compactLocationGraph.bottom(nodeIndex), compactLocationGraph.bottom(adjacentNodeIndex)) + std::min(compactLocationGraph.top(nodeIndex), compactLocationGraph.top(adjacentNodeIndex))) / 2;
+    
+    CalcNumber length = 0;
+    for (unsigned int index : { nodeIndex, adjacentNodeIndex }) {
+        CalcNumber centerX = (compactLocationGraph.left(index) + compactLocationGraph.right(index)) / 2;
+        CalcNumber centerY = (compactLocationGraph.bottom(index) + compactLocationGraph.top(index)) / 2;
+        length += std::sqrt((centerX - borderX) * (centerX - borderX) + (centerY - borderY) * (centerY - borderY));
+    }
+    
+    return length;
+    
+}
+
+/// Вернуть индекс варианта проходимости, для которого хранятся расстояния внутри зон.
+///
+/// \param diameterIndex Индекс диаметра в таблице проходимости или LocationPassabilityTable::noIndex.
+///
+/// \return Индекс диаметра или diametersCount, если проходимость не учитывается.
+unsigned int LocationZoneHierarchy::variantIndexOf(unsigned int diameterIndex) const {
+    
+    return (diameterIndex == LocationPassabilityTable::noIndex) ? diametersCount : diameterIndex;
+    
+}
+
+/// Вычислить расстояния внутри зоны от узла до всех узлов его зоны (алгоритм Дейкстры по связям, не выходящим из зоны и проходимым для диаметра).
+///
+/// \param compactLocationGraph Компактное представление графа локации.
+/// \param nodeIndex Индекс начального узла.
+/// \param locationPassabilityTable Таблица проходимости связей графа локации.
+/// \param diameterIndex Индекс диаметра в таблице проходимости или LocationPassabilityTable::noIndex, если проходимость не учитывается.
+///
+/// \return Расстояния по локальным индексам узлов зоны (единица измерения - мм.). Недостижимые узлы имеют расстояние, равное std::numeric_limits<CalcNumber>::max().
+std::vector<CalcNumber> LocationZoneHierarchy::calculateLocalDistances(const CompactLocationGraph & compactLocationGraph, unsigned int nodeIndex, const LocationPassabilityTable & locationPassabilityTable, unsigned int diameterIndex) const {
+    
+    unsigned int zoneIndex = zoneForNode[nodeIndex];
+    std::vector<CalcNumber> distances(zoneSizes[zoneIndex], std::numeric_limits<CalcNumber>::max());
+    std::priority_queue<std::pair<CalcNumber, unsigned int>, std::vector<std::pair<CalcNumber, unsigned int>>, std::greater<std::pair<CalcNumber, unsigned int>>> queue;
+    
+    distances[localIndexForNode[nodeIndex]] = 0;
+    queue.push(std::make_pair(0, nodeIndex));
+    
+    while (queue.empty() == false) {
+        std::pair<CalcNumber, unsigned int> item = queue.top();
+        queue.pop();
+        if (item.first > distances[localIndexForNode[item.second]]) {
+            continue;
+        }
+        for (const CompactLocationGraph::Edge & edge : compactLocationGraph.edgesOf(item.second)) {
+            if (zoneForNode[edge.nodeIndex] != zoneIndex) {
+                continue;
+            }
+            if (diameterIndex != LocationPassabilityTable::noIndex && locationPassabilityTable.edgeIsPassable(diameterIndex, compactLocationGraph.edgeIndexOf(edge)) == false) {
+                continue;
+            }
+            CalcNumber newDistance = item.first + calculateEdgeLength(compactLocationGraph, item.second, edge.nodeIndex);
+            if (newDistance < distances[localIndexForNode[edge.nodeIndex]]) {
+                distances[localIndexForNode[edge.nodeIndex]] = newDistance;
+                queue.push(std::make_pair(newDistance, edge.nodeIndex));
+            }
+        }
+    }
+    
+    return distances;
+    
+}
+
+#endif /* LocationZoneHierarchy_hpp */
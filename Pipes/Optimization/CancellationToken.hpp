@@ -0,0 +1,71 @@
+#ifndef CancellationToken_hpp
+#define CancellationToken_hpp
+
+// Подключение стандартных библиотек
+#include <atomic>
+
+/// Признак отмены вычислений. Отмена может быть запрошена из любого потока, вычисления периодически проверяют данный признак и при его установке завершаются досрочно.
+class CancellationToken {
+    
+    // MARK: - Скрытые объекты
+    
+    /// Флаг запроса отмены.
+    std::atomic<bool> isCancelled;
+    
+public:
+    
+    // MARK: - Конструкторы
+    
+    /// Конструктор. Отмена не запрошена.
+    explicit CancellationToken();
+    
+    /// Конструктор копирования. Копирование признака отмены запрещено.
+    CancellationToken(const CancellationToken &) = delete;
+    
+    // MARK: - Открытые методы
+    
+    /// Оператор копирования. Копирование признака отмены запрещено.
+    CancellationToken & operator=(const CancellationToken &) = delete;
+    
+    /// Запросить отмену вычислений.
+    void cancel();
+    
+    /// Сбросить запрос отмены для повторного использования признака.
+    void reset();
+    
+    /// Проверить, запрошена ли отмена вычислений.
+    ///
+    /// \return true, если отмена запрошена, иначе false.
+    bool isCancellationRequested() const;
+    
+};
+
+// MARK: - Реализация
+
+/// Конструктор. Отмена не запрошена.
+CancellationToken::CancellationToken(): isCancelled(false) {}
+
+/// Запросить отмену вычислений.
+void CancellationToken::cancel() {
+    
+    isCancelled = true;
+    
+}
+
+/// Сбросить запрос отмены для повторного использования признака.
+void CancellationToken::reset() {
+    
+    isCancelled = false;
+    
+}
+
+/// Проверить, запрошена ли отмена вычислений.
+///
+/// \return true, если отмена запрошена, иначе false.
+bool CancellationToken::isCancellationRequested() const {
+    
+    return isCancelled;
+    
+}
+
+#endif /* CancellationToken_hpp */
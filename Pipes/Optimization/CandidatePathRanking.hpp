@@ -0,0 +1,194 @@
+#ifndef CandidatePathRanking_hpp
+#define CandidatePathRanking_hpp
+
+// Подключение стандартных библиотек
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+// Подключение внутренних типов
+#include "CalcNumber.hpp"
+#include "Point.hpp"
+#include "LocationGraphNode.hpp"
+#include "PipeTrackNode.hpp"
+
+/// Ранжирование путей-кандидатов подключения источника к трассе по псевдодлине ломаной. Псевдодлина каждого кандидата вычисляется один раз при добавлении. Хранятся только maxKeptCandidatesCount лучших кандидатов (куча с наихудшим из хранимых кандидатов в вершине), кандидаты перемещаются без копирования. При равной псевдодлине лучшим считается кандидат, добавленный раньше.
+class CandidatePathRanking {
+    
+public:
+    
+    // MARK: - Вспомогательные типы
+    
+    /// Путь-кандидат вместе с соответствующей ему ломаной.
+    struct Candidate {
+        
+        /// Путь в графе локации от узла источника до узла трассы или стока.
+        std::vector<const LocationGraphNode*> path;
+        
+        /// Ломаная от точки входа источника до трассы или стока (единица измерения - мм.).
+        std::vector<Point> zigzag;
+        
+        /// Узел трассы для подключения или nullptr, если ломаная заканчивается в стоке.
+        const PipeTrackNode * endPipeTrackNodeP;
+        
+        /// Псевдодлина ломаной (единица измерения - мм.).
+        CalcNumber pseudoLength;
+        
+        /// Порядковый номер кандидата среди добавленных.
+        unsigned long order;
+        
+    };
+    
+private:
+    
+    // MARK: - Скрытые объекты
+    
+    /// Максимальное число хранимых кандидатов.
+    unsigned int maxKeptCandidatesCount;
+    
+    /// Хранимые кандидаты, упорядоченные в виде кучи. В вершине кучи находится наихудший из хранимых кандидатов.
+    std::vector<Candidate> candidatesHeap;
+    
+    /// Число добавленных кандидатов, включая кандидатов без ломаной.
+    unsigned long seenCandidatesCount;
+    
+public:
+    
+    // MARK: - Конструкторы
+    
+    /// Конструктор. Создается пустое ранжирование.
+    ///
+    /// \param maxKeptCandidatesCount Максимальное число хранимых кандидатов. Если равно 0, хранится один кандидат.
+    explicit CandidatePathRanking(unsigned int maxKeptCandidatesCount);
+    
+    // MARK: - Открытые методы
+    
+    /// Добавить кандидата. Кандидат с пустой ломаной (неудачный поиск ломаной) учитывается в числе добавленных, но не хранится.
+    ///
+    /// \param path Путь в графе локации. Перемещается в ранжирование.
+    /// \param zigzag Ломаная, соответствующая пути. Перемещается в ранжирование.
+    /// \param endPipeTrackNodeP Узел трассы для подключения или nullptr, если ломаная заканчивается в стоке.
+    void addCandidate(std::vector<const LocationGraphNode*> && path, std::vector<Point> && zigzag, const PipeTrackNode * endPipeTrackNodeP);
+    
+    /// Извлечь хранимых кандидатов в порядке возрастания псевдодлины ломаной. После вызова ранжирование не содержит кандидатов.
+    ///
+    /// \returns Массив кандидатов.
+    std::vector<Candidate> extractSortedCandidates();
+    
+    /// Вернуть число добавленных кандидатов, включая кандидатов без ломаной.
+    ///
+    /// \returns Число добавленных кандидатов.
+    unsigned long seenCount() const;
+    
+    /// Вернуть число хранимых кандидатов.
+    ///
+    /// \returns Число хранимых кандидатов.
+    unsigned long keptCount() const;
+    
+private:
+    
+    // MARK: - Скрытые методы
+    
+    /// Проверить, что кандидат candidate1 лучше кандидата candidate2.
+    ///
+    /// \param candidate1 Первый кандидат.
+    /// \param candidate2 Второй кандидат.
+    ///
+    /// \returns true, если псевдодлина первого кандидата меньше или при равной псевдодлине он добавлен раньше.
+    static bool isBetter(const Candidate & candidate1, const Candidate & candidate2);
+    
+};
+
+// MARK: - Реализация
+
+/// Конструктор. Создается пустое ранжирование.
+///
+/// \param maxKeptCandidatesCount Максимальное число хранимых кандидатов. Если равно 0, хранится один кандидат.
+CandidatePathRanking::CandidatePathRanking(unsigned int maxKeptCandidatesCount): maxKeptCandidatesCount(std::max(1u, maxKeptCandidatesCount)), seenCandidatesCount(0) {
+    
+    candidatesHeap.reserve(this->maxKeptCandidatesCount + 1);
+    
+}
+
+/// Добавить кандидата. Кандидат с пустой ломаной (неудачный поиск ломаной) учитывается в числе добавленных, но не хранится.
+///
+/// \param path Путь в графе локации. Перемещается в ранжирование.
+/// \param zigzag Ломаная, соответствующая пути. Перемещается в ранжирование.
+/// \param endPipeTrackNodeP Узел трассы для подключения или nullptr, если ломаная заканчивается в стоке.
+void CandidatePathRanking::addCandidate(std::vector<const LocationGraphNode*> && path, std::vector<Point> && zigzag, const PipeTrackNode * endPipeTrackNodeP) {
+    
+    unsigned long order = seenCandidatesCount++;
+    
+    if (zigzag.size() == 0) {
+        return;
+    }
+    
+    CalcNumber pseudoLength = 0;
+    for (int i = 1; i < zigzag.size(); i++) {
+        pseudoLength += (zigzag[i] - zigzag[i - 1]).length();
+    }
+    
+    // кандидат не лучше наихудшего из хранимых при заполненной куче - отбрасывается
+    if (candidatesHeap.size() == maxKeptCandidatesCount && candidatesHeap.front().pseudoLength <= pseudoLength) {
+        return;
+    }
+    
+    candidatesHeap.push_back(Candidate { std::move(path), std::move(zigzag), endPipeTrackNodeP, pseudoLength, order });
+    std::push_heap(candidatesHeap.begin(), candidatesHeap.end(), isBetter);
+    
+    if (candidatesHeap.size() > maxKeptCandidatesCount) {
+        std::pop_heap(candidatesHeap.begin(), candidatesHeap.end(), isBetter);
+        candidatesHeap.pop_back();
+    }
+    
+}
+
+/// Извлечь хранимых кандидатов в порядке возрастания псевдодлины ломаной. После вызова ранжирование не содержит кандидатов.
+///
+/// \returns Массив кандидатов.
+std::vector<CandidatePathRanking::Candidate> CandidatePathRanking::extractSortedCandidates() {
+    
+    std::vector<Candidate> sortedCandidates = std::move(candidatesHeap);
+    candidatesHeap.clear();
+    
+    std::sort_heap(sortedCandidates.begin(), sortedCandidates.end(), isBetter);
+    
+    return sortedCandidates;
+    
+}
+
+/// Вернуть число добавленных кандидатов, включая кандидатов без ломаной.
+///
+/// \returns Число добавленных кандидатов.
+unsigned long CandidatePathRanking::seenCount() const {
+    
+    return seenCandidatesCount;
+    
+}
+
+/// Вернуть число хранимых кандидатов.
+///
+/// \returns Число хранимых кандидатов.
+unsigned long CandidatePathRanking::keptCount() const {
+    
+    return candidatesHeap.size();
+    
+}
+
+/// Проверить, что кандидат candidate1 лучше кандидата candidate2.
+///
+/// \param candidate1 Первый кандидат.
+/// \param candidate2 Второй кандидат.
+///
+/// \returns true, если псевдодлина первого кандидата меньше или при равной псевдодлине он добавлен раньше.
+bool CandidatePathRanking::isBetter(const Candidate & candidate1, const Candidate & candidate2) {
+    
+    if (candidate1.pseudoLength != candidate2.pseudoLength) {
+        return candidate1.pseudoLength < candidate2.pseudoLength;
+    }
+    
+    return candidate1.order < candidate2.order;
+    
+}
+
+#endif /* CandidatePathRanking_hpp */
@@ -5,6 +5,14 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <queue>
+#include <functional>
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <chrono>
+#include <atomic>
+#include <memory>
 
 // Подключение внутренних типов
 #include "Exception.hpp"
@@ -16,10 +24,64 @@
 #include "DecisionMaker.hpp"
 #include "LocationGraph.hpp"
 #include "PipeTrack.hpp"
+#include "OptimalPipeTrackResult.hpp"
+#include "PipeTrackLocationIndex.hpp"
+#include "CompactLocationGraph.hpp"
+#include "LocationPassabilityTable.hpp"
+#include "LocationZoneHierarchy.hpp"
+#include "LocationFeasibilityAnalysis.hpp"
+#include "CandidatePathRanking.hpp"
+#include "PortalFunnel.hpp"
+#include "ThreadPool.hpp"
 
 /// Вычислитель оптимальной трассы системы водоотведения.
 class OptimalPipeTrackFinder {
     
+    // MARK: - Скрытые вспомогательные типы
+    
+    /// Метка узла графа локации при поиске пути по первому наилучшему.
+    struct PathSearchLabel {
+        
+        /// Псевдодлина ломаной от точки входа источника до точки входа в узел (единица измерения - мм.).
+        CalcNumber pseudoLength;
+        
+        /// Точка входа ломаной в узел (единица измерения - мм.).
+        Point lastPoint;
+        
+        /// Указатель на предшествующий узел пути или nullptr для начального узла.
+        const LocationGraphNode * previousNodeP;
+        
+        /// Флаг окончательной обработки узла.
+        bool isSettled;
+        
+    };
+    
+    /// Элемент очереди с приоритетом при поиске пути по первому наилучшему.
+    struct PathSearchQueueItem {
+        
+        /// Псевдодлина ломаной (единица измерения - мм.). Для завершающего элемента - полная псевдодлина ломаной до трассы или стока.
+        CalcNumber pseudoLength;
+        
+        /// Порядковый номер добавления элемента в очередь. Используется для однозначного выбора среди элементов с равной псевдодлиной.
+        unsigned long order;
+        
+        /// Указатель на узел графа локации.
+        const LocationGraphNode * nodeP;
+        
+        /// Флаг завершающего элемента. Завершающий элемент соответствует пути, достроенному до трассы или стока.
+        bool isFinal;
+        
+        /// Проверить, должен ли данный элемент извлекаться из очереди позже элемента anotherItem.
+        ///
+        /// \param anotherItem Другой элемент очереди.
+        ///
+        /// \return true, если данный элемент должен извлекаться позже, иначе false.
+        bool operator>(const PathSearchQueueItem & anotherItem) const {
+            return (pseudoLength != anotherItem.pseudoLength) ? pseudoLength > anotherItem.pseudoLength : order > anotherItem.order;
+        }
+        
+    };
+    
     // MARK: - Скрытые объекты
     
     /// Параметры модели.
@@ -34,9 +96,30 @@ class OptimalPipeTrackFinder {
     /// Граф локации, описывающий области, по которым могут проходить трубы трассы системы водоотведения.
     LocationGraph locationGraph;
     
+    /// Неизменяемое компактное представление графа локации, используемое при поиске путей. Строится после окончания изменения графа локации.
+    CompactLocationGraph compactLocationGraph;
+    
+    /// Таблица проходимости связей графа локации для каждого доступного диаметра. Строится вместе с компактным представлением графа локации.
+    LocationPassabilityTable locationPassabilityTable;
+    
+    /// Иерархия зон графа локации для ограничения поиска путей коридором зон. Строится вместе с компактным представлением графа локации, если ее использование включено в параметрах алгоритма оптимизации.
+    LocationZoneHierarchy locationZoneHierarchy;
+    
     /// Параметры алгоритма оптимизации.
     const OptimizationParameters & optimizationParameters;
     
+    /// Пул потоков для параллельной оценки путей-кандидатов.
+    ThreadPool threadPool;
+    
+    /// Индекс инцидентности узлов строящейся трассы и узлов графа локации. Заполняется по мере добавления узлов в трассу.
+    PipeTrackLocationIndex pipeTrackLocationIndex;
+    
+    /// Момент истечения бюджета времени текущего вычисления.
+    std::chrono::steady_clock::time_point deadline;
+    
+    /// Флаг прерывания текущего вычисления по истечении бюджета времени или по запросу отмены.
+    std::atomic<bool> searchIsInterrupted { false };
+    
     /// Объект, отвечающий за вывод сообщений и ошибок.
     View & view;
     
@@ -60,30 +143,134 @@ public:
     
     // MARK: - Открытые методы
     
-    /// Вычислить оптимальную трассу системы водоотведения. Метод может бросать Exception-исключение.
+    /// Вычислить оптимальную трассу системы водоотведения. Вычисление прерывается по истечении бюджета времени или по запросу отмены, заданным в параметрах алгоритма оптимизации, и в этом случае возвращается лучшая найденная к этому моменту трасса. Метод может бросать Exception-исключение.
     ///
-    /// \returns Найденная оптимальная трасса системы водоотведения.
-    PipeTrack calculateOptimalPipeTrack();
+    /// \returns Найденная оптимальная трасса системы водоотведения и флаг завершенности вычисления.
+    OptimalPipeTrackResult calculateOptimalPipeTrack();
     
 private:
     
     // MARK: - Скрытые методы
     
-    /// Подключить к имеющейся трассе pipeTrack источник waterSource. Если трасса пустая, то источник добавляется к стоку. Метод может бросать Exception-исключение.
+    /// Сформировать порядки подключения источников для поиска наилучшего порядка. Первым идет порядок уменьшения диаметров, в котором источники хранятся в объектах подключения воды. Если число всех перестановок источников не превосходит ordersCount, формируются все перестановки, иначе остальные порядки выбираются случайно (с фиксированным начальным значением генератора) без повторений.
+    ///
+    /// \param ordersCount Максимальное число формируемых порядков.
+    ///
+    /// \returns Массив порядков подключения источников.
+    std::vector<std::vector<const WaterSource*>> generateSourceOrders(unsigned int ordersCount);
+    
+    /// Найти среди порядков подключения источников, отличных от порядка уменьшения диаметров, порядок с трассой стоимости меньше currentCost. Трассы для различных порядков строятся параллельно и независимо друг от друга в неинтерактивном режиме, пока вычисление не прервано. Порядки, для которых трасса не построена, не рассматриваются. При равной стоимости выбирается порядок, сформированный раньше.
+    ///
+    /// \param currentCost Стоимость имеющейся трассы (единица измерения - руб.).
+    /// \param evaluatedOrdersCount Число порядков, для которых трасса построена.
+    /// \param cheaperSourceOrder Порядок подключения источников, для которого построена возвращаемая трасса.
+    ///
+    /// \returns Указатель на трассу наименьшей стоимости или nullptr, если трасса стоимости меньше currentCost не найдена.
+    std::unique_ptr<PipeTrack> findCheaperPipeTrackForSourceOrders(CalcNumber currentCost, unsigned int & evaluatedOrdersCount, std::vector<const WaterSource*> & cheaperSourceOrder);
+    
+    /// Подключить к трассе pipeTrack источники в порядке sourceOrder. Подключение прекращается, если вычисление прервано. Метод может бросать Exception-исключение.
+    ///
+    /// \param pipeTrack Текущая трасса.
+    /// \param pipeTrackLocationIndex Индекс инцидентности узлов трассы pipeTrack и узлов графа локации.
+    /// \param sourceOrder Порядок подключения источников.
+    /// \param isInteractive Флаг интерактивного построения, при котором разрешены обращение к объекту, отвечающему за принятие решений, и вывод сообщений.
+    ///
+    /// \returns true, если подключены все источники, иначе false.
+    bool connectSourcesInOrder(PipeTrack & pipeTrack, PipeTrackLocationIndex & pipeTrackLocationIndex, const std::vector<const WaterSource*> & sourceOrder, bool isInteractive);
+    
+    /// Подключить к имеющейся трассе pipeTrack источник waterSource. Если трасса пустая, то источник добавляется к стоку. Добавленные в трассу узлы заносятся в индекс инцидентности. Метод может бросать Exception-исключение.
+    ///
+    /// \param pipeTrack Текущая трасса.
+    /// \param pipeTrackLocationIndex Индекс инцидентности узлов трассы pipeTrack и узлов графа локации.
+    /// \param waterSource Подключаемой к трассе источник.
+    /// \param isInteractive Флаг интерактивного построения, при котором разрешены обращение к объекту, отвечающему за принятие решений, и вывод сообщений. Если равен false, выбирается путь с ломаной наименьшей псевдодлины.
+    void connectSourceToPipeTrack(PipeTrack & pipeTrack, PipeTrackLocationIndex & pipeTrackLocationIndex, const WaterSource & waterSource, bool isInteractive);
+    
+    /// Подключить к пустой трассе pipeTrack все источники приближенным построением дерева Штейнера (эвристика кратчайших путей Такахаши-Мацуямы). Дерево растет от стока: на каждом шаге для всех неподключенных источников параллельно находятся подключения к текущей трассе, и добавляется подключение наименьшей псевдодлины. Подключение прекращается, если вычисление прервано. Метод может бросать Exception-исключение.
+    ///
+    /// \param pipeTrack Пустая трасса.
+    /// \param pipeTrackLocationIndex Индекс инцидентности узлов трассы pipeTrack и узлов графа локации.
+    ///
+    /// \returns true, если подключены все источники, иначе false.
+    bool connectSourcesBySteinerTreeHeuristic(PipeTrack & pipeTrack, PipeTrackLocationIndex & pipeTrackLocationIndex);
+    
+    /// Найти подключение источника waterSource к имеющейся трассе pipeTrack (путь в графе локации и ломаную) без изменения трассы. Если трасса пустая, то находится подключение к стоку. Метод может бросать Exception-исключение.
+    ///
+    /// \param pipeTrack Текущая трасса.
+    /// \param pipeTrackLocationIndex Индекс инцидентности узлов трассы pipeTrack и узлов графа локации.
+    /// \param waterSource Подключаемой к трассе источник.
+    /// \param isInteractive Флаг интерактивного построения, при котором разрешены обращение к объекту, отвечающему за принятие решений, и вывод сообщений. Если равен false, выбирается путь с ломаной наименьшей псевдодлины.
+    ///
+    /// \returns Найденное подключение.
+    CandidatePathRanking::Candidate findSourceConnection(const PipeTrack & pipeTrack, const PipeTrackLocationIndex & pipeTrackLocationIndex, const WaterSource & waterSource, bool isInteractive);
+    
+    /// Добавить к трассе pipeTrack трубы подключения источника waterSource в соответствии с ломаной найденного подключения. Добавленные в трассу узлы заносятся в индекс инцидентности.
     ///
     /// \param pipeTrack Текущая трасса.
+    /// \param pipeTrackLocationIndex Индекс инцидентности узлов трассы pipeTrack и узлов графа локации.
     /// \param waterSource Подключаемой к трассе источник.
-    void connectSourceToPipeTrack(PipeTrack & pipeTrack, const WaterSource & waterSource);
+    /// \param connection Подключение, найденное для данного источника и данной трассы.
+    void addSourceConnectionToPipeTrack(PipeTrack & pipeTrack, PipeTrackLocationIndex & pipeTrackLocationIndex, const WaterSource & waterSource, const CandidatePathRanking::Candidate & connection);
     
-    /// Достроить текущий строящийся путь в графе локации до трассы. Если путь не однозначен, построить всевозможные варианты. Если трасса пустая, путь строится до стока.
+    /// Достроить текущий строящийся путь в графе локации до трассы. Если путь не однозначен, построить всевозможные варианты (метод ветвей и границ). Вместе с путем строятся порталы между его соседними узлами. Достроенный путь оценивается длиной ломаной, спрямленной алгоритмом воронки, - той же псевдодлиной, по которой ранжируются найденные пути. Ветвь отбрасывается, если проход между узлами недостаточен для прокладки трубы или если нижняя оценка спрямленной ломаной любого продолжения ветви превосходит псевдодлину лучшего из достроенных путей. Если трасса пустая, путь строится до стока.
     ///
     /// \param builtPaths Массив уже построенных путей. В данный массив сохраняются достроенные пути.
     /// \param buildingPath Текущий строящийся путь. Последний элемент данного массива - последний пройденный узел, от которого необходимо продолжить строительство. Массив должен быть непустым.
+    /// \param startPoint Точка входа подключаемого источника, с которой начинается ломаная (единица измерения - мм.).
+    /// \param buildingZigzagLastPoint Точка входа жадно построенной ломаной текущего строящегося пути в последний пройденный узел. По ней выбирается конечная точка ломаной (единица измерения - мм.).
+    /// \param buildingPortals Порталы между соседними узлами текущего строящегося пути.
+    /// \param buildingLengthLowerBound Нижняя оценка длины ломаной от точки startPoint до последнего портала текущего строящегося пути или 0, если порталов нет (единица измерения - мм.).
     /// \param passedNodes Множество уже пройденных узлов в текущем пути.
+    /// \param bestPseudoLength Псевдодлина спрямленной ломаной лучшего из достроенных путей (единица измерения - мм.).
+    /// \param externalDiameterHalfed Половина внешнего диаметра подключаемого источника (единица измерения - мм.).
+    /// \param diameterIndex Индекс диаметра подключаемого источника в таблице проходимости или LocationPassabilityTable::noIndex, если таблица для диаметра не построена.
+    /// \param pipeTrack Трасса системы водоотведения.
     /// \param pipeTrackNodesForLocationNode Словарь, в котором для каждого узла графа локации содержится массив содержащихся в нем узлов трассы.
-    void findAllPathsFromSourceToPipeTrack(std::vector<std::vector<const LocationGraphNode*>> & builtPaths, std::vector<const LocationGraphNode*> & buildingPath, std::set<const LocationGraphNode*> & passedNodes, std::map<const LocationGraphNode*, std::vector<const PipeTrackNode*>> & pipeTrackNodesForLocationNode);
+    void findAllPathsFromSourceToPipeTrack(std::vector<std::vector<const LocationGraphNode*>> & builtPaths, std::vector<const LocationGraphNode*> & buildingPath, const Point & startPoint, const Point & buildingZigzagLastPoint, std::vector<std::pair<Point, Point>> & buildingPortals, CalcNumber buildingLengthLowerBound, std::set<const LocationGraphNode*> & passedNodes, CalcNumber & bestPseudoLength, CalcNumber externalDiameterHalfed, unsigned int diameterIndex, const PipeTrack & pipeTrack, const std::map<const LocationGraphNode*, std::vector<const PipeTrackNode*>> & pipeTrackNodesForLocationNode);
     
-    /// Найти для пути pathFromSourceToPipeTrack ломаную минимальной псевдодлины, соединяющую точку входа подключаемого источника waterSource с трассой pipeTrack. При поиске учитывается внешний диаметр источника. Если трасса пустая, то источник соединяется со стоком.
+    /// Вычислить нижнюю оценку псевдодлины ломаной от точки point до трассы или стока. Оценкой является расстояние в плоскости XY от точки до ближайшей из точек центральных отрезков прямых и фановых труб трассы и центра стока. Ближайшая точка трассы ищется по пространственному индексу трассы.
+    ///
+    /// \param point Точка (единица измерения - мм.).
+    /// \param pipeTrack Трасса системы водоотведения.
+    ///
+    /// \return Нижняя оценка псевдодлины ломаной (единица измерения - мм.).
+    CalcNumber calculatePseudoLengthLowerBound(const Point & point, const PipeTrack & pipeTrack);
+    
+    /// Найти путь в графе локации от узла, содержащего источник, до трассы поиском по первому наилучшему (алгоритм Дейкстры). Стоимостью пути является псевдодлина соответствующей ему ломаной. Проходы между узлами, ширина которых меньше внешнего диаметра источника, считаются непроходимыми. Если трасса пустая, путь строится до стока. При использовании иерархии зон поиск сначала ограничивается коридором зон, а при неудаче повторяется по всему графу.
+    ///
+    /// \param sourceLocationNodeP Указатель на узел графа локации, содержащий подключаемый источник.
+    /// \param waterSource Подключаемый источник.
+    /// \param pipeTrackNodesForLocationNode Словарь, в котором для каждого узла графа локации содержится массив содержащихся в нем узлов трассы.
+    ///
+    /// \return Найденный путь в виде узлов графа локации. Если путь не найден, возвращается пустой массив.
+    std::vector<const LocationGraphNode*> findBestFirstPathFromSourceToPipeTrack(const LocationGraphNode * sourceLocationNodeP, const WaterSource & waterSource, const std::map<const LocationGraphNode*, std::vector<const PipeTrackNode*>> & pipeTrackNodesForLocationNode);
+    
+    /// Продолжить начальную часть пути startPath в графе локации до трассы поиском по первому наилучшему (алгоритм Дейкстры). Стоимостью пути является псевдодлина соответствующей ему ломаной. Поиск приближенный: метка узла хранит одну точку входа ломаной, хотя продолжение ломаной зависит от нее, поэтому найденный путь может быть длиннее кратчайшего. Узлы начальной части пути, кроме последнего, в продолжение пути не входят. Проходы между узлами, ширина которых меньше внешнего диаметра источника, считаются непроходимыми. Если трасса пустая, путь строится до стока.
+    ///
+    /// \param startPath Начальная часть пути от узла, содержащего источник. Последний элемент массива - узел, с которого продолжается поиск. Массив должен быть непустым.
+    /// \param startPoint Точка входа ломаной в последний узел начальной части пути (единица измерения - мм.).
+    /// \param startPseudoLength Псевдодлина ломаной начальной части пути (единица измерения - мм.).
+    /// \param blockedEdges Запрещенные для прохода ребра графа локации в виде пар (узел, из которого выполняется переход; узел, в который выполняется переход).
+    /// \param startTerminationIsBlocked Флаг запрета завершения пути в последнем узле начальной части пути.
+    /// \param allowedNodes Флаги узлов, в которые разрешено продолжать путь, по индексам компактного представления графа локации, или пустой массив, если разрешены все узлы.
+    /// \param waterSource Подключаемый источник.
+    /// \param pipeTrackNodesForLocationNode Словарь, в котором для каждого узла графа локации содержится массив содержащихся в нем узлов трассы.
+    /// \param pseudoLength Псевдодлина ломаной найденного пути (единица измерения - мм.).
+    ///
+    /// \return Найденный путь целиком (начальная часть и ее продолжение) в виде узлов графа локации. Если путь не найден, возвращается пустой массив.
+    std::vector<const LocationGraphNode*> findBestFirstPathContinuationToPipeTrack(const std::vector<const LocationGraphNode*> & startPath, const Point & startPoint, CalcNumber startPseudoLength, const std::set<std::pair<const LocationGraphNode*, const LocationGraphNode*>> & blockedEdges, bool startTerminationIsBlocked, const std::vector<unsigned char> & allowedNodes, const WaterSource & waterSource, const std::map<const LocationGraphNode*, std::vector<const PipeTrackNode*>> & pipeTrackNodesForLocationNode, CalcNumber & pseudoLength);
+    
+    /// Найти не более pathsCount путей в графе локации от узла, содержащего источник, до трассы в порядке возрастания псевдодлины соответствующих им ломаных (алгоритм Йена). Пути не содержат повторяющихся узлов. Если трасса пустая, пути строятся до стока.
+    ///
+    /// \param sourceLocationNodeP Указатель на узел графа локации, содержащий подключаемый источник.
+    /// \param waterSource Подключаемый источник.
+    /// \param pipeTrackNodesForLocationNode Словарь, в котором для каждого узла графа локации содержится массив содержащихся в нем узлов трассы.
+    /// \param pathsCount Максимальное число находимых путей.
+    ///
+    /// \return Найденные пути в порядке возрастания псевдодлины ломаных.
+    std::vector<std::vector<const LocationGraphNode*>> findKShortestPathsFromSourceToPipeTrack(const LocationGraphNode * sourceLocationNodeP, const WaterSource & waterSource, const std::map<const LocationGraphNode*, std::vector<const PipeTrackNode*>> & pipeTrackNodesForLocationNode, unsigned int pathsCount);
+    
+    /// Найти для пути pathFromSourceToPipeTrack ломаную минимальной псевдодлины, соединяющую точку входа подключаемого источника waterSource с трассой pipeTrack. При поиске учитывается внешний диаметр источника. Если трасса пустая, то источник соединяется со стоком. Конечная точка ломаной выбирается по жадно построенной ломаной, после чего ломаная спрямляется алгоритмом воронки через порталы между соседними узлами пути.
     ///
     /// \param pathFromSourceToPipeTrack Путь от источника до трассы в виде узлов графа локации.
     /// \param pipeTrack Трасса системы водоотведения.
@@ -91,7 +278,52 @@ private:
     /// \param pipeTrackNodesForLocationNode Словарь, в котором для каждого узла графа локации содержится массив содержащихся в нем узлов трассы.
     ///
     /// \return Пара типа (ломаная, указатель на соединяемый узел трассы). Ломаная - ломаная минимальной псевдодлины, проходящая через узлы пути pathFromSourceToPipeTrack, соединяющая источник waterSource с трассой pipeTrack. Если последней точкой ломаной является центр стока, то указатель на соединяемый узел трассы равен nullptr. Если поиск неуспешен, возвращается пустая ломаная.
-    std::pair<std::vector<Point>, const PipeTrackNode*> findMinPseudoLengthZigzagFromSourceToPipeTrackAndPipeTrackNodeP(const std::vector<const LocationGraphNode*> & pathFromSourceToPipeTrack, const PipeTrack & pipeTrack, const WaterSource & waterSource, std::map<const LocationGraphNode*, std::vector<const PipeTrackNode*>> & pipeTrackNodesForLocationNode);
+    std::pair<std::vector<Point>, const PipeTrackNode*> findMinPseudoLengthZigzagFromSourceToPipeTrackAndPipeTrackNodeP(const std::vector<const LocationGraphNode*> & pathFromSourceToPipeTrack, const PipeTrack & pipeTrack, const WaterSource & waterSource, const std::map<const LocationGraphNode*, std::vector<const PipeTrackNode*>> & pipeTrackNodesForLocationNode);
+    
+    /// Найти точку входа подключаемого источника waterSource в содержащий его узел графа локации.
+    ///
+    /// \param sourceLocationNodeP Указатель на узел графа локации, содержащий источник.
+    /// \param waterSource Подключаемый источник.
+    ///
+    /// \return Точка входа источника в узел (единица измерения - мм.).
+    Point findSourceConnectionPoint(const LocationGraphNode * sourceLocationNodeP, const WaterSource & waterSource);
+    
+    /// Проверить, прервано ли текущее вычисление: истек бюджет времени или запрошена отмена. При обнаружении прерывания устанавливается флаг searchIsInterrupted.
+    ///
+    /// \return true, если вычисление прервано, иначе false.
+    bool isInterrupted();
+    
+    /// Найти портал между текущим узлом пути currentNodeP и следующим узлом пути nextNodeP - отрезок, через который должна пройти ось трубы при переходе в следующий узел. Портал лежит в следующем узле на расстоянии половины внешнего диаметра трубы от общей границы узлов и сужен на половину внешнего диаметра с каждой стороны.
+    ///
+    /// \param currentNodeP Указатель на текущий узел пути.
+    /// \param nextNodeP Указатель на следующий узел пути. Должен быть смежным с текущим узлом.
+    /// \param externalDiameterHalfed Половина внешнего диаметра трубы (единица измерения - мм.).
+    /// \param portal Найденный портал в виде пары (левый конец, правый конец) относительно направления перехода из текущего узла в следующий (единица измерения - мм.).
+    ///
+    /// \return true, если проход между узлами достаточен для прокладки трубы, иначе false.
+    bool calculatePortal(const LocationGraphNode * currentNodeP, const LocationGraphNode * nextNodeP, CalcNumber externalDiameterHalfed, std::pair<Point, Point> & portal);
+    
+    /// Найти очередную точку ломаной на границе между текущим узлом пути currentNodeP и следующим узлом пути nextNodeP. Точка находится как ближайшая к последней добавленной в ломаную точке с учетом внешнего диаметра трубы.
+    ///
+    /// \param currentNodeP Указатель на текущий узел пути.
+    /// \param nextNodeP Указатель на следующий узел пути. Должен быть смежным с текущим узлом.
+    /// \param lastAddedPoint Последняя добавленная в ломаную точка (единица измерения - мм.).
+    /// \param externalDiameterHalfed Половина внешнего диаметра трубы (единица измерения - мм.).
+    /// \param newPoint Найденная точка (единица измерения - мм.).
+    ///
+    /// \return true, если проход между узлами достаточен для прокладки трубы, иначе false.
+    bool calculateNextZigzagPoint(const LocationGraphNode * currentNodeP, const LocationGraphNode * nextNodeP, const Point & lastAddedPoint, CalcNumber externalDiameterHalfed, Point & newPoint);
+    
+    /// Найти конечную точку ломаной в последнем узле пути endNodeP. Конечной точкой является ближайшая к последней добавленной в ломаную точке точка центрального отрезка прямой или фановой трубы трассы, проходящей через узел, или центр стока.
+    ///
+    /// \param endNodeP Указатель на последний узел пути.
+    /// \param lastAddedPoint Последняя добавленная в ломаную точка (единица измерения - мм.).
+    /// \param pipeTrackNodesForLocationNode Словарь, в котором для каждого узла графа локации содержится массив содержащихся в нем узлов трассы.
+    /// \param endPoint Найденная конечная точка (единица измерения - мм.).
+    /// \param endPipeTrackNodeP Указатель на соединяемый узел трассы или nullptr, если конечной точкой является центр стока.
+    ///
+    /// \return true, если конечная точка найдена, иначе false.
+    bool findZigzagEndPoint(const LocationGraphNode * endNodeP, const Point & lastAddedPoint, const std::map<const LocationGraphNode*, std::vector<const PipeTrackNode*>> & pipeTrackNodesForLocationNode, Point & endPoint, const PipeTrackNode * & endPipeTrackNodeP);
     
 };
 
@@ -106,12 +338,19 @@ private:
 /// \param optimizationParameters Параметры алгоритма оптимизации.
 /// \param view Объект, отвечающий за вывод сообщений и ошибок.
 /// \param decisionMaker Объект, отвечающий за принятие неоднозначных решений при нахождении оптимальной трассы системы водоотведения.
-OptimalPipeTrackFinder::OptimalPipeTrackFinder(const Config & config, const WaterConnectionObjects & waterConnectionObjects, const PipeObjectsBag & pipeObjectsBag, LocationGraph locationGraph, const OptimizationParameters & optimizationParameters, View & view, DecisionMaker & decisionMaker): config(config), waterConnectionObjects(waterConnectionObjects), pipeObjectsBag(pipeObjectsBag), locationGraph(locationGraph), optimizationParameters(optimizationParameters), view(view), decisionMaker(decisionMaker) {}
+OptimalPipeTrackFinder::OptimalPipeTrackFinder(const Config & config, const WaterConnectionObjects & waterConnectionObjects, const PipeObjectsBag & pipeObjectsBag, LocationGraph locationGraph, const OptimizationParameters & optimizationParameters, View & view, DecisionMaker & decisionMaker): config(config), waterConnectionObjects(waterConnectionObjects), pipeObjectsBag(pipeObjectsBag), locationGraph(locationGraph), optimizationParameters(optimizationParameters), threadPool(optimizationParameters.threadsCount), pipeTrackLocationIndex(&this->locationGraph), view(view), decisionMaker(decisionMaker) {}
     
-/// Вычислить оптимальную трассу системы водоотведения. Метод может бросать Exception-исключение.
+/// Вычислить оптимальную трассу системы водоотведения. Вычисление прерывается по истечении бюджета времени или по запросу отмены, заданным в параметрах алгоритма оптимизации, и в этом случае возвращается лучшая найденная к этому моменту трасса. Метод может бросать Exception-исключение.
 ///
-/// \returns Найденная оптимальная трасса системы водоотведения.
-PipeTrack OptimalPipeTrackFinder::calculateOptimalPipeTrack() {
+/// \returns Найденная оптимальная трасса системы водоотведения и флаг завершенности вычисления.
+OptimalPipeTrackResult OptimalPipeTrackFinder::calculateOptimalPipeTrack() {
+    
+    searchIsInterrupted = false;
+    if (optimizationParameters.timeBudgetMilliseconds > 0) {
+        deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(optimizationParameters.timeBudgetMilliseconds);
+    } else {
+        deadline = std::chrono::steady_clock::time_point::max();
+    }
     
     view.printMessage("\nЗапуск алгоритма вычисления оптимальной трассы системы водоотведения.");
     
@@ -122,55 +361,307 @@ PipeTrack OptimalPipeTrackFinder::calculateOptimalPipeTrack() {
     
     // Шаг 2. Разделение узлов графа локации, содержащих точки входа нескольких источников.
     view.printMessage("\nШаг 2. Разделение узлов графа локации, содержащих точки входа нескольких источников.");
-    locationGraph.separateWaterSources();
+    LocationGraph::SeparationStatistics separationStatistics = locationGraph.separateWaterSources();
+    view.printMessage("Разделено узлов: " + std::to_string(separationStatistics.separationsCount) + ", проверено узлов: " + std::to_string(separationStatistics.checkedNodesCount) + ", затрачено времени: " + std::to_string(separationStatistics.durationMilliseconds) + " мс.");
     view.printMessage("Шаг 2 завершен.");
     
-    // Шаг 3. Построение оптимальной трассы, в ходе которого источники последовательно подключаются к стоку в порядке уменьшения их диаметров.
-    view.printMessage("\nШаг 3. Построение оптимальной трассы, в ходе которого источники последовательно подключаются к стоку в порядке уменьшения их диаметров.");
-    PipeTrack pipeTrack { &view };
-    for (const WaterSource & waterSource : waterConnectionObjects.waterSources) {
-        view.printMessage("Подключение источника \"" + waterSource.name() + "\".");
-        connectSourceToPipeTrack(pipeTrack, waterSource);
-        view.printMessage("Источник \"" + waterSource.name() + "\" подключен.");
+    // Граф локации больше не изменяется, поэтому индекс инцидентности заполняется его окончательными узлами, а сам граф переводится в компактное представление.
+    pipeTrackLocationIndex.reset();
+    compactLocationGraph = CompactLocationGraph(locationGraph);
+    locationPassabilityTable = LocationPassabilityTable(compactLocationGraph, pipeObjectsBag, locationGraph.waterDestinationNodeP);
+    
+    // Предварительный анализ выполнимости: если сток недостижим из какого-либо источника, вычисление прекращается до поиска путей с перечислением всех найденных проблем.
+    LocationFeasibilityAnalysis feasibilityAnalysis { compactLocationGraph, locationPassabilityTable, locationGraph.waterDestinationNodeP };
+    view.printMessage("Анализ выполнимости: компонент связности графа локации - " + std::to_string(feasibilityAnalysis.componentsCount) + ", узлов-сочленений - " + std::to_string(feasibilityAnalysis.articulationNodePs.size()) + ", найдено проблем - " + std::to_string(feasibilityAnalysis.problems.size()) + ", затрачено времени: " + std::to_string(feasibilityAnalysis.durationMilliseconds) + " мс.");
+    feasibilityAnalysis.throwIfNotFeasible();
+    
+    if (optimizationParameters.zoneHierarchyIsUsed) {
+        locationZoneHierarchy = LocationZoneHierarchy(compactLocationGraph, locationPassabilityTable, optimizationParameters.zoneSize);
+        view.printMessage("Построена иерархия графа локации: зон - " + std::to_string(locationZoneHierarchy.getZonesCount()) + ", портальных узлов - " + std::to_string(locationZoneHierarchy.getPortalNodesCount()) + ".");
+    }
+    
+    // Шаг 3. Построение оптимальной трассы. В режиме последовательного построения источники сначала подключаются к стоку в порядке уменьшения их диаметров, затем, пока не исчерпан бюджет времени, рассматриваются другие порядки подключения. В режиме дерева Штейнера на каждом шаге подключается источник с кратчайшим подключением к трассе.
+    OptimalPipeTrackResult result { &view, optimizationParameters.locationIndexCellSize };
+    bool allSourcesAreConnected = false;
+    if (optimizationParameters.engineMode == OptimizationParameters::steinerTreeEngine) {
+        view.printMessage("\nШаг 3. Построение оптимальной трассы как приближенного дерева Штейнера, в ходе которого на каждом шаге к трассе подключается источник с кратчайшим подключением.");
+        allSourcesAreConnected = connectSourcesBySteinerTreeHeuristic(result.pipeTrack, pipeTrackLocationIndex);
+    }
+    else {
+        view.printMessage("\nШаг 3. Построение оптимальной трассы, в ходе которого источники последовательно подключаются к стоку в наилучшем из рассмотренных порядков.");
+        std::vector<const WaterSource*> sourceOrder;
+        for (const WaterSource & waterSource : waterConnectionObjects.waterSources) {
+            sourceOrder.push_back(&waterSource);
+        }
+        allSourcesAreConnected = connectSourcesInOrder(result.pipeTrack, pipeTrackLocationIndex, sourceOrder, true);
+        if (allSourcesAreConnected && optimizationParameters.sourceOrdersCount > 1 && sourceOrder.size() > 1 && isInterrupted() == false) {
+            unsigned int evaluatedOrdersCount = 0;
+            std::vector<const WaterSource*> cheaperSourceOrder;
+            std::unique_ptr<PipeTrack> cheaperPipeTrackP = findCheaperPipeTrackForSourceOrders(result.pipeTrack.calculateCost(), evaluatedOrdersCount, cheaperSourceOrder);
+            view.printMessage("Число порядков подключения источников, для которых построена трасса: " + std::to_string(evaluatedOrdersCount + 1) + ".");
+            if (cheaperPipeTrackP != nullptr) {
+                view.printMessage("Выбрана трасса для порядка подключения источников с меньшей стоимостью.");
+                bool cheaperPipeTrackIsRebuilt = false;
+                if (optimizationParameters.pathSearchMode == OptimizationParameters::kShortestPathsSearch) {
+                    // трасса для найденного порядка построена без обращения к объекту, отвечающему за принятие решений, поэтому она строится заново в интерактивном режиме; если построение прервано, используется трасса, построенная в неинтерактивном режиме
+                    view.printMessage("Трасса для выбранного порядка строится заново с принятием неоднозначных решений.");
+                    PipeTrack rebuiltPipeTrack { &view, optimizationParameters.locationIndexCellSize };
+                    pipeTrackLocationIndex.reset();
+                    if (connectSourcesInOrder(rebuiltPipeTrack, pipeTrackLocationIndex, cheaperSourceOrder, true)) {
+                        result.pipeTrack = rebuiltPipeTrack;
+                        cheaperPipeTrackIsRebuilt = true;
+                    }
+                }
+                if (cheaperPipeTrackIsRebuilt == false) {
+                    // индекс инцидентности не соответствует выбранной трассе и далее не используется
+                    result.pipeTrack = *cheaperPipeTrackP;
+                }
+            }
+        }
+    }
+    result.isCompleted = allSourcesAreConnected && searchIsInterrupted == false;
+    if (searchIsInterrupted) {
+        view.printMessage("Вычисление прервано по истечении бюджета времени или по запросу отмены. Используется лучшая найденная трасса" + std::string(allSourcesAreConnected ? "." : ", к которой подключены не все источники."));
     }
     view.printMessage("Шаг 3 завершен.");
     
     // Шаг 4. Вычисление стоимости трассы.
     view.printMessage("\nШаг 4. Вычисление стоимости трассы.");
-    CalcNumber cost = pipeTrack.calculateCost();
+    CalcNumber cost = result.pipeTrack.calculateCost();
     view.printMessage("Стоимость трассы равна " + std::to_string(static_cast<int>(cost)) + " руб.");
     view.printMessage("Шаг 4 завершен.");
     
-    return pipeTrack;
+    return result;
+    
+}
+
+/// Сформировать порядки подключения источников для поиска наилучшего порядка. Первым идет порядок уменьшения диаметров, в котором источники хранятся в объектах подключения воды. Если число всех перестановок источников не превосходит ordersCount, формируются все перестановки, иначе остальные порядки выбираются случайно (с фиксированным начальным значением генератора) без повторений.
+///
+/// \param ordersCount Максимальное число формируемых порядков.
+///
+/// \returns Массив порядков подключения источников.
+std::vector<std::vector<const WaterSource*>> OptimalPipeTrackFinder::generateSourceOrders(unsigned int ordersCount) {
+    
+    const std::vector<WaterSource> & waterSources = waterConnectionObjects.waterSources;
+    
+    // Вычисление числа всех перестановок с ограничением сверху
+    unsigned long permutationsCount = 1;
+    for (unsigned long i = 2; i <= waterSources.size() && permutationsCount <= ordersCount; i++) {
+        permutationsCount *= i;
+    }
+    
+    std::vector<unsigned int> indexes;
+    for (unsigned int i = 0; i < waterSources.size(); i++) {
+        indexes.push_back(i);
+    }
+    
+    std::vector<std::vector<unsigned int>> indexOrders;
+    if (permutationsCount <= ordersCount) {
+        // Перебор всех перестановок, начиная с тождественной
+        do {
+            indexOrders.push_back(indexes);
+        } while (std::next_permutation(indexes.begin(), indexes.end()));
+    }
+    else {
+        std::set<std::vector<unsigned int>> knownIndexOrders { indexes };
+        indexOrders.push_back(indexes);
+        std::mt19937 randomGenerator(1);
+        while (indexOrders.size() < ordersCount) {
+            std::shuffle(indexes.begin(), indexes.end(), randomGenerator);
+            if (knownIndexOrders.insert(indexes).second) {
+                indexOrders.push_back(indexes);
+            }
+        }
+    }
+    
+    std::vector<std::vector<const WaterSource*>> sourceOrders;
+    for (const std::vector<unsigned int> & indexOrder : indexOrders) {
+        std::vector<const WaterSource*> sourceOrder;
+        for (unsigned int index : indexOrder) {
+            sourceOrder.push_back(&waterSources[index]);
+        }
+        sourceOrders.push_back(sourceOrder);
+    }
+    
+    return sourceOrders;
+    
+}
+
+/// Найти среди порядков подключения источников, отличных от порядка уменьшения диаметров, порядок с трассой стоимости меньше currentCost. Трассы для различных порядков строятся параллельно и независимо друг от друга в неинтерактивном режиме, пока вычисление не прервано. Порядки, для которых трасса не построена, не рассматриваются. При равной стоимости выбирается порядок, сформированный раньше.
+///
+/// \param currentCost Стоимость имеющейся трассы (единица измерения - руб.).
+/// \param evaluatedOrdersCount Число порядков, для которых трасса построена.
+/// \param cheaperSourceOrder Порядок подключения источников, для которого построена возвращаемая трасса.
+///
+/// \returns Указатель на трассу наименьшей стоимости или nullptr, если трасса стоимости меньше currentCost не найдена.
+std::unique_ptr<PipeTrack> OptimalPipeTrackFinder::findCheaperPipeTrackForSourceOrders(CalcNumber currentCost, unsigned int & evaluatedOrdersCount, std::vector<const WaterSource*> & cheaperSourceOrder) {
+    
+    std::vector<std::vector<const WaterSource*>> sourceOrders = generateSourceOrders(std::max(1u, optimizationParameters.sourceOrdersCount));
+    
+    // Стоимость и трасса для каждого порядка, кроме первого. Отрицательная стоимость означает, что трасса не построена. Трасса сохраняется, только если она дешевле имеющейся.
+    std::vector<CalcNumber> costForSourceOrders(sourceOrders.size(), -1);
+    std::vector<std::unique_ptr<PipeTrack>> pipeTrackPsForSourceOrders(sourceOrders.size());
+    threadPool.runForEachIndex(static_cast<unsigned int>(sourceOrders.size()) - 1, [&](unsigned int taskIndex) {
+        unsigned int orderIndex = taskIndex + 1;
+        if (isInterrupted()) {
+            return;
+        }
+        std::unique_ptr<PipeTrack> pipeTrackP(new PipeTrack(&view, optimizationParameters.locationIndexCellSize));
+        PipeTrackLocationIndex orderPipeTrackLocationIndex { &locationGraph };
+        try {
+            if (connectSourcesInOrder(*pipeTrackP, orderPipeTrackLocationIndex, sourceOrders[orderIndex], false)) {
+                costForSourceOrders[orderIndex] = pipeTrackP->calculateCost();
+                if (costForSourceOrders[orderIndex] < currentCost) {
+                    pipeTrackPsForSourceOrders[orderIndex] = std::move(pipeTrackP);
+                }
+            }
+        }
+        catch (const Exception &) {}
+    });
+    
+    evaluatedOrdersCount = 0;
+    int bestOrderIndex = -1;
+    for (int i = 1; i < sourceOrders.size(); i++) {
+        if (costForSourceOrders[i] < 0) {
+            continue;
+        }
+        evaluatedOrdersCount++;
+        if (pipeTrackPsForSourceOrders[i] != nullptr && (bestOrderIndex == -1 || costForSourceOrders[i] < costForSourceOrders[bestOrderIndex])) {
+            bestOrderIndex = i;
+        }
+    }
+    
+    if (bestOrderIndex == -1) {
+        return nullptr;
+    }
+    cheaperSourceOrder = sourceOrders[bestOrderIndex];
+    return std::move(pipeTrackPsForSourceOrders[bestOrderIndex]);
     
 }
 
-/// Подключить к имеющейся трассе pipeTrack источник waterSource. Если трасса пустая, то источник добавляется к стоку. Метод может бросать Exception-исключение.
+/// Подключить к трассе pipeTrack источники в порядке sourceOrder. Подключение прекращается, если вычисление прервано. Метод может бросать Exception-исключение.
 ///
 /// \param pipeTrack Текущая трасса.
+/// \param pipeTrackLocationIndex Индекс инцидентности узлов трассы pipeTrack и узлов графа локации.
+/// \param sourceOrder Порядок подключения источников.
+/// \param isInteractive Флаг интерактивного построения, при котором разрешены обращение к объекту, отвечающему за принятие решений, и вывод сообщений.
+///
+/// \returns true, если подключены все источники, иначе false.
+bool OptimalPipeTrackFinder::connectSourcesInOrder(PipeTrack & pipeTrack, PipeTrackLocationIndex & pipeTrackLocationIndex, const std::vector<const WaterSource*> & sourceOrder, bool isInteractive) {
+    
+    for (const WaterSource * waterSourceP : sourceOrder) {
+        if (isInterrupted()) {
+            return false;
+        }
+        if (isInteractive) {
+            view.printMessage("Подключение источника \"" + waterSourceP->name() + "\".");
+        }
+        try {
+            connectSourceToPipeTrack(pipeTrack, pipeTrackLocationIndex, *waterSourceP, isInteractive);
+        }
+        catch (const Exception &) {
+            // подключение не найдено из-за прерывания поиска
+            if (searchIsInterrupted) {
+                return false;
+            }
+            throw;
+        }
+        if (isInteractive) {
+            view.printMessage("Источник \"" + waterSourceP->name() + "\" подключен.");
+        }
+    }
+    
+    return true;
+    
+}
+
+/// Подключить к имеющейся трассе pipeTrack источник waterSource. Если трасса пустая, то источник добавляется к стоку. Добавленные в трассу узлы заносятся в индекс инцидентности. Метод может бросать Exception-исключение.
+///
+/// \param pipeTrack Текущая трасса.
+/// \param pipeTrackLocationIndex Индекс инцидентности узлов трассы pipeTrack и узлов графа локации.
 /// \param waterSource Подключаемой к трассе источник.
-void OptimalPipeTrackFinder::connectSourceToPipeTrack(PipeTrack & pipeTrack, const WaterSource & waterSource) {
+/// \param isInteractive Флаг интерактивного построения, при котором разрешены обращение к объекту, отвечающему за принятие решений, и вывод сообщений. Если равен false, выбирается путь с ломаной наименьшей псевдодлины.
+void OptimalPipeTrackFinder::connectSourceToPipeTrack(PipeTrack & pipeTrack, PipeTrackLocationIndex & pipeTrackLocationIndex, const WaterSource & waterSource, bool isInteractive) {
     
-    // Шаг 1. Нахождение для каждого узла трассы узлов локации, через которые данный узел проходит. Нахождение для каждого узла локации узлов трассы, проходящих через данный узел локации.
+    CandidatePathRanking::Candidate connection = findSourceConnection(pipeTrack, pipeTrackLocationIndex, waterSource, isInteractive);
+    addSourceConnectionToPipeTrack(pipeTrack, pipeTrackLocationIndex, waterSource, connection);
     
-    std::map<const PipeTrackNode*, std::vector<const LocationGraphNode*>> locationNodesForPipeTrackNode;
-    std::map<const LocationGraphNode*, std::vector<const PipeTrackNode*>> pipeTrackNodesForLocationNode;
-    for (const PipeTrackNode * pipeTrackNodeP : pipeTrack.nodePs) {
-        locationNodesForPipeTrackNode[pipeTrackNodeP] = std::vector<const LocationGraphNode*>();
-    }
-    for (const LocationGraphNode * locationNodeP : locationGraph.nodePs) {
-        pipeTrackNodesForLocationNode[locationNodeP] = std::vector<const PipeTrackNode*>();
+}
+
+/// Подключить к пустой трассе pipeTrack все источники приближенным построением дерева Штейнера (эвристика кратчайших путей Такахаши-Мацуямы). Дерево растет от стока: на каждом шаге для всех неподключенных источников параллельно находятся подключения к текущей трассе, и добавляется подключение наименьшей псевдодлины. Подключение прекращается, если вычисление прервано. Метод может бросать Exception-исключение.
+///
+/// \param pipeTrack Пустая трасса.
+/// \param pipeTrackLocationIndex Индекс инцидентности узлов трассы pipeTrack и узлов графа локации.
+///
+/// \returns true, если подключены все источники, иначе false.
+bool OptimalPipeTrackFinder::connectSourcesBySteinerTreeHeuristic(PipeTrack & pipeTrack, PipeTrackLocationIndex & pipeTrackLocationIndex) {
+    
+    std::vector<const WaterSource*> remainingWaterSourcesPs;
+    for (const WaterSource & waterSource : waterConnectionObjects.waterSources) {
+        remainingWaterSourcesPs.push_back(&waterSource);
     }
     
-    for (const PipeTrackNode * pipeTrackNodeP : pipeTrack.nodePs) {
-        for (const LocationGraphNode * locationNodeP : locationGraph.nodePs) {
-            if (pipeTrackNodeP->isIntersectedWithRectangle(locationNodeP->left, locationNodeP->right, locationNodeP->bottom, locationNodeP->top)) {
-                locationNodesForPipeTrackNode[pipeTrackNodeP].push_back(locationNodeP);
-                pipeTrackNodesForLocationNode[locationNodeP].push_back(pipeTrackNodeP);
+    while (remainingWaterSourcesPs.size() > 0) {
+        
+        if (isInterrupted()) {
+            return false;
+        }
+        
+        // Нахождение подключений всех неподключенных источников к текущей трассе. Для источников, подключение которых не найдено, сохраняется сообщение об ошибке.
+        std::vector<CandidatePathRanking::Candidate> connections(remainingWaterSourcesPs.size());
+        std::vector<std::string> errorMessages(remainingWaterSourcesPs.size());
+        threadPool.runForEachIndex(static_cast<unsigned int>(remainingWaterSourcesPs.size()), [&](unsigned int sourceIndex) {
+            try {
+                connections[sourceIndex] = findSourceConnection(pipeTrack, pipeTrackLocationIndex, *remainingWaterSourcesPs[sourceIndex], false);
+            }
+            catch (const Exception & exception) {
+                errorMessages[sourceIndex] = exception.errorMessage;
+            }
+        });
+        
+        // Выбор подключения наименьшей псевдодлины. При равной псевдодлине выбирается источник большего диаметра (источники упорядочены по уменьшению диаметров).
+        int bestSourceIndex = -1;
+        for (int i = 0; i < remainingWaterSourcesPs.size(); i++) {
+            if (connections[i].zigzag.size() == 0) {
+                continue;
+            }
+            if (bestSourceIndex == -1 || connections[i].pseudoLength < connections[bestSourceIndex].pseudoLength) {
+                bestSourceIndex = i;
+            }
+        }
+        if (bestSourceIndex == -1) {
+            // подключения не найдены из-за прерывания поиска
+            if (searchIsInterrupted) {
+                return false;
             }
+            throw Exception(errorMessages[0]);
         }
+        
+        const WaterSource & waterSource = *remainingWaterSourcesPs[bestSourceIndex];
+        view.printMessage("Подключение источника \"" + waterSource.name() + "\".");
+        addSourceConnectionToPipeTrack(pipeTrack, pipeTrackLocationIndex, waterSource, connections[bestSourceIndex]);
+        view.printMessage("Источник \"" + waterSource.name() + "\" подключен.");
+        remainingWaterSourcesPs.erase(remainingWaterSourcesPs.begin() + bestSourceIndex);
+        
     }
     
+    return true;
+    
+}
+
+/// Найти подключение источника waterSource к имеющейся трассе pipeTrack (путь в графе локации и ломаную) без изменения трассы. Если трасса пустая, то находится подключение к стоку. Метод может бросать Exception-исключение.
+///
+/// \param pipeTrack Текущая трасса.
+/// \param pipeTrackLocationIndex Индекс инцидентности узлов трассы pipeTrack и узлов графа локации.
+/// \param waterSource Подключаемой к трассе источник.
+/// \param isInteractive Флаг интерактивного построения, при котором разрешены обращение к объекту, отвечающему за принятие решений, и вывод сообщений. Если равен false, выбирается путь с ломаной наименьшей псевдодлины.
+///
+/// \returns Найденное подключение.
+CandidatePathRanking::Candidate OptimalPipeTrackFinder::findSourceConnection(const PipeTrack & pipeTrack, const PipeTrackLocationIndex & pipeTrackLocationIndex, const WaterSource & waterSource, bool isInteractive) {
+    
+    // Шаг 1. Получение из индекса инцидентности для каждого узла локации узлов трассы, проходящих через данный узел локации.
+    const std::map<const LocationGraphNode*, std::vector<const PipeTrackNode*>> & pipeTrackNodesForLocationNode = pipeTrackLocationIndex.pipeTrackNodesForLocationNode;
+    
     // Шаг 2. Нахождение узла локации, содержащего подключаемый источник.
     const LocationGraphNode * sourceLocationNodeP = nullptr;
     for (const LocationGraphNode * locationNodeP : locationGraph.nodePs) {
@@ -179,114 +670,205 @@ void OptimalPipeTrackFinder::connectSourceToPipeTrack(PipeTrack & pipeTrack, con
         }
     }
     
-    // Шаг 3. Нахождение подходящих путей в графе локации от подключаемого источника к трассе.
-    std::vector<std::vector<const LocationGraphNode*>> pathsFromSourceToPipeTrack;
-    std::vector<const LocationGraphNode*> buildingPath;
-    std::set<const LocationGraphNode*> passedNodes;
-    buildingPath.push_back(sourceLocationNodeP);
-    passedNodes.insert(sourceLocationNodeP);
-    findAllPathsFromSourceToPipeTrack(pathsFromSourceToPipeTrack, buildingPath, passedNodes, pipeTrackNodesForLocationNode);
-    
-    // Шаг 4. Нахождение для каждого найденного пути ломаной минимальной псевдодлины, соединяющей точку входа подключаемого источника с трассой с учетом внешнего диаметра источника.
-    std::vector<std::pair<std::vector<Point>, const PipeTrackNode*>> zigzagForPathsFromSourceToPipeTrack;
-    for (const std::vector<const LocationGraphNode*> & pathFromSourceToPipeTrack : pathsFromSourceToPipeTrack) {
-        std::pair<std::vector<Point>, const PipeTrackNode*> findResult = findMinPseudoLengthZigzagFromSourceToPipeTrackAndPipeTrackNodeP(pathFromSourceToPipeTrack, pipeTrack, waterSource, pipeTrackNodesForLocationNode);
-        zigzagForPathsFromSourceToPipeTrack.push_back(findResult);
-    }
-    
-    // Шаг 5. Сортировка найденных путей и соответствующих ломаных по возрастанию псевдодлины ломаной.
-    for (int i = 0; i < pathsFromSourceToPipeTrack.size() - 1; i++) {
-        for (int j = i + 1; j < pathsFromSourceToPipeTrack.size(); j++) {
-            // нахождение первой длины ломаной
-            CalcNumber zigzagLength1 = 0;
-            if (zigzagForPathsFromSourceToPipeTrack[i].first.size() == 0) {
-                zigzagLength1 = 999999;
-            } else {
-                for (int l = 1; l < zigzagForPathsFromSourceToPipeTrack[i].first.size(); l++) {
-                    zigzagLength1 += (zigzagForPathsFromSourceToPipeTrack[i].first[l] - zigzagForPathsFromSourceToPipeTrack[i].first[l - 1]).length();
-                }
-            }
-            // нахождение второй длины ломаной
-            CalcNumber zigzagLength2 = 0;
-            if (zigzagForPathsFromSourceToPipeTrack[j].first.size() == 0) {
-                zigzagLength2 = 999999;
-            } else {
-                for (int l = 1; l < zigzagForPathsFromSourceToPipeTrack[j].first.size(); l++) {
-                    zigzagLength2 += (zigzagForPathsFromSourceToPipeTrack[j].first[l] - zigzagForPathsFromSourceToPipeTrack[j].first[l - 1]).length();
-                }
-            }
-            // сравнение длин ломаных
-            if (zigzagLength2 < zigzagLength1) {
-                // перстановка i-го и j-го элементов местами
-                std::vector<const LocationGraphNode*> path = pathsFromSourceToPipeTrack[i];
-                pathsFromSourceToPipeTrack[i] = pathsFromSourceToPipeTrack[j];
-                pathsFromSourceToPipeTrack[j] = path;
-                std::pair<std::vector<Point>, const PipeTrackNode*> zigzag = zigzagForPathsFromSourceToPipeTrack[i];
-                zigzagForPathsFromSourceToPipeTrack[i] = zigzagForPathsFromSourceToPipeTrack[j];
-                zigzagForPathsFromSourceToPipeTrack[j] = zigzag;
+    // Шаг 3. Проверка достижимости трассы или стока из узла источника по проходам, ширина которых не меньше внешнего диаметра источника. Поиск путей может закончиться только в узле со стоком или с узлами трассы, поэтому если в компоненте связности узла источника таких узлов нет, подключение невозможно.
+    unsigned int diameterIndex = locationPassabilityTable.diameterIndexOf(waterSource.diameter());
+    if (diameterIndex != LocationPassabilityTable::noIndex) {
+        unsigned int sourceNodeIndex = compactLocationGraph.indexOf(sourceLocationNodeP);
+        unsigned int sourceComponent = locationPassabilityTable.componentOf(diameterIndex, sourceNodeIndex);
+        bool targetIsReachable = locationPassabilityTable.destinationIsReachable(diameterIndex, sourceNodeIndex);
+        for (auto iter = pipeTrackNodesForLocationNode.begin(); iter != pipeTrackNodesForLocationNode.end() && targetIsReachable == false; iter++) {
+            if (iter->second.size() > 0 && locationPassabilityTable.componentOf(diameterIndex, compactLocationGraph.indexOf(iter->first)) == sourceComponent) {
+                targetIsReachable = true;
             }
         }
+        if (targetIsReachable == false) {
+            throw Exception("Ошибка при поиске пути от источника \"" + waterSource.name() + "\" до трассы или стока. Трасса и сток недостижимы через проходы, ширина которых не меньше внешнего диаметра источника.");
+        }
     }
     
-    // Шаг 6. Устранение найденных путей и соответствующих ломаных для неудачных поисков ломаных.
-    for (int i = static_cast<int>(pathsFromSourceToPipeTrack.size()) - 1; i >= 0; i--) {
-        if (zigzagForPathsFromSourceToPipeTrack[i].first.size() == 0) {
-            pathsFromSourceToPipeTrack.pop_back();
-            zigzagForPathsFromSourceToPipeTrack.pop_back();
+    // Шаг 4. Нахождение подходящих путей в графе локации от подключаемого источника к трассе.
+    std::vector<std::vector<const LocationGraphNode*>> pathsFromSourceToPipeTrack;
+    if (optimizationParameters.pathSearchMode == OptimizationParameters::bestFirstSearch) {
+        std::vector<const LocationGraphNode*> bestPath = findBestFirstPathFromSourceToPipeTrack(sourceLocationNodeP, waterSource, pipeTrackNodesForLocationNode);
+        if (bestPath.size() > 0) {
+            pathsFromSourceToPipeTrack.push_back(bestPath);
         }
+    } else if (optimizationParameters.pathSearchMode == OptimizationParameters::kShortestPathsSearch) {
+        pathsFromSourceToPipeTrack = findKShortestPathsFromSourceToPipeTrack(sourceLocationNodeP, waterSource, pipeTrackNodesForLocationNode, optimizationParameters.candidatePathsCount);
+    } else {
+        std::vector<const LocationGraphNode*> buildingPath;
+        std::set<const LocationGraphNode*> passedNodes;
+        buildingPath.push_back(sourceLocationNodeP);
+        passedNodes.insert(sourceLocationNodeP);
+        CalcNumber bestPseudoLength = std::numeric_limits<CalcNumber>::max();
+        std::vector<std::pair<Point, Point>> buildingPortals;
+        CalcNumber externalDiameterHalfed = pipeObjectsBag.getExternalDiameter(waterSource.diameter()) / 2;
+        Point sourceConnectionPoint = findSourceConnectionPoint(sourceLocationNodeP, waterSource);
+        findAllPathsFromSourceToPipeTrack(pathsFromSourceToPipeTrack, buildingPath, sourceConnectionPoint, sourceConnectionPoint, buildingPortals, 0, passedNodes, bestPseudoLength, externalDiameterHalfed, diameterIndex, pipeTrack, pipeTrackNodesForLocationNode);
+    }
+    
+    // Шаг 5. Нахождение для каждого найденного пути ломаной минимальной псевдодлины, соединяющей точку входа подключаемого источника с трассой с учетом внешнего диаметра источника. Пути оцениваются параллельно, результат каждой оценки сохраняется под номером пути. При прерывании вычисления оценивается только первый путь.
+    std::vector<std::pair<std::vector<Point>, const PipeTrackNode*>> zigzagForPathsFromSourceToPipeTrack(pathsFromSourceToPipeTrack.size());
+    threadPool.runForEachIndex(static_cast<unsigned int>(pathsFromSourceToPipeTrack.size()), [&](unsigned int pathIndex) {
+        if (pathIndex > 0 && isInterrupted()) {
+            return;
+        }
+        zigzagForPathsFromSourceToPipeTrack[pathIndex] = findMinPseudoLengthZigzagFromSourceToPipeTrackAndPipeTrackNodeP(pathsFromSourceToPipeTrack[pathIndex], pipeTrack, waterSource, pipeTrackNodesForLocationNode);
+    });
+    
+    // Шаг 6. Ранжирование найденных путей и соответствующих ломаных по возрастанию псевдодлины ломаной. Пути с неудачным поиском ломаной устраняются. Сохраняется только необходимое число лучших путей: в режиме поиска нескольких путей-кандидатов - их число, иначе - один путь.
+    unsigned int keptCandidatesCount = (optimizationParameters.pathSearchMode == OptimizationParameters::kShortestPathsSearch) ? optimizationParameters.candidatePathsCount : 1;
+    CandidatePathRanking candidatePathRanking { keptCandidatesCount };
+    for (int i = 0; i < pathsFromSourceToPipeTrack.size(); i++) {
+        candidatePathRanking.addCandidate(std::move(pathsFromSourceToPipeTrack[i]), std::move(zigzagForPathsFromSourceToPipeTrack[i].first), zigzagForPathsFromSourceToPipeTrack[i].second);
     }
+    if (isInteractive && optimizationParameters.pathSearchMode != OptimizationParameters::bestFirstSearch) {
+        view.printMessage("Оценено путей-кандидатов: " + std::to_string(candidatePathRanking.seenCount()) + ", оставлено: " + std::to_string(candidatePathRanking.keptCount()) + ".");
+    }
+    std::vector<CandidatePathRanking::Candidate> candidates = candidatePathRanking.extractSortedCandidates();
     
-    if (pathsFromSourceToPipeTrack.size() == 0) {
+    // Шаг 7. Проверка наличия хотя бы одного пути с найденной ломаной.
+    if (candidates.size() == 0) {
         throw Exception("Ошибка при поиске ломаной минимальной псевдодлины от источника \"" + waterSource.name() + "\" до трассы или стока. Ломаная не найдена.");
     }
     
-    // Шаг 7. Для дальнейшего использования оставляется пара (путь, ломаная) с ломаной наименьшей псевдодлины.
-    /// Используемый путь для подключения источника.
-    std::vector<const LocationGraphNode*> pathFromSourceToPipeTrack = pathsFromSourceToPipeTrack[0];
-    /// Соответствующая данному пути ломаная от точки входа источника до центра стока или ближайшей точки центрального отрезка трубы.
-    std::vector<Point> zigzagFromSourceToPipeTrack = zigzagForPathsFromSourceToPipeTrack[0].first;
-    /// Узел трассы системы водоотведения для подключения или сток (в случае nullptr).
-    const PipeTrackNode* endPipeTrackNodeToConnect = zigzagForPathsFromSourceToPipeTrack[0].second;
+    // Шаг 8. Для дальнейшего использования оставляется пара (путь, ломаная) с ломаной наименьшей псевдодлины. В режиме поиска нескольких путей-кандидатов выбор пары предоставляется объекту, отвечающему за принятие решений, если построение интерактивное.
+    int chosenPathIndex = 0;
+    if (isInteractive && optimizationParameters.pathSearchMode == OptimizationParameters::kShortestPathsSearch && candidates.size() > 1) {
+        std::vector<DecisionMaker::Alternative> alternatives;
+        for (int i = 0; i < candidates.size(); i++) {
+            alternatives.push_back(DecisionMaker::Alternative(i + 1, "число узлов локации в пути - " + std::to_string(candidates[i].path.size()) + ", псевдодлина ломаной - " + std::to_string(static_cast<int>(candidates[i].pseudoLength)) + " мм."));
+        }
+        chosenPathIndex = decisionMaker.helpWithDecision("Выбор пути подключения источника \"" + waterSource.name() + "\" к трассе.", alternatives) - 1;
+    }
+    return std::move(candidates[chosenPathIndex]);
+    
+}
+
+/// Добавить к трассе pipeTrack трубы подключения источника waterSource в соответствии с ломаной найденного подключения. Добавленные в трассу узлы заносятся в индекс инцидентности.
+///
+/// \param pipeTrack Текущая трасса.
+/// \param pipeTrackLocationIndex Индекс инцидентности узлов трассы pipeTrack и узлов графа локации.
+/// \param waterSource Подключаемой к трассе источник.
+/// \param connection Подключение, найденное для данного источника и данной трассы.
+void OptimalPipeTrackFinder::addSourceConnectionToPipeTrack(PipeTrack & pipeTrack, PipeTrackLocationIndex & pipeTrackLocationIndex, const WaterSource & waterSource, const CandidatePathRanking::Candidate & connection) {
     
-    // Шаг 8 (временный для демонстрации 2D вида схемы). \todo заменить
-    // Добавить к имеющейся трассе трубы в соответствии с ломаной zigzagFromSourceToPipeTrack
+    // Временное решение для демонстрации 2D вида схемы. \todo заменить
+    // Ломаная от точки входа источника до центра стока или ближайшей точки центрального отрезка трубы.
+    const std::vector<Point> & zigzagFromSourceToPipeTrack = connection.zigzag;
     unsigned int diameter = waterSource.diameter();
     Point sourcePoint = Point(waterSource.point().x, waterSource.point().y, 0);
     PipeTrackNode * sourceToConnectionNodeP = pipeTrack.createNodeAndReturnP(direct, pipeObjectsBag.getDirectPipeP(diameter), Point(), sourcePoint, zigzagFromSourceToPipeTrack[0], Point(), Point(), Point());
+    pipeTrackLocationIndex.addPipeTrackNode(sourceToConnectionNodeP);
     PipeTrackNode * previousNodeP = sourceToConnectionNodeP;
     for (int i = 1; i < zigzagFromSourceToPipeTrack.size(); i++) {
         PipeTrackNode * currentNodeP = pipeTrack.createNodeAndReturnP(direct, pipeObjectsBag.getDirectPipeP(diameter), Point(), previousNodeP->endPoint, zigzagFromSourceToPipeTrack[i], Point(), Point(), Point());
+        pipeTrackLocationIndex.addPipeTrackNode(currentNodeP);
         previousNodeP = currentNodeP;
     }
    
 }
 
-/// Достроить текущий строящийся путь в графе локации до трассы. Если путь не однозначен, построить всевозможные варианты. Если трасса пустая, путь строится до стока.
+/// Достроить текущий строящийся путь в графе локации до трассы. Если путь не однозначен, построить всевозможные варианты (метод ветвей и границ). Вместе с путем строятся порталы между его соседними узлами. Достроенный путь оценивается длиной ломаной, спрямленной алгоритмом воронки, - той же псевдодлиной, по которой ранжируются найденные пути. Ветвь отбрасывается, если проход между узлами недостаточен для прокладки трубы или если нижняя оценка спрямленной ломаной любого продолжения ветви превосходит псевдодлину лучшего из достроенных путей. Если трасса пустая, путь строится до стока.
 ///
 /// \param builtPaths Массив уже построенных путей. В данный массив сохраняются достроенные пути.
 /// \param buildingPath Текущий строящийся путь. Последний элемент данного массива - последний пройденный узел, от которого необходимо продолжить строительство. Массив должен быть непустым.
+/// \param startPoint Точка входа подключаемого источника, с которой начинается ломаная (единица измерения - мм.).
+/// \param buildingZigzagLastPoint Точка входа жадно построенной ломаной текущего строящегося пути в последний пройденный узел. По ней выбирается конечная точка ломаной (единица измерения - мм.).
+/// \param buildingPortals Порталы между соседними узлами текущего строящегося пути.
+/// \param buildingLengthLowerBound Нижняя оценка длины ломаной от точки startPoint до последнего портала текущего строящегося пути или 0, если порталов нет (единица измерения - мм.).
 /// \param passedNodes Множество уже пройденных узлов в текущем пути.
+/// \param bestPseudoLength Псевдодлина спрямленной ломаной лучшего из достроенных путей (единица измерения - мм.).
+/// \param externalDiameterHalfed Половина внешнего диаметра подключаемого источника (единица измерения - мм.).
+/// \param diameterIndex Индекс диаметра подключаемого источника в таблице проходимости или LocationPassabilityTable::noIndex, если таблица для диаметра не построена.
+/// \param pipeTrack Трасса системы водоотведения.
 /// \param pipeTrackNodesForLocationNode Словарь, в котором для каждого узла графа локации содержится массив содержащихся в нем узлов трассы.
-void OptimalPipeTrackFinder::findAllPathsFromSourceToPipeTrack(std::vector<std::vector<const LocationGraphNode*>> & builtPaths, std::vector<const LocationGraphNode*> & buildingPath, std::set<const LocationGraphNode*> & passedNodes, std::map<const LocationGraphNode*, std::vector<const PipeTrackNode*>> & pipeTrackNodesForLocationNode) {
+void OptimalPipeTrackFinder::findAllPathsFromSourceToPipeTrack(std::vector<std::vector<const LocationGraphNode*>> & builtPaths, std::vector<const LocationGraphNode*> & buildingPath, const Point & startPoint, const Point & buildingZigzagLastPoint, std::vector<std::pair<Point, Point>> & buildingPortals, CalcNumber buildingLengthLowerBound, std::set<const LocationGraphNode*> & passedNodes, CalcNumber & bestPseudoLength, CalcNumber externalDiameterHalfed, unsigned int diameterIndex, const PipeTrack & pipeTrack, const std::map<const LocationGraphNode*, std::vector<const PipeTrackNode*>> & pipeTrackNodesForLocationNode) {
+    
+    // прекращение перебора при прерывании вычисления
+    if (isInterrupted()) {
+        return;
+    }
+    
+    // отсечение ветви, которая заведомо не лучше уже достроенного пути
+    CalcNumber lowerBound = 0;
+    if (buildingPortals.size() == 0) {
+        lowerBound = calculatePseudoLengthLowerBound(startPoint, pipeTrack);
+    } else {
+        const std::pair<Point, Point> & lastPortal = buildingPortals[buildingPortals.size() - 1];
+        lowerBound = PortalFunnel::calculateLengthLowerBound(lastPortal, buildingLengthLowerBound, calculatePseudoLengthLowerBound(PortalFunnel::calculatePortalMiddle(lastPortal), pipeTrack));
+    }
+    if (lowerBound > bestPseudoLength) {
+        return;
+    }
     
     const LocationGraphNode * lastPassedNode = buildingPath[buildingPath.size() - 1];
-    if (pipeTrackNodesForLocationNode[lastPassedNode].size() > 0 || lastPassedNode == locationGraph.waterDestinationNodeP) {
-        // текущий путь добавляется в массив построенных путей
-        builtPaths.push_back(buildingPath);
+    if (pipeTrackNodesForLocationNode.at(lastPassedNode).size() > 0 || lastPassedNode == locationGraph.waterDestinationNodeP) {
+        Point endPoint;
+        const PipeTrackNode * endPipeTrackNodeP = nullptr;
+        if (findZigzagEndPoint(lastPassedNode, buildingZigzagLastPoint, pipeTrackNodesForLocationNode, endPoint, endPipeTrackNodeP)) {
+            // текущий путь добавляется в массив построенных путей
+            builtPaths.push_back(buildingPath);
+            bestPseudoLength = std::min(bestPseudoLength, PortalFunnel::calculatePolylineLength(PortalFunnel::findShortestPolyline(startPoint, buildingPortals, endPoint)));
+        }
     }
-    for (LocationGraphNode * adjacentNodeP : lastPassedNode->adjacentNodes()) {
+    for (const CompactLocationGraph::Edge & edge : compactLocationGraph.edgesOf(compactLocationGraph.indexOf(lastPassedNode))) {
+        if (diameterIndex != LocationPassabilityTable::noIndex && locationPassabilityTable.edgeIsPassable(diameterIndex, compactLocationGraph.edgeIndexOf(edge)) == false) {
+            // данного прохода не достаточно для прокладки трубы
+            continue;
+        }
+        const LocationGraphNode * adjacentNodeP = compactLocationGraph.nodeP(edge.nodeIndex);
         if (passedNodes.find(adjacentNodeP) == passedNodes.end()) {
+            std::pair<Point, Point> portal;
+            if (calculatePortal(lastPassedNode, adjacentNodeP, externalDiameterHalfed, portal) == false) {
+                // данного прохода не достаточно для прокладки трубы
+                continue;
+            }
+            Point newPoint;
+            calculateNextZigzagPoint(lastPassedNode, adjacentNodeP, buildingZigzagLastPoint, externalDiameterHalfed, newPoint);
+            
             buildingPath.push_back(adjacentNodeP);
+            buildingPortals.push_back(portal);
             passedNodes.insert(adjacentNodeP);
-            findAllPathsFromSourceToPipeTrack(builtPaths, buildingPath, passedNodes, pipeTrackNodesForLocationNode);
+            CalcNumber newLengthLowerBound = PortalFunnel::calculateLengthToLastPortalLowerBound(startPoint, buildingPortals, buildingLengthLowerBound);
+            findAllPathsFromSourceToPipeTrack(builtPaths, buildingPath, startPoint, newPoint, buildingPortals, newLengthLowerBound, passedNodes, bestPseudoLength, externalDiameterHalfed, diameterIndex, pipeTrack, pipeTrackNodesForLocationNode);
             buildingPath.pop_back();
+            buildingPortals.pop_back();
             passedNodes.erase(adjacentNodeP);
         }
     }
     
 }
 
-/// Найти для пути pathFromSourceToPipeTrack ломаную минимальной псевдодлины, соединяющую точку входа подключаемого источника waterSource с трассой pipeTrack. При поиске учитывается внешний диаметр источника. Если трасса пустая, то источник соединяется со стоком.
+/// Вычислить нижнюю оценку псевдодлины ломаной от точки point до трассы или стока. Оценкой является расстояние в плоскости XY от точки до ближайшей из точек центральных отрезков прямых и фановых труб трассы и центра стока. Ближайшая точка трассы ищется по пространственному индексу трассы.
+///
+/// \param point Точка (единица измерения - мм.).
+/// \param pipeTrack Трасса системы водоотведения.
+///
+/// \return Нижняя оценка псевдодлины ломаной (единица измерения - мм.).
+CalcNumber OptimalPipeTrackFinder::calculatePseudoLengthLowerBound(const Point & point, const PipeTrack & pipeTrack) {
+    
+    CalcNumber lowerBound = std::numeric_limits<CalcNumber>::max();
+    
+    // ломаная строится в плоскости XY
+    Point point2D = Point(point.x, point.y, 0);
+    
+    if (locationGraph.waterDestinationNodeP != nullptr) {
+        Point waterDestinationPoint = Point(locationGraph.waterDestinationNodeP->waterDestinationP->point().x, locationGraph.waterDestinationNodeP->waterDestinationP->point().y, 0);
+        lowerBound = (waterDestinationPoint - point2D).length();
+    }
+    
+    Point nearestCenterPoint;
+    const PipeTrackNode * nearestPipeTrackNodeP = nullptr;
+    if (pipeTrack.findNearestCenterPoint2D(point2D, nearestCenterPoint, nearestPipeTrackNodeP)) {
+        lowerBound = std::min(lowerBound, (nearestCenterPoint - point2D).length());
+    }
+    
+    return lowerBound;
+    
+}
+
+/// Найти для пути pathFromSourceToPipeTrack ломаную минимальной псевдодлины, соединяющую точку входа подключаемого источника waterSource с трассой pipeTrack. При поиске учитывается внешний диаметр источника. Если трасса пустая, то источник соединяется со стоком. Конечная точка ломаной выбирается по жадно построенной ломаной, после чего ломаная спрямляется алгоритмом воронки через порталы между соседними узлами пути.
 ///
 /// \param pathFromSourceToPipeTrack Путь от источника до трассы в виде узлов графа локации.
 /// \param pipeTrack Трасса системы водоотведения.
@@ -294,97 +876,410 @@ void OptimalPipeTrackFinder::findAllPathsFromSourceToPipeTrack(std::vector<std::
 /// \param pipeTrackNodesForLocationNode Словарь, в котором для каждого узла графа локации содержится массив содержащихся в нем узлов трассы.
 ///
 /// \return Пара типа (ломаная, указатель на соединяемый узел трассы). Ломаная - ломаная минимальной псевдодлины, проходящая через узлы пути pathFromSourceToPipeTrack, соединяющая источник waterSource с трассой pipeTrack. Если последней точкой ломаной является центр стока, то указатель на соединяемый узел трассы равен nullptr. Если поиск неуспешен, возвращается пустая ломаная.
-std::pair<std::vector<Point>, const PipeTrackNode*> OptimalPipeTrackFinder::findMinPseudoLengthZigzagFromSourceToPipeTrackAndPipeTrackNodeP(const std::vector<const LocationGraphNode*> & pathFromSourceToPipeTrack, const PipeTrack & pipeTrack, const WaterSource & waterSource, std::map<const LocationGraphNode*, std::vector<const PipeTrackNode*>> & pipeTrackNodesForLocationNode) {
+std::pair<std::vector<Point>, const PipeTrackNode*> OptimalPipeTrackFinder::findMinPseudoLengthZigzagFromSourceToPipeTrackAndPipeTrackNodeP(const std::vector<const LocationGraphNode*> & pathFromSourceToPipeTrack, const PipeTrack & pipeTrack, const WaterSource & waterSource, const std::map<const LocationGraphNode*, std::vector<const PipeTrackNode*>> & pipeTrackNodesForLocationNode) {
     
     // половина внешнего диаметра источника
     CalcNumber externalDiameterHalfed = pipeObjectsBag.getExternalDiameter(waterSource.diameter()) / 2;
     
-    // результирующая ломаная
+    // жадно построенная ломаная
     std::vector<Point> zigzag;
     
+    // порталы между соседними узлами пути
+    std::vector<std::pair<Point, Point>> portals;
+    
     // добавление в ломаную точку входа подключаемого источника
-    const LocationGraphNode * sourceLocationNodeP = pathFromSourceToPipeTrack[0];
-    for (int i = 0; i < sourceLocationNodeP->waterSourcesPs.size(); i++) {
-        if (&waterSource == sourceLocationNodeP->waterSourcesPs[i]) {
-            zigzag.push_back(sourceLocationNodeP->waterSourcesConnectionPoints[i]);
-        }
-    }
+    zigzag.push_back(findSourceConnectionPoint(pathFromSourceToPipeTrack[0], waterSource));
     
     for (int i = 0; i < pathFromSourceToPipeTrack.size() - 1; i++) {
         
-        // добавление в ломаную точки на границе между текущим и следующим узлами пути
-        
-        // указатель на текущий узел пути
-        const LocationGraphNode* currentNodeP = pathFromSourceToPipeTrack[i];
-        // указатель на следующий узел пути
-        const LocationGraphNode* nextNodeP = pathFromSourceToPipeTrack[i + 1];
+        // добавление портала и ближайшей к последней точке ломаной точки портала
+        std::pair<Point, Point> portal;
+        if (calculatePortal(pathFromSourceToPipeTrack[i], pathFromSourceToPipeTrack[i + 1], externalDiameterHalfed, portal) == false) {
+            // данного прохода не достаточно для прокладки трубы
+            return std::pair<std::vector<Point>, const PipeTrackNode*>(std::vector<Point>(), nullptr);
+        }
+        portals.push_back(portal);
+        Point newPoint;
+        calculateNextZigzagPoint(pathFromSourceToPipeTrack[i], pathFromSourceToPipeTrack[i + 1], zigzag[zigzag.size() - 1], externalDiameterHalfed, newPoint);
+        zigzag.push_back(newPoint);
         
-        // определение взаимного отношения текущего и следующего узлов
-        bool isBottomTop = false, isTopBottom = false, isLeftRight = false, isRightLeft = false;
-        if (std::find(currentNodeP->leftNodesPs.begin(), currentNodeP->leftNodesPs.end(), nextNodeP) != currentNodeP->leftNodesPs.end()) {
-            isRightLeft = true;
+    }
+    
+    // определение последней добавляемой точки в ломаную
+    const LocationGraphNode* endNodeP = pathFromSourceToPipeTrack[pathFromSourceToPipeTrack.size() - 1];
+    Point endPoint;
+    const PipeTrackNode * resultPipeTrackNodeP = nullptr;
+    if (findZigzagEndPoint(endNodeP, zigzag[zigzag.size() - 1], pipeTrackNodesForLocationNode, endPoint, resultPipeTrackNodeP)) {
+        // спрямление ломаной до выбранной конечной точки
+        zigzag = PortalFunnel::findShortestPolyline(zigzag[0], portals, endPoint);
+    } else {
+        zigzag.clear();
+    }
+    
+    return std::pair<std::vector<Point>, const PipeTrackNode*>(zigzag, resultPipeTrackNodeP);
+    
+}
+
+/// Найти путь в графе локации от узла, содержащего источник, до трассы поиском по первому наилучшему (алгоритм Дейкстры). Стоимостью пути является псевдодлина соответствующей ему ломаной. Проходы между узлами, ширина которых меньше внешнего диаметра источника, считаются непроходимыми. Если трасса пустая, путь строится до стока. При использовании иерархии зон поиск сначала ограничивается коридором зон, а при неудаче повторяется по всему графу.
+///
+/// \param sourceLocationNodeP Указатель на узел графа локации, содержащий подключаемый источник.
+/// \param waterSource Подключаемый источник.
+/// \param pipeTrackNodesForLocationNode Словарь, в котором для каждого узла графа локации содержится массив содержащихся в нем узлов трассы.
+///
+/// \return Найденный путь в виде узлов графа локации. Если путь не найден, возвращается пустой массив.
+std::vector<const LocationGraphNode*> OptimalPipeTrackFinder::findBestFirstPathFromSourceToPipeTrack(const LocationGraphNode * sourceLocationNodeP, const WaterSource & waterSource, const std::map<const LocationGraphNode*, std::vector<const PipeTrackNode*>> & pipeTrackNodesForLocationNode) {
+    
+    CalcNumber pseudoLength = 0;
+    
+    // при использовании иерархии зон путь сначала ищется в коридоре зон, найденном грубым поиском
+    if (optimizationParameters.zoneHierarchyIsUsed) {
+        std::vector<unsigned int> targetNodeIndexes;
+        for (const auto & pipeTrackNodesForNode : pipeTrackNodesForLocationNode) {
+            if (pipeTrackNodesForNode.second.size() > 0 || pipeTrackNodesForNode.first == locationGraph.waterDestinationNodeP) {
+                targetNodeIndexes.push_back(compactLocationGraph.indexOf(pipeTrackNodesForNode.first));
+            }
         }
-        if (std::find(currentNodeP->rightNodesPs.begin(), currentNodeP->rightNodesPs.end(), nextNodeP) != currentNodeP->rightNodesPs.end()) {
-            isLeftRight = true;
+        std::vector<unsigned char> corridorNodes = locationZoneHierarchy.findCorridor(compactLocationGraph, compactLocationGraph.indexOf(sourceLocationNodeP), targetNodeIndexes, locationPassabilityTable, locationPassabilityTable.diameterIndexOf(waterSource.diameter()));
+        if (corridorNodes.size() > 0) {
+            std::vector<const LocationGraphNode*> path = findBestFirstPathContinuationToPipeTrack({ sourceLocationNodeP }, findSourceConnectionPoint(sourceLocationNodeP, waterSource), 0, {}, false, corridorNodes, waterSource, pipeTrackNodesForLocationNode, pseudoLength);
+            if (path.size() > 0) {
+                return path;
+            }
         }
-        if (std::find(currentNodeP->bottomNodesPs.begin(), currentNodeP->bottomNodesPs.end(), nextNodeP) != currentNodeP->bottomNodesPs.end()) {
-            isTopBottom = true;
+    }
+    
+    return findBestFirstPathContinuationToPipeTrack({ sourceLocationNodeP }, findSourceConnectionPoint(sourceLocationNodeP, waterSource), 0, {}, false, {}, waterSource, pipeTrackNodesForLocationNode, pseudoLength);
+    
+}
+
+/// Продолжить начальную часть пути startPath в графе локации до трассы поиском по первому наилучшему (алгоритм Дейкстры). Стоимостью пути является псевдодлина соответствующей ему ломаной. Поиск приближенный: метка узла хранит одну точку входа ломаной, хотя продолжение ломаной зависит от нее, поэтому найденный путь может быть длиннее кратчайшего. Узлы начальной части пути, кроме последнего, в продолжение пути не входят. Проходы между узлами, ширина которых меньше внешнего диаметра источника, считаются непроходимыми. Если трасса пустая, путь строится до стока.
+///
+/// \param startPath Начальная часть пути от узла, содержащего источник. Последний элемент массива - узел, с которого продолжается поиск. Массив должен быть непустым.
+/// \param startPoint Точка входа ломаной в последний узел начальной части пути (единица измерения - мм.).
+/// \param startPseudoLength Псевдодлина ломаной начальной части пути (единица измерения - мм.).
+/// \param blockedEdges Запрещенные для прохода ребра графа локации в виде пар (узел, из которого выполняется переход; узел, в который выполняется переход).
+/// \param startTerminationIsBlocked Флаг запрета завершения пути в последнем узле начальной части пути.
+/// \param allowedNodes Флаги узлов, в которые разрешено продолжать путь, по индексам компактного представления графа локации, или пустой массив, если разрешены все узлы.
+/// \param waterSource Подключаемый источник.
+/// \param pipeTrackNodesForLocationNode Словарь, в котором для каждого узла графа локации содержится массив содержащихся в нем узлов трассы.
+/// \param pseudoLength Псевдодлина ломаной найденного пути (единица измерения - мм.).
+///
+/// \return Найденный путь целиком (начальная часть и ее продолжение) в виде узлов графа локации. Если путь не найден, возвращается пустой массив.
+std::vector<const LocationGraphNode*> OptimalPipeTrackFinder::findBestFirstPathContinuationToPipeTrack(const std::vector<const LocationGraphNode*> & startPath, const Point & startPoint, CalcNumber startPseudoLength, const std::set<std::pair<const LocationGraphNode*, const LocationGraphNode*>> & blockedEdges, bool startTerminationIsBlocked, const std::vector<unsigned char> & allowedNodes, const WaterSource & waterSource, const std::map<const LocationGraphNode*, std::vector<const PipeTrackNode*>> & pipeTrackNodesForLocationNode, CalcNumber & pseudoLength) {
+    
+    // Метка узла хранит минимальную найденную псевдодлину ломаной до точки входа в узел и саму точку входа. Очередная точка ломаной зависит только от точки входа в текущий узел, поэтому ломаная наращивается вместе с путем.
+    
+    // половина внешнего диаметра источника и индекс диаметра в таблице проходимости
+    CalcNumber externalDiameterHalfed = pipeObjectsBag.getExternalDiameter(waterSource.diameter()) / 2;
+    unsigned int diameterIndex = locationPassabilityTable.diameterIndexOf(waterSource.diameter());
+    
+    const LocationGraphNode * startNodeP = startPath[startPath.size() - 1];
+    
+    // метки хранятся в массиве, индексируемом индексами узлов компактного представления графа локации
+    std::vector<PathSearchLabel> labels(compactLocationGraph.nodesCount(), PathSearchLabel { std::numeric_limits<CalcNumber>::max(), Point(), nullptr, false });
+    std::priority_queue<PathSearchQueueItem, std::vector<PathSearchQueueItem>, std::greater<PathSearchQueueItem>> queue;
+    unsigned long order = 0;
+    
+    // узлы начальной части пути, кроме последнего, помечаются обработанными и не входят в продолжение пути
+    for (int i = 0; i < static_cast<int>(startPath.size()) - 1; i++) {
+        labels[compactLocationGraph.indexOf(startPath[i])] = PathSearchLabel { 0, Point(), nullptr, true };
+    }
+    
+    labels[compactLocationGraph.indexOf(startNodeP)] = PathSearchLabel { startPseudoLength, startPoint, nullptr, false };
+    queue.push(PathSearchQueueItem { startPseudoLength, order++, startNodeP, false });
+    
+    while (queue.empty() == false && isInterrupted() == false) {
+        
+        PathSearchQueueItem item = queue.top();
+        queue.pop();
+        
+        if (item.isFinal) {
+            // восстановление пути от конечного узла до начального узла поиска
+            std::vector<const LocationGraphNode*> continuation;
+            for (const LocationGraphNode * nodeP = item.nodeP; nodeP != nullptr; nodeP = labels[compactLocationGraph.indexOf(nodeP)].previousNodeP) {
+                continuation.push_back(nodeP);
+            }
+            std::vector<const LocationGraphNode*> path(startPath.begin(), startPath.end() - 1);
+            path.insert(path.end(), continuation.rbegin(), continuation.rend());
+            pseudoLength = item.pseudoLength;
+            return path;
         }
-        if (std::find(currentNodeP->topNodesPs.begin(), currentNodeP->topNodesPs.end(), nextNodeP) != currentNodeP->topNodesPs.end()) {
-            isBottomTop = true;
+        
+        unsigned int itemNodeIndex = compactLocationGraph.indexOf(item.nodeP);
+        PathSearchLabel & label = labels[itemNodeIndex];
+        if (label.isSettled || item.pseudoLength > label.pseudoLength) {
+            // устаревший элемент очереди
+            continue;
         }
+        label.isSettled = true;
         
-        // последняя добавленная в ломаную точка
-        Point lastAddedPoint = zigzag[zigzag.size() - 1];
+        // достраивание ломаной до трассы или стока, если они проходят через узел
+        bool terminationIsBlocked = (item.nodeP == startNodeP && startTerminationIsBlocked);
+        if (terminationIsBlocked == false && (pipeTrackNodesForLocationNode.at(item.nodeP).size() > 0 || item.nodeP == locationGraph.waterDestinationNodeP)) {
+            Point endPoint;
+            const PipeTrackNode * endPipeTrackNodeP = nullptr;
+            if (findZigzagEndPoint(item.nodeP, label.lastPoint, pipeTrackNodesForLocationNode, endPoint, endPipeTrackNodeP)) {
+                queue.push(PathSearchQueueItem { label.pseudoLength + (endPoint - label.lastPoint).length(), order++, item.nodeP, true });
+            }
+        }
         
-        // определение новой добавляемой в ломаную точки
-        Point newPoint;
-        if (isBottomTop || isTopBottom) {
-            CalcNumber left = std::max(currentNodeP->left, nextNodeP->left);
-            CalcNumber right = std::min(currentNodeP->right, nextNodeP->right);
-            if (right - left < 2 * externalDiameterHalfed) {
+        // продление пути в смежные узлы
+        for (const CompactLocationGraph::Edge & edge : compactLocationGraph.edgesOf(itemNodeIndex)) {
+            if (diameterIndex != LocationPassabilityTable::noIndex && locationPassabilityTable.edgeIsPassable(diameterIndex, compactLocationGraph.edgeIndexOf(edge)) == false) {
                 // данного прохода не достаточно для прокладки трубы
-                return std::pair<std::vector<Point>, const PipeTrackNode*>(std::vector<Point>(), nullptr);
+                continue;
             }
-            if (lastAddedPoint.x < left + externalDiameterHalfed) {
-                newPoint.x = left + externalDiameterHalfed;
-            } else if (lastAddedPoint.x > right - externalDiameterHalfed) {
-                newPoint.x = right - externalDiameterHalfed;
-            } else {
-                newPoint.x = lastAddedPoint.x;
+            const LocationGraphNode * adjacentNodeP = compactLocationGraph.nodeP(edge.nodeIndex);
+            PathSearchLabel & adjacentLabel = labels[edge.nodeIndex];
+            if (adjacentLabel.isSettled) {
+                continue;
             }
-            newPoint.y = (isBottomTop) ? currentNodeP->top + externalDiameterHalfed : currentNodeP->bottom - externalDiameterHalfed;
-        } else {
-            CalcNumber bottom = std::max(currentNodeP->bottom, nextNodeP->bottom);
-            CalcNumber top = std::min(currentNodeP->top, nextNodeP->top);
-            if (top - bottom < 2 * externalDiameterHalfed) {
+            if (allowedNodes.size() > 0 && allowedNodes[edge.nodeIndex] == 0) {
+                // узел лежит вне коридора зон
+                continue;
+            }
+            if (blockedEdges.size() > 0 && blockedEdges.find(std::make_pair(item.nodeP, adjacentNodeP)) != blockedEdges.end()) {
+                continue;
+            }
+            Point newPoint;
+            if (calculateNextZigzagPoint(item.nodeP, adjacentNodeP, label.lastPoint, externalDiameterHalfed, newPoint) == false) {
                 // данного прохода не достаточно для прокладки трубы
-                return std::pair<std::vector<Point>, const PipeTrackNode*>(std::vector<Point>(), nullptr);
+                continue;
             }
-            if (lastAddedPoint.y < bottom + externalDiameterHalfed) {
-                newPoint.y = bottom + externalDiameterHalfed;
-            } else if (lastAddedPoint.y > top - externalDiameterHalfed) {
-                newPoint.y = top - externalDiameterHalfed;
-            } else {
-                newPoint.y = lastAddedPoint.y;
+            CalcNumber newPseudoLength = label.pseudoLength + (newPoint - label.lastPoint).length();
+            if (newPseudoLength < adjacentLabel.pseudoLength) {
+                adjacentLabel = PathSearchLabel { newPseudoLength, newPoint, item.nodeP, false };
+                queue.push(PathSearchQueueItem { newPseudoLength, order++, adjacentNodeP, false });
             }
-            newPoint.x = (isLeftRight) ? currentNodeP->right + externalDiameterHalfed : currentNodeP->left - externalDiameterHalfed;
         }
         
-        // добавление новой точки в ломаную
-        zigzag.push_back(newPoint);
+    }
+    
+    return std::vector<const LocationGraphNode*>();
+    
+}
+
+/// Найти не более pathsCount путей в графе локации от узла, содержащего источник, до трассы в порядке возрастания псевдодлины соответствующих им ломаных (алгоритм Йена). Пути не содержат повторяющихся узлов. Если трасса пустая, пути строятся до стока.
+///
+/// \param sourceLocationNodeP Указатель на узел графа локации, содержащий подключаемый источник.
+/// \param waterSource Подключаемый источник.
+/// \param pipeTrackNodesForLocationNode Словарь, в котором для каждого узла графа локации содержится массив содержащихся в нем узлов трассы.
+/// \param pathsCount Максимальное число находимых путей.
+///
+/// \return Найденные пути в порядке возрастания псевдодлины ломаных.
+std::vector<std::vector<const LocationGraphNode*>> OptimalPipeTrackFinder::findKShortestPathsFromSourceToPipeTrack(const LocationGraphNode * sourceLocationNodeP, const WaterSource & waterSource, const std::map<const LocationGraphNode*, std::vector<const PipeTrackNode*>> & pipeTrackNodesForLocationNode, unsigned int pathsCount) {
+    
+    // половина внешнего диаметра источника
+    CalcNumber externalDiameterHalfed = pipeObjectsBag.getExternalDiameter(waterSource.diameter()) / 2;
+    
+    /// Найденные пути в порядке возрастания псевдодлины.
+    std::vector<std::vector<const LocationGraphNode*>> shortestPaths;
+    
+    /// Пути-кандидаты, упорядоченные по псевдодлине, а при равенстве - по порядку нахождения.
+    std::map<std::pair<CalcNumber, unsigned long>, std::vector<const LocationGraphNode*>> candidatePaths;
+    unsigned long candidateOrder = 0;
+    
+    /// Множество всех когда-либо найденных путей (для исключения повторов).
+    std::set<std::vector<const LocationGraphNode*>> knownPaths;
+    
+    if (pathsCount == 0) {
+        return shortestPaths;
+    }
+    
+    CalcNumber pseudoLength = 0;
+    std::vector<const LocationGraphNode*> firstPath = findBestFirstPathContinuationToPipeTrack({ sourceLocationNodeP }, findSourceConnectionPoint(sourceLocationNodeP, waterSource), 0, {}, false, {}, waterSource, pipeTrackNodesForLocationNode, pseudoLength);
+    if (firstPath.size() == 0) {
+        return shortestPaths;
+    }
+    shortestPaths.push_back(firstPath);
+    knownPaths.insert(firstPath);
+    
+    while (shortestPaths.size() < pathsCount && isInterrupted() == false) {
+        
+        const std::vector<const LocationGraphNode*> previousPath = shortestPaths[shortestPaths.size() - 1];
+        
+        // точки входа ломаной в узлы предыдущего пути и псевдодлины ломаной до этих точек
+        std::vector<Point> entryPoints { findSourceConnectionPoint(sourceLocationNodeP, waterSource) };
+        std::vector<CalcNumber> entryPseudoLengths { 0 };
+        for (int i = 0; i + 1 < previousPath.size(); i++) {
+            Point newPoint;
+            calculateNextZigzagPoint(previousPath[i], previousPath[i + 1], entryPoints[i], externalDiameterHalfed, newPoint);
+            entryPseudoLengths.push_back(entryPseudoLengths[i] + (newPoint - entryPoints[i]).length());
+            entryPoints.push_back(newPoint);
+        }
+        
+        // поиск ответвлений от каждого узла предыдущего пути
+        for (int i = 0; i < previousPath.size(); i++) {
+            
+            std::vector<const LocationGraphNode*> rootPath(previousPath.begin(), previousPath.begin() + i + 1);
+            
+            // запрещаются переходы, которыми найденные пути с той же начальной частью продолжают ее, а также завершение пути, если начальная часть сама является найденным путем
+            std::set<std::pair<const LocationGraphNode*, const LocationGraphNode*>> blockedEdges;
+            bool rootTerminationIsBlocked = false;
+            for (const std::vector<const LocationGraphNode*> & shortestPath : shortestPaths) {
+                if (shortestPath.size() >= rootPath.size() && std::equal(rootPath.begin(), rootPath.end(), shortestPath.begin())) {
+                    if (shortestPath.size() == rootPath.size()) {
+                        rootTerminationIsBlocked = true;
+                    } else {
+                        blockedEdges.insert(std::make_pair(shortestPath[i], shortestPath[i + 1]));
+                    }
+                }
+            }
+            
+            std::vector<const LocationGraphNode*> candidatePath = findBestFirstPathContinuationToPipeTrack(rootPath, entryPoints[i], entryPseudoLengths[i], blockedEdges, rootTerminationIsBlocked, {}, waterSource, pipeTrackNodesForLocationNode, pseudoLength);
+            if (candidatePath.size() > 0 && knownPaths.find(candidatePath) == knownPaths.end()) {
+                knownPaths.insert(candidatePath);
+                candidatePaths[std::make_pair(pseudoLength, candidateOrder++)] = candidatePath;
+            }
+            
+        }
+        
+        if (candidatePaths.empty()) {
+            break;
+        }
+        
+        // лучший кандидат переносится в найденные пути
+        shortestPaths.push_back(candidatePaths.begin()->second);
+        candidatePaths.erase(candidatePaths.begin());
         
     }
     
-    // определение последней добавляемой точки в ломаную
-    const LocationGraphNode* endNodeP = pathFromSourceToPipeTrack[pathFromSourceToPipeTrack.size() - 1];
-    Point lastAddedPoint = zigzag[zigzag.size() - 1];
+    return shortestPaths;
+    
+}
+
+/// Найти точку входа подключаемого источника waterSource в содержащий его узел графа локации.
+///
+/// \param sourceLocationNodeP Указатель на узел графа локации, содержащий источник.
+/// \param waterSource Подключаемый источник.
+///
+/// \return Точка входа источника в узел (единица измерения - мм.).
+Point OptimalPipeTrackFinder::findSourceConnectionPoint(const LocationGraphNode * sourceLocationNodeP, const WaterSource & waterSource) {
+    
+    for (int i = 0; i < sourceLocationNodeP->waterSourcesPs.size(); i++) {
+        if (&waterSource == sourceLocationNodeP->waterSourcesPs[i]) {
+            return sourceLocationNodeP->waterSourcesConnectionPoints[i];
+        }
+    }
+    
+    assert(false);
+    
+}
+
+/// Проверить, прервано ли текущее вычисление: истек бюджет времени или запрошена отмена. При обнаружении прерывания устанавливается флаг searchIsInterrupted.
+///
+/// \return true, если вычисление прервано, иначе false.
+bool OptimalPipeTrackFinder::isInterrupted() {
+    
+    if (searchIsInterrupted) {
+        return true;
+    }
+    
+    if ((optimizationParameters.cancellationTokenP != nullptr && optimizationParameters.cancellationTokenP->isCancellationRequested()) || std::chrono::steady_clock::now() >= deadline) {
+        searchIsInterrupted = true;
+    }
+    
+    return searchIsInterrupted;
+    
+}
+
+/// Найти портал между текущим узлом пути currentNodeP и следующим узлом пути nextNodeP - отрезок, через который должна пройти ось трубы при переходе в следующий узел. Портал лежит в следующем узле на расстоянии половины внешнего диаметра трубы от общей границы узлов и сужен на половину внешнего диаметра с каждой стороны.
+///
+/// \param currentNodeP Указатель на текущий узел пути.
+/// \param nextNodeP Указатель на следующий узел пути. Должен быть смежным с текущим узлом.
+/// \param externalDiameterHalfed Половина внешнего диаметра трубы (единица измерения - мм.).
+/// \param portal Найденный портал в виде пары (левый конец, правый конец) относительно направления перехода из текущего узла в следующий (единица измерения - мм.).
+///
+/// \return true, если проход между узлами достаточен для прокладки трубы, иначе false.
+bool OptimalPipeTrackFinder::calculatePortal(const LocationGraphNode * currentNodeP, const LocationGraphNode * nextNodeP, CalcNumber externalDiameterHalfed, std::pair<Point, Point> & portal) {
+    
+    // определение взаимного отношения текущего и следующего узлов
+    unsigned int currentIndex = compactLocationGraph.indexOf(currentNodeP);
+    unsigned int nextIndex = compactLocationGraph.indexOf(nextNodeP);
+    CompactLocationGraph::Side side = CompactLocationGraph::leftSide;
+    compactLocationGraph.findSide(currentIndex, nextIndex, side);
+    bool isBottomTop = (side == CompactLocationGraph::topSide);
+    bool isTopBottom = (side == CompactLocationGraph::bottomSide);
+    bool isLeftRight = (side == CompactLocationGraph::rightSide);
+    
+    // определение концов портала
+    if (isBottomTop || isTopBottom) {
+        CalcNumber left = std::max(compactLocationGraph.left(currentIndex), compactLocationGraph.left(nextIndex));
+        CalcNumber right = std::min(compactLocationGraph.right(currentIndex), compactLocationGraph.right(nextIndex));
+        if (right - left < 2 * externalDiameterHalfed) {
+            return false;
+        }
+        if (isBottomTop) {
+            CalcNumber y = compactLocationGraph.top(currentIndex) + externalDiameterHalfed;
+            portal = std::pair<Point, Point>(Point(left + externalDiameterHalfed, y, 0), Point(right - externalDiameterHalfed, y, 0));
+        } else {
+            CalcNumber y = compactLocationGraph.bottom(currentIndex) - externalDiameterHalfed;
+            portal = std::pair<Point, Point>(Point(right - externalDiameterHalfed, y, 0), Point(left + externalDiameterHalfed, y, 0));
+        }
+    } else {
+        CalcNumber bottom = std::max(compactLocationGraph.bottom(currentIndex), compactLocationGraph.bottom(nextIndex));
+        CalcNumber top = std::min(compactLocationGraph.top(currentIndex), compactLocationGraph.top(nextIndex));
+        if (top - bottom < 2 * externalDiameterHalfed) {
+            return false;
+        }
+        if (isLeftRight) {
+            CalcNumber x = compactLocationGraph.right(currentIndex) + externalDiameterHalfed;
+            portal = std::pair<Point, Point>(Point(x, top - externalDiameterHalfed, 0), Point(x, bottom + externalDiameterHalfed, 0));
+        } else {
+            CalcNumber x = compactLocationGraph.left(currentIndex) - externalDiameterHalfed;
+            portal = std::pair<Point, Point>(Point(x, bottom + externalDiameterHalfed, 0), Point(x, top - externalDiameterHalfed, 0));
+        }
+    }
+    
+    return true;
+    
+}
+
+/// Найти очередную точку ломаной на границе между текущим узлом пути currentNodeP и следующим узлом пути nextNodeP. Точка находится как ближайшая к последней добавленной в ломаную точке с учетом внешнего диаметра трубы.
+///
+/// \param currentNodeP Указатель на текущий узел пути.
+/// \param nextNodeP Указатель на следующий узел пути. Должен быть смежным с текущим узлом.
+/// \param lastAddedPoint Последняя добавленная в ломаную точка (единица измерения - мм.).
+/// \param externalDiameterHalfed Половина внешнего диаметра трубы (единица измерения - мм.).
+/// \param newPoint Найденная точка (единица измерения - мм.).
+///
+/// \return true, если проход между узлами достаточен для прокладки трубы, иначе false.
+bool OptimalPipeTrackFinder::calculateNextZigzagPoint(const LocationGraphNode * currentNodeP, const LocationGraphNode * nextNodeP, const Point & lastAddedPoint, CalcNumber externalDiameterHalfed, Point & newPoint) {
+    
+    std::pair<Point, Point> portal;
+    if (calculatePortal(currentNodeP, nextNodeP, externalDiameterHalfed, portal) == false) {
+        return false;
+    }
+    
+    // ближайшая к последней добавленной точке точка портала (портал параллелен одной из осей)
+    newPoint = portal.first;
+    if (portal.first.y == portal.second.y) {
+        newPoint.x = std::min(std::max(lastAddedPoint.x, std::min(portal.first.x, portal.second.x)), std::max(portal.first.x, portal.second.x));
+    } else {
+        newPoint.y = std::min(std::max(lastAddedPoint.y, std::min(portal.first.y, portal.second.y)), std::max(portal.first.y, portal.second.y));
+    }
+    
+    return true;
+    
+}
+
+/// Найти конечную точку ломаной в последнем узле пути endNodeP. Конечной точкой является ближайшая к последней добавленной в ломаную точке точка центрального отрезка прямой или фановой трубы трассы, проходящей через узел, или центр стока.
+///
+/// \param endNodeP Указатель на последний узел пути.
+/// \param lastAddedPoint Последняя добавленная в ломаную точка (единица измерения - мм.).
+/// \param pipeTrackNodesForLocationNode Словарь, в котором для каждого узла графа локации содержится массив содержащихся в нем узлов трассы.
+/// \param endPoint Найденная конечная точка (единица измерения - мм.).
+/// \param endPipeTrackNodeP Указатель на соединяемый узел трассы или nullptr, если конечной точкой является центр стока.
+///
+/// \return true, если конечная точка найдена, иначе false.
+bool OptimalPipeTrackFinder::findZigzagEndPoint(const LocationGraphNode * endNodeP, const Point & lastAddedPoint, const std::map<const LocationGraphNode*, std::vector<const PipeTrackNode*>> & pipeTrackNodesForLocationNode, Point & endPoint, const PipeTrackNode * & endPipeTrackNodeP) {
+    
     bool somePointIsFound = false;
-    Point endPoint;
-    const PipeTrackNode * resultPipeTrackNodeP = nullptr;
     CalcNumber minDistance = 999999;
+    endPipeTrackNodeP = nullptr;
+    
     // проверка существующих узлов схемы
-    for (const PipeTrackNode * pipeTrackNodeP : pipeTrackNodesForLocationNode[endNodeP]) {
+    for (const PipeTrackNode * pipeTrackNodeP : pipeTrackNodesForLocationNode.at(endNodeP)) {
         if (pipeTrackNodeP->type == direct || pipeTrackNodeP->type == fan) {
             Point nearestCenterPoint = pipeTrackNodeP->calculateNearestCenterPoint2D(lastAddedPoint); // \todo проверить логику для случая, когда источник внутри доступной области уже находится!
             if (endNodeP->left <= nearestCenterPoint.x
@@ -395,12 +1290,13 @@ std::pair<std::vector<Point>, const PipeTrackNode*> OptimalPipeTrackFinder::find
                 if (distance < minDistance) {
                     minDistance = distance;
                     endPoint = nearestCenterPoint;
-                    resultPipeTrackNodeP = pipeTrackNodeP;
+                    endPipeTrackNodeP = pipeTrackNodeP;
                     somePointIsFound = true;
                 }
             }
         }
     }
+    
     // проверка стока
     if (endNodeP->waterDestinationP != nullptr) {
         Point waterDestinationPoint = Point(endNodeP->waterDestinationP->point().x, endNodeP->waterDestinationP->point().y, 0);
@@ -408,18 +1304,12 @@ std::pair<std::vector<Point>, const PipeTrackNode*> OptimalPipeTrackFinder::find
         if (distanceToDestination < minDistance) {
             minDistance = distanceToDestination;
             endPoint = waterDestinationPoint;
-            resultPipeTrackNodeP = nullptr;
+            endPipeTrackNodeP = nullptr;
             somePointIsFound = true;
         }
     }
     
-    if (somePointIsFound) {
-        zigzag.push_back(endPoint);
-    } else {
-        zigzag.clear();
-    }
-    
-    return std::pair<std::vector<Point>, const PipeTrackNode*>(zigzag, resultPipeTrackNodeP);
+    return somePointIsFound;
     
 }
 
@@ -0,0 +1,38 @@
+#ifndef OptimalPipeTrackResult_hpp
+#define OptimalPipeTrackResult_hpp
+
+// Подключение внутренних типов
+#include "CalcNumber.hpp"
+#include "PipeTrack.hpp"
+#include "View.hpp"
+
+/// Результат вычисления оптимальной трассы системы водоотведения.
+struct OptimalPipeTrackResult {
+    
+    // MARK: - Открытые объекты
+    
+    /// Лучшая найденная трасса. Если вычисление прервано до подключения всех источников, трасса содержит только подключенные источники.
+    PipeTrack pipeTrack;
+    
+    /// Флаг завершенности вычисления. Равен false, если вычисление прервано по истечении бюджета времени или по запросу отмены.
+    bool isCompleted;
+    
+    // MARK: - Конструкторы
+    
+    /// Конструктор. Создается результат с пустой трассой.
+    ///
+    /// \param viewP Указатель на объект, отвечающий за вывод сообщений и ошибок.
+    /// \param pipeTrackIndexCellSize Размер ячейки сетки пространственного индекса узлов трассы (единица измерения - мм.).
+    explicit OptimalPipeTrackResult(View * viewP, CalcNumber pipeTrackIndexCellSize);
+    
+};
+
+// MARK: - Реализация
+
+/// Конструктор. Создается результат с пустой трассой.
+///
+/// \param viewP Указатель на объект, отвечающий за вывод сообщений и ошибок.
+/// \param pipeTrackIndexCellSize Размер ячейки сетки пространственного индекса узлов трассы (единица измерения - мм.).
+OptimalPipeTrackResult::OptimalPipeTrackResult(View * viewP, CalcNumber pipeTrackIndexCellSize): pipeTrack(viewP, pipeTrackIndexCellSize), isCompleted(false) {}
+
+#endif /* OptimalPipeTrackResult_hpp */
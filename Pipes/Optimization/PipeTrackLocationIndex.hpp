@@ -0,0 +1,110 @@
+#ifndef PipeTrackLocationIndex_hpp
+#define PipeTrackLocationIndex_hpp
+
+// Подключение стандартных библиотек
+#include <vector>
+#include <map>
+#include <algorithm>
+
+// Подключение внутренних типов
+#include "LocationGraph.hpp"
+#include "PipeTrackNode.hpp"
+
+/// Индекс инцидентности узлов трассы и узлов графа локации. Для каждого узла трассы хранит узлы локации, через которые он проходит, а для каждого узла локации - проходящие через него узлы трассы. Индекс обновляется по мере добавления и удаления узлов трассы, поэтому стоимость обновления пропорциональна числу изменившихся узлов трассы. Граф локации при использовании индекса изменяться не должен.
+struct PipeTrackLocationIndex {
+    
+    // MARK: - Открытые объекты
+    
+    /// Указатель на граф локации.
+    const LocationGraph * locationGraphP;
+    
+    /// Словарь, в котором для каждого узла трассы содержится массив узлов графа локации, через которые данный узел проходит.
+    std::map<const PipeTrackNode*, std::vector<const LocationGraphNode*>> locationNodesForPipeTrackNode;
+    
+    /// Словарь, в котором для каждого узла графа локации содержится массив содержащихся в нем узлов трассы в порядке их добавления в индекс.
+    std::map<const LocationGraphNode*, std::vector<const PipeTrackNode*>> pipeTrackNodesForLocationNode;
+    
+    // MARK: - Конструкторы
+    
+    /// Конструктор. Создается индекс для пустой трассы.
+    ///
+    /// \param locationGraphP Указатель на граф локации.
+    explicit PipeTrackLocationIndex(const LocationGraph * locationGraphP);
+    
+    // MARK: - Открытые методы
+    
+    /// Очистить индекс и заново заполнить его узлами графа локации. Индекс соответствует пустой трассе.
+    void reset();
+    
+    /// Добавить в индекс новый узел трассы. Точно проверяется пересечение данного узла только с узлами графа локации, пересекающими его ограничивающий прямоугольник, которые отбираются пространственным индексом графа локации.
+    ///
+    /// \param pipeTrackNodeP Указатель на добавляемый узел трассы. Узел не должен содержаться в индексе.
+    void addPipeTrackNode(const PipeTrackNode * pipeTrackNodeP);
+    
+    /// Удалить из индекса узел трассы. Метод должен вызываться до удаления узла из трассы.
+    ///
+    /// \param pipeTrackNodeP Указатель на удаляемый узел трассы.
+    void removePipeTrackNode(const PipeTrackNode * pipeTrackNodeP);
+    
+};
+
+// MARK: - Реализация
+
+/// Конструктор. Создается индекс для пустой трассы.
+///
+/// \param locationGraphP Указатель на граф локации.
+PipeTrackLocationIndex::PipeTrackLocationIndex(const LocationGraph * locationGraphP): locationGraphP(locationGraphP) {
+    
+    reset();
+    
+}
+
+/// Очистить индекс и заново заполнить его узлами графа локации. Индекс соответствует пустой трассе.
+void PipeTrackLocationIndex::reset() {
+    
+    locationNodesForPipeTrackNode.clear();
+    pipeTrackNodesForLocationNode.clear();
+    
+    for (const LocationGraphNode * locationNodeP : locationGraphP->nodePs) {
+        pipeTrackNodesForLocationNode[locationNodeP] = std::vector<const PipeTrackNode*>();
+    }
+    
+}
+
+/// Добавить в индекс новый узел трассы. Точно проверяется пересечение данного узла только с узлами графа локации, пересекающими его ограничивающий прямоугольник, которые отбираются пространственным индексом графа локации.
+///
+/// \param pipeTrackNodeP Указатель на добавляемый узел трассы. Узел не должен содержаться в индексе.
+void PipeTrackLocationIndex::addPipeTrackNode(const PipeTrackNode * pipeTrackNodeP) {
+    
+    std::vector<const LocationGraphNode*> & locationNodes = locationNodesForPipeTrackNode[pipeTrackNodeP];
+    
+    // узлы локации, пересекающие ограничивающий прямоугольник узла трассы, отбираются пространственным индексом графа локации
+    for (const LocationGraphNode * locationNodeP : locationGraphP->findNodePsIntersectedWithRectangle(pipeTrackNodeP->footprintLeft, pipeTrackNodeP->footprintRight, pipeTrackNodeP->footprintBottom, pipeTrackNodeP->footprintTop)) {
+        if (pipeTrackNodeP->isIntersectedWithRectangle(locationNodeP->left, locationNodeP->right, locationNodeP->bottom, locationNodeP->top)) {
+            locationNodes.push_back(locationNodeP);
+            pipeTrackNodesForLocationNode[locationNodeP].push_back(pipeTrackNodeP);
+        }
+    }
+    
+}
+
+/// Удалить из индекса узел трассы. Метод должен вызываться до удаления узла из трассы.
+///
+/// \param pipeTrackNodeP Указатель на удаляемый узел трассы.
+void PipeTrackLocationIndex::removePipeTrackNode(const PipeTrackNode * pipeTrackNodeP) {
+    
+    auto locationNodesIter = locationNodesForPipeTrackNode.find(pipeTrackNodeP);
+    if (locationNodesIter == locationNodesForPipeTrackNode.end()) {
+        return;
+    }
+    
+    for (const LocationGraphNode * locationNodeP : locationNodesIter->second) {
+        std::vector<const PipeTrackNode*> & pipeTrackNodes = pipeTrackNodesForLocationNode[locationNodeP];
+        pipeTrackNodes.erase(std::find(pipeTrackNodes.begin(), pipeTrackNodes.end(), pipeTrackNodeP));
+    }
+    
+    locationNodesForPipeTrackNode.erase(locationNodesIter);
+    
+}
+
+#endif /* PipeTrackLocationIndex_hpp */
@@ -0,0 +1,83 @@
+#ifndef PipeTrackLocationIndexTester_hpp
+#define PipeTrackLocationIndexTester_hpp
+
+// Подключение стандартных библиотек
+#include <string>
+#include <iostream>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cassert>
+
+// Подключение внутренних типов
+#include "PipeTrackLocationIndex.hpp"
+#include "LocationGraph.hpp"
+#include "OptimizationParameters.hpp"
+#include "PipeTrack.hpp"
+#include "DirectPipe.hpp"
+
+/// Тестер для класса PipeTrackLocationIndex.
+class PipeTrackLocationIndexTester {
+    
+public:
+    
+    // MARK: - Открытые методы
+    
+    /// Тестировать класс PipeTrackLocationIndex.
+    void test();
+    
+};
+
+// MARK: - Реализация
+
+/// Тестировать класс PipeTrackLocationIndex.
+void PipeTrackLocationIndexTester::test() {
+    
+    // граф локации из трех узлов, третий узел удален от трассы
+    OptimizationParameters optimizationParameters;
+    LocationGraph locationGraph(nullptr, &optimizationParameters);
+    unsigned int leftNodeId = locationGraph.addNodeAndReturnId(-100, 50, -100, 100);
+    unsigned int middleNodeId = locationGraph.addNodeAndReturnId(50, 200, -100, 100);
+    unsigned int farNodeId = locationGraph.addNodeAndReturnId(3000, 3100, -100, 100);
+    const LocationGraphNode * leftNodeP = locationGraph.nodePWithId(leftNodeId);
+    const LocationGraphNode * middleNodeP = locationGraph.nodePWithId(middleNodeId);
+    const LocationGraphNode * farNodeP = locationGraph.nodePWithId(farNodeId);
+    
+    // пустой индекс содержит все узлы локации без узлов трассы
+    PipeTrackLocationIndex pipeTrackLocationIndex { &locationGraph };
+    assert(pipeTrackLocationIndex.locationNodesForPipeTrackNode.size() == 0);
+    assert(pipeTrackLocationIndex.pipeTrackNodesForLocationNode.size() == 3);
+    
+    // узел трассы проходит через левый и средний узлы локации
+    std::map<unsigned int, unsigned int> externalDiameterForDiameter = { { 50, 54 } };
+    DirectPipe directPipe(50, 1, "Труба", 2, &externalDiameterForDiameter);
+    Point ox = Point(1, 0, 0);
+    PipeTrack pipeTrack(nullptr, optimizationParameters.locationIndexCellSize);
+    PipeTrackNode * pipeTrackNodeP = pipeTrack.createNodeAndReturnP(direct, &directPipe, Point(0, 0, 0), Point(0, 0, 0), Point(100, 0, 0), ox, ox, ox);
+    pipeTrackLocationIndex.addPipeTrackNode(pipeTrackNodeP);
+    const std::vector<const LocationGraphNode*> & locationNodes = pipeTrackLocationIndex.locationNodesForPipeTrackNode.at(pipeTrackNodeP);
+    assert(locationNodes.size() == 2);
+    assert(std::find(locationNodes.begin(), locationNodes.end(), leftNodeP) != locationNodes.end());
+    assert(std::find(locationNodes.begin(), locationNodes.end(), middleNodeP) != locationNodes.end());
+    assert(pipeTrackLocationIndex.pipeTrackNodesForLocationNode.at(leftNodeP) == std::vector<const PipeTrackNode*> { pipeTrackNodeP });
+    assert(pipeTrackLocationIndex.pipeTrackNodesForLocationNode.at(middleNodeP) == std::vector<const PipeTrackNode*> { pipeTrackNodeP });
+    assert(pipeTrackLocationIndex.pipeTrackNodesForLocationNode.at(farNodeP).size() == 0);
+    
+    // после удаления узла трассы индекс снова пустой
+    pipeTrackLocationIndex.removePipeTrackNode(pipeTrackNodeP);
+    pipeTrack.removeNode(pipeTrackNodeP);
+    assert(pipeTrackLocationIndex.locationNodesForPipeTrackNode.size() == 0);
+    assert(pipeTrackLocationIndex.pipeTrackNodesForLocationNode.size() == 3);
+    for (const auto & locationNodeAndPipeTrackNodes : pipeTrackLocationIndex.pipeTrackNodesForLocationNode) {
+        assert(locationNodeAndPipeTrackNodes.second.size() == 0);
+    }
+    
+    // повторное удаление ничего не меняет
+    pipeTrackLocationIndex.removePipeTrackNode(pipeTrackNodeP);
+    assert(pipeTrackLocationIndex.locationNodesForPipeTrackNode.size() == 0);
+    
+    std::cout << "Тестирование класса PipeTrackLocationIndex завершилось успешно.\n";
+    
+}
+
+#endif /* PipeTrackLocationIndexTester_hpp */
@@ -0,0 +1,307 @@
+#ifndef PortalFunnel_hpp
+#define PortalFunnel_hpp
+
+// Подключение стандартных библиотек
+#include <vector>
+#include <deque>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+
+// Подключение внутренних типов
+#include "CalcNumber.hpp"
+#include "Point.hpp"
+
+/// Построитель кратчайшей ломаной через последовательность порталов (алгоритм воронки, string pulling). Порталом называется отрезок в плоскости XY, который ломаная должна пересечь. Воронка хранится в деке: левая граница, вершина воронки и правая граница. Каждый конец портала добавляется в дек и удаляется из него не более одного раза, поэтому время работы линейно относительно числа порталов.
+class PortalFunnel {
+    
+public:
+    
+    // MARK: - Открытые статические методы
+    
+    /// Найти кратчайшую ломаную от точки startPoint до точки endPoint, последовательно проходящую через порталы portals. Вершины ломаной, кроме первой и последней, являются концами порталов. Координата z не учитывается и в результате равна 0.
+    ///
+    /// \param startPoint Начальная точка ломаной.
+    /// \param portals Массив порталов. Каждый портал задается парой (левый конец, правый конец) относительно направления движения от startPoint к endPoint.
+    /// \param endPoint Конечная точка ломаной.
+    ///
+    /// \return Вершины ломаной, начиная с startPoint и заканчивая endPoint.
+    static std::vector<Point> findShortestPolyline(const Point & startPoint, const std::vector<std::pair<Point, Point>> & portals, const Point & endPoint);
+    
+    /// Вычислить длину ломаной как сумму длин ее звеньев. Этой же длиной ранжируются ломаные найденных путей.
+    ///
+    /// \param polyline Вершины ломаной.
+    ///
+    /// \return Длина ломаной.
+    static CalcNumber calculatePolylineLength(const std::vector<Point> & polyline);
+    
+    /// Вычислить расстояние в плоскости XY от точки до портала. Портал должен быть параллелен одной из осей координат.
+    ///
+    /// \param point Точка.
+    /// \param portal Портал.
+    ///
+    /// \return Расстояние от точки до ближайшей точки портала.
+    static CalcNumber calculateDistanceToPortal(const Point & point, const std::pair<Point, Point> & portal);
+    
+    /// Вычислить расстояние в плоскости XY между двумя порталами. Порталы должны быть параллельны осям координат. Расстояние используется для нижней оценки длины ломаной, последовательно проходящей через порталы: участок ломаной между двумя соседними порталами не короче расстояния между ними.
+    ///
+    /// \param portal1 Первый портал.
+    /// \param portal2 Второй портал.
+    ///
+    /// \return Расстояние между ближайшими точками порталов.
+    static CalcNumber calculatePortalsDistance(const std::pair<Point, Point> & portal1, const std::pair<Point, Point> & portal2);
+    
+    /// Вычислить середину портала.
+    ///
+    /// \param portal Портал.
+    ///
+    /// \return Середина портала.
+    static Point calculatePortalMiddle(const std::pair<Point, Point> & portal);
+    
+    /// Вычислить нижнюю оценку длины ломаной от точки startPoint до последнего из порталов portals, последовательно проходящей через порталы. Ломаная доходит до последнего портала не раньше, чем до предпоследнего, и не короче отрезка до него от начальной точки.
+    ///
+    /// \param startPoint Начальная точка ломаной.
+    /// \param portals Массив порталов. Массив должен быть непустым.
+    /// \param previousLengthLowerBound Нижняя оценка длины ломаной до предпоследнего портала. Не учитывается, если портал один.
+    ///
+    /// \return Нижняя оценка длины ломаной до последнего портала.
+    static CalcNumber calculateLengthToLastPortalLowerBound(const Point & startPoint, const std::vector<std::pair<Point, Point>> & portals, CalcNumber previousLengthLowerBound);
+    
+    /// Вычислить нижнюю оценку длины ломаной, проходящей через портал portal и заканчивающейся в некоторой точке. Ломаная пересекает портал не далее половины его длины от середины портала.
+    ///
+    /// \param portal Портал.
+    /// \param lengthToPortalLowerBound Нижняя оценка длины ломаной до портала.
+    /// \param middleDistanceLowerBound Нижняя оценка расстояния от середины портала до конечной точки ломаной.
+    ///
+    /// \return Нижняя оценка длины ломаной.
+    static CalcNumber calculateLengthLowerBound(const std::pair<Point, Point> & portal, CalcNumber lengthToPortalLowerBound, CalcNumber middleDistanceLowerBound);
+    
+private:
+    
+    // MARK: - Скрытые статические методы
+    
+    /// Вычислить удвоенную ориентированную площадь треугольника (apex, a, b) в плоскости XY.
+    ///
+    /// \param apex Первая вершина треугольника.
+    /// \param a Вторая вершина треугольника.
+    /// \param b Третья вершина треугольника.
+    ///
+    /// \return Положительное значение, если точка b лежит слева от луча apex -> a, отрицательное - если справа, 0 - если на прямой.
+    static CalcNumber calculateDoubledSignedArea(const Point & apex, const Point & a, const Point & b);
+    
+    /// Проверить, переходит ли точка point через сторону воронки apex -> sidePoint. Точка, лежащая на прямой стороны, переходит через нее, только если лежит дальше точки sidePoint.
+    ///
+    /// \param apex Вершина воронки.
+    /// \param sidePoint Конец стороны воронки.
+    /// \param point Проверяемая точка.
+    /// \param sign 1 для левой стороны воронки, -1 для правой.
+    ///
+    /// \return true, если точка переходит через сторону воронки, иначе false.
+    static bool isBeyondFunnelSide(const Point & apex, const Point & sidePoint, const Point & point, int sign);
+    
+};
+
+// MARK: - Реализация
+
+/// Найти кратчайшую ломаную от точки startPoint до точки endPoint, последовательно проходящую через порталы portals. Вершины ломаной, кроме первой и последней, являются концами порталов. Координата z не учитывается и в результате равна 0.
+///
+/// \param startPoint Начальная точка ломаной.
+/// \param portals Массив порталов. Каждый портал задается парой (левый конец, правый конец) относительно направления движения от startPoint к endPoint.
+/// \param endPoint Конечная точка ломаной.
+///
+/// \return Вершины ломаной, начиная с startPoint и заканчивая endPoint.
+std::vector<Point> PortalFunnel::findShortestPolyline(const Point & startPoint, const std::vector<std::pair<Point, Point>> & portals, const Point & endPoint) {
+    
+    std::vector<Point> polyline { Point(startPoint.x, startPoint.y, 0) };
+    
+    // воронка: левая граница от конца к вершине, вершина воронки с индексом apexIndex, правая граница от вершины к концу; звенья левой границы поворачивают налево, правой - направо
+    std::deque<Point> funnel { polyline[0] };
+    int apexIndex = 0;
+    
+    // добавление точки к правой границе воронки
+    auto addRightPoint = [&](const Point & point) {
+        if (funnel.back() == point) {
+            return;
+        }
+        // удаление звеньев правой границы, которые точка делает невыпуклыми
+        while (apexIndex < funnel.size() - 1 && calculateDoubledSignedArea(funnel[funnel.size() - 2], funnel.back(), point) >= 0) {
+            funnel.pop_back();
+        }
+        // правая граница перешла через левую - вершина воронки перемещается по левой границе
+        if (apexIndex == funnel.size() - 1) {
+            while (apexIndex > 0 && isBeyondFunnelSide(funnel[apexIndex], funnel[apexIndex - 1], point, 1)) {
+                funnel.pop_back();
+                apexIndex--;
+                if (polyline[polyline.size() - 1] != funnel[apexIndex]) {
+                    polyline.push_back(funnel[apexIndex]);
+                }
+            }
+        }
+        if (funnel.back() != point) {
+            funnel.push_back(point);
+        }
+    };
+    
+    // добавление точки к левой границе воронки
+    auto addLeftPoint = [&](const Point & point) {
+        if (funnel.front() == point) {
+            return;
+        }
+        // удаление звеньев левой границы, которые точка делает невыпуклыми
+        while (apexIndex > 0 && calculateDoubledSignedArea(funnel[1], funnel.front(), point) <= 0) {
+            funnel.pop_front();
+            apexIndex--;
+        }
+        // левая граница перешла через правую - вершина воронки перемещается по правой границе
+        if (apexIndex == 0) {
+            while (funnel.size() > 1 && isBeyondFunnelSide(funnel[0], funnel[1], point, -1)) {
+                funnel.pop_front();
+                if (polyline[polyline.size() - 1] != funnel.front()) {
+                    polyline.push_back(funnel.front());
+                }
+            }
+        }
+        if (funnel.front() != point) {
+            funnel.push_front(point);
+            apexIndex++;
+        }
+    };
+    
+    for (const std::pair<Point, Point> & portal : portals) {
+        addRightPoint(Point(portal.second.x, portal.second.y, 0));
+        addLeftPoint(Point(portal.first.x, portal.first.y, 0));
+    }
+    
+    // конечная точка добавляется к правой границе, кратчайшая ломаная от вершины воронки до нее проходит по правой границе
+    addRightPoint(Point(endPoint.x, endPoint.y, 0));
+    for (int i = apexIndex + 1; i < funnel.size(); i++) {
+        if (polyline[polyline.size() - 1] != funnel[i]) {
+            polyline.push_back(funnel[i]);
+        }
+    }
+    
+    return polyline;
+    
+}
+
+/// Вычислить длину ломаной как сумму длин ее звеньев. Этой же длиной ранжируются ломаные найденных путей.
+///
+/// \param polyline Вершины ломаной.
+///
+/// \return Длина ломаной.
+CalcNumber PortalFunnel::calculatePolylineLength(const std::vector<Point> & polyline) {
+    
+    CalcNumber length = 0;
+    for (int i = 1; i < polyline.size(); i++) {
+        length += (polyline[i] - polyline[i - 1]).length();
+    }
+    
+    return length;
+    
+}
+
+/// Вычислить расстояние в плоскости XY от точки до портала. Портал должен быть параллелен одной из осей координат.
+///
+/// \param point Точка.
+/// \param portal Портал.
+///
+/// \return Расстояние от точки до ближайшей точки портала.
+CalcNumber PortalFunnel::calculateDistanceToPortal(const Point & point, const std::pair<Point, Point> & portal) {
+    
+    return calculatePortalsDistance(std::pair<Point, Point>(point, point), portal);
+    
+}
+
+/// Вычислить расстояние в плоскости XY между двумя порталами. Порталы должны быть параллельны осям координат. Расстояние используется для нижней оценки длины ломаной, последовательно проходящей через порталы: участок ломаной между двумя соседними порталами не короче расстояния между ними.
+///
+/// \param portal1 Первый портал.
+/// \param portal2 Второй портал.
+///
+/// \return Расстояние между ближайшими точками порталов.
+CalcNumber PortalFunnel::calculatePortalsDistance(const std::pair<Point, Point> & portal1, const std::pair<Point, Point> & portal2) {
+    
+    // для отрезков, параллельных осям, расстояние равно расстоянию между их ограничивающими прямоугольниками
+    CalcNumber dx = std::max<CalcNumber>(0, std::max(std::min(portal1.first.x, portal1.second.x), std::min(portal2.first.x, portal2.second.x)) - std::min(std::max(portal1.first.x, portal1.second.x), std::max(portal2.first.x, portal2.second.x)));
+    CalcNumber dy = std::max<CalcNumber>(0, std::max(std::min(portal1.first.y, portal1.second.y), std::min(portal2.first.y, portal2.second.y)) - std::min(std::max(portal1.first.y, portal1.second.y), std::max(portal2.first.y, portal2.second.y)));
+    
+    return std::sqrt(dx * dx + dy * dy);
+    
+}
+
+/// Вычислить середину портала.
+///
+/// \param portal Портал.
+///
+/// \return Середина портала.
+Point PortalFunnel::calculatePortalMiddle(const std::pair<Point, Point> & portal) {
+    
+    return (portal.first + portal.second) / 2;
+    
+}
+
+/// Вычислить нижнюю оценку длины ломаной от точки startPoint до последнего из порталов portals, последовательно проходящей через порталы. Ломаная доходит до последнего портала не раньше, чем до предпоследнего, и не короче отрезка до него от начальной точки.
+///
+/// \param startPoint Начальная точка ломаной.
+/// \param portals Массив порталов. Массив должен быть непустым.
+/// \param previousLengthLowerBound Нижняя оценка длины ломаной до предпоследнего портала. Не учитывается, если портал один.
+///
+/// \return Нижняя оценка длины ломаной до последнего портала.
+CalcNumber PortalFunnel::calculateLengthToLastPortalLowerBound(const Point & startPoint, const std::vector<std::pair<Point, Point>> & portals, CalcNumber previousLengthLowerBound) {
+    
+    CalcNumber lengthLowerBound = calculateDistanceToPortal(startPoint, portals[portals.size() - 1]);
+    if (portals.size() > 1) {
+        lengthLowerBound = std::max(lengthLowerBound, previousLengthLowerBound + calculatePortalsDistance(portals[portals.size() - 2], portals[portals.size() - 1]));
+    }
+    
+    return lengthLowerBound;
+    
+}
+
+/// Вычислить нижнюю оценку длины ломаной, проходящей через портал portal и заканчивающейся в некоторой точке. Ломаная пересекает портал не далее половины его длины от середины портала.
+///
+/// \param portal Портал.
+/// \param lengthToPortalLowerBound Нижняя оценка длины ломаной до портала.
+/// \param middleDistanceLowerBound Нижняя оценка расстояния от середины портала до конечной точки ломаной.
+///
+/// \return Нижняя оценка длины ломаной.
+CalcNumber PortalFunnel::calculateLengthLowerBound(const std::pair<Point, Point> & portal, CalcNumber lengthToPortalLowerBound, CalcNumber middleDistanceLowerBound) {
+    
+    CalcNumber portalLengthHalfed = (portal.second - portal.first).length() / 2;
+    
+    return lengthToPortalLowerBound + std::max<CalcNumber>(0, middleDistanceLowerBound - portalLengthHalfed);
+    
+}
+
+/// Вычислить удвоенную ориентированную площадь треугольника (apex, a, b) в плоскости XY.
+///
+/// \param apex Первая вершина треугольника.
+/// \param a Вторая вершина треугольника.
+/// \param b Третья вершина треугольника.
+///
+/// \return Положительное значение, если точка b лежит слева от луча apex -> a, отрицательное - если справа, 0 - если на прямой.
+CalcNumber PortalFunnel::calculateDoubledSignedArea(const Point & apex, const Point & a, const Point & b) {
+    
+    return (a.x - apex.x) * (b.y - apex.y) - (a.y - apex.y) * (b.x - apex.x);
+    
+}
+
+/// Проверить, переходит ли точка point через сторону воронки apex -> sidePoint. Точка, лежащая на прямой стороны, переходит через нее, только если лежит дальше точки sidePoint.
+///
+/// \param apex Вершина воронки.
+/// \param sidePoint Конец стороны воронки.
+/// \param point Проверяемая точка.
+/// \param sign 1 для левой стороны воронки, -1 для правой.
+///
+/// \return true, если точка переходит через сторону воронки, иначе false.
+bool PortalFunnel::isBeyondFunnelSide(const Point & apex, const Point & sidePoint, const Point & point, int sign) {
+    
+    CalcNumber doubledSignedArea = sign * calculateDoubledSignedArea(apex, sidePoint, point);
+    if (doubledSignedArea != 0) {
+        return doubledSignedArea > 0;
+    }
+    
+    return (point.x - sidePoint.x) * (sidePoint.x - apex.x) + (point.y - sidePoint.y) * (sidePoint.y - apex.y) > 0;
+    
+}
+
+#endif /* PortalFunnel_hpp */
\ No newline at end of file
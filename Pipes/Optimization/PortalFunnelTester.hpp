@@ -0,0 +1,120 @@
+#ifndef PortalFunnelTester_hpp
+#define PortalFunnelTester_hpp
+
+// Подключение стандартных библиотек
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <cassert>
+#include <cmath>
+
+// Подключение внутренних типов
+#include "PortalFunnel.hpp"
+
+/// Тестер для класса PortalFunnel.
+class PortalFunnelTester {
+    
+public:
+    
+    // MARK: - Открытые методы
+    
+    /// Тестировать класс PortalFunnel.
+    void test();
+    
+};
+
+// MARK: - Реализация
+
+/// Тестировать класс PortalFunnel.
+void PortalFunnelTester::test() {
+    
+    // без порталов - отрезок
+    std::vector<Point> polyline = PortalFunnel::findShortestPolyline(Point(0, 0, 0), {}, Point(10, 5, 0));
+    assert(polyline.size() == 2);
+    assert(polyline[0] == Point(0, 0, 0));
+    assert(polyline[1] == Point(10, 5, 0));
+    
+    // порталы, не мешающие прямой, - отрезок
+    polyline = PortalFunnel::findShortestPolyline(Point(0, 0, 0), { { Point(5, 10, 0), Point(5, -10, 0) } }, Point(10, 0, 0));
+    assert(polyline.size() == 2);
+    assert(polyline[1] == Point(10, 0, 0));
+    
+    // обход угла: движение вправо, затем вверх
+    polyline = PortalFunnel::findShortestPolyline(Point(0, 0, 0), { { Point(10, 2, 0), Point(10, -2, 0) }, { Point(10, 2, 0), Point(14, 2, 0) } }, Point(12, 10, 0));
+    assert(polyline.size() == 3);
+    assert(polyline[0] == Point(0, 0, 0));
+    assert(polyline[1] == Point(10, 2, 0));
+    assert(polyline[2] == Point(12, 10, 0));
+    
+    // обход угла справа: движение вправо, затем вниз
+    polyline = PortalFunnel::findShortestPolyline(Point(0, 0, 0), { { Point(10, 2, 0), Point(10, -2, 0) }, { Point(14, -2, 0), Point(10, -2, 0) } }, Point(12, -10, 0));
+    assert(polyline.size() == 3);
+    assert(polyline[1] == Point(10, -2, 0));
+    
+    // змейка: обход двух углов в разные стороны
+    polyline = PortalFunnel::findShortestPolyline(Point(0, 0, 0), { { Point(5, 10, 0), Point(5, 8, 0) }, { Point(10, -8, 0), Point(10, -10, 0) } }, Point(15, 0, 0));
+    assert(polyline.size() == 4);
+    assert(polyline[1] == Point(5, 8, 0));
+    assert(polyline[2] == Point(10, -8, 0));
+    assert(polyline[3] == Point(15, 0, 0));
+    
+    // разворот вокруг стенки нулевой толщины: вниз вдоль x = 7, затем вверх по другую сторону стенки
+    polyline = PortalFunnel::findShortestPolyline(Point(1, 1, 0), { { Point(5, 5, 0), Point(5, 2, 0) }, { Point(8, 2, 0), Point(7, 2, 0) }, { Point(8, -4, 0), Point(7, -4, 0) }, { Point(8, -9, 0), Point(7, -9, 0) }, { Point(7, -10, 0), Point(7, -9, 0) }, { Point(6, -6, 0), Point(7, -6, 0) }, { Point(6, -6, 0), Point(6, -3, 0) } }, Point(3, -4, 0));
+    assert(polyline.size() == 6);
+    assert(polyline[1] == Point(5, 2, 0));
+    assert(polyline[2] == Point(7, 2, 0));
+    assert(polyline[3] == Point(7, -9, 0));
+    assert(polyline[4] == Point(6, -6, 0));
+    assert(polyline[5] == Point(3, -4, 0));
+    
+    // совпадающие начальная и конечная точки
+    polyline = PortalFunnel::findShortestPolyline(Point(3, 3, 0), {}, Point(3, 3, 0));
+    assert(polyline.size() == 1);
+    
+    // длина ломаной и расстояния до порталов
+    assert(PortalFunnel::calculatePolylineLength({ Point(0, 0, 0), Point(3, 4, 0), Point(3, 10, 0) }) == 11);
+    assert(PortalFunnel::calculatePolylineLength({ Point(3, 3, 0) }) == 0);
+    assert(PortalFunnel::calculateDistanceToPortal(Point(0, 0, 0), { Point(3, 10, 0), Point(3, 4, 0) }) == 5);
+    assert(PortalFunnel::calculateDistanceToPortal(Point(3, 5, 0), { Point(3, 10, 0), Point(3, 4, 0) }) == 0);
+    assert(PortalFunnel::calculatePortalsDistance({ Point(0, 10, 0), Point(0, 0, 0) }, { Point(3, 14, 0), Point(10, 14, 0) }) == 5);
+    assert(PortalFunnel::calculatePortalsDistance({ Point(0, 10, 0), Point(0, 0, 0) }, { Point(-5, 5, 0), Point(5, 5, 0) }) == 0);
+    assert(PortalFunnel::calculatePortalMiddle({ Point(0, 10, 0), Point(0, 0, 0) }) == Point(0, 5, 0));
+    
+    // нижние оценки длины ломаной: до портала - не меньше расстояния до него от начальной точки и суммы оценки до предыдущего портала с расстоянием между порталами, до конечной точки - с учетом половины длины портала
+    assert(PortalFunnel::calculateLengthToLastPortalLowerBound(Point(0, 0, 0), { { Point(3, 10, 0), Point(3, 4, 0) } }, 100) == 5);
+    assert(PortalFunnel::calculateLengthToLastPortalLowerBound(Point(0, 0, 0), { { Point(0, 10, 0), Point(0, 0, 0) }, { Point(3, 14, 0), Point(10, 14, 0) } }, 20) == 25);
+    assert(PortalFunnel::calculateLengthToLastPortalLowerBound(Point(0, 0, 0), { { Point(0, 10, 0), Point(0, 0, 0) }, { Point(3, 14, 0), Point(10, 14, 0) } }, 0) == std::sqrt(static_cast<CalcNumber>(205)));
+    assert(PortalFunnel::calculateLengthLowerBound({ Point(0, 10, 0), Point(0, 0, 0) }, 7, 8) == 10);
+    assert(PortalFunnel::calculateLengthLowerBound({ Point(0, 10, 0), Point(0, 0, 0) }, 7, 3) == 7);
+    
+    // спрямленная ломаная короче по другому пути, чем жадная: путь B длиннее пути A по жадной ломаной, но короче после спрямления
+    Point startPoint = Point(0, 0, 0);
+    Point endPoint = Point(100, 100, 0);
+    std::vector<std::pair<Point, Point>> portalsA { { Point(50, -13, 0), Point(50, -20, 0) } };
+    std::vector<std::pair<Point, Point>> portalsB { { Point(10, 100, 0), Point(10, 0, 0) }, { Point(20, 100, 0), Point(20, 90, 0) } };
+    CalcNumber zigzagLengthA = PortalFunnel::calculatePolylineLength({ startPoint, Point(50, -13, 0), endPoint });
+    CalcNumber zigzagLengthB = PortalFunnel::calculatePolylineLength({ startPoint, Point(10, 0, 0), Point(20, 90, 0), endPoint });
+    CalcNumber shortestLengthA = PortalFunnel::calculatePolylineLength(PortalFunnel::findShortestPolyline(startPoint, portalsA, endPoint));
+    CalcNumber shortestLengthB = PortalFunnel::calculatePolylineLength(PortalFunnel::findShortestPolyline(startPoint, portalsB, endPoint));
+    assert(zigzagLengthA < zigzagLengthB);
+    assert(shortestLengthB < shortestLengthA);
+    
+    // нижние оценки метода ветвей и границ для префиксов пути B не превосходят спрямленной длины пути B, поэтому путь B не отсекается после достройки пути A
+    CalcNumber lengthLowerBound = 0;
+    std::vector<std::pair<Point, Point>> prefixPortalsB;
+    for (const std::pair<Point, Point> & portal : portalsB) {
+        prefixPortalsB.push_back(portal);
+        lengthLowerBound = PortalFunnel::calculateLengthToLastPortalLowerBound(startPoint, prefixPortalsB, lengthLowerBound);
+        CalcNumber lowerBound = PortalFunnel::calculateLengthLowerBound(portal, lengthLowerBound, (endPoint - PortalFunnel::calculatePortalMiddle(portal)).length());
+        assert(lowerBound <= shortestLengthB);
+        assert(lowerBound < shortestLengthA);
+    }
+    
+    // оценка по жадной ломаной отсекла бы путь B после достройки пути A
+    assert(PortalFunnel::calculatePolylineLength({ startPoint, Point(10, 0, 0), Point(20, 90, 0) }) + (endPoint - Point(20, 90, 0)).length() > zigzagLengthA);
+    
+    std::cout << "Тестирование класса PortalFunnel завершилось успешно.\n";
+    
+}
+
+#endif /* PortalFunnelTester_hpp */
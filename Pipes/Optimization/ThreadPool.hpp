@@ -0,0 +1,234 @@
+#ifndef ThreadPool_hpp
+#define ThreadPool_hpp
+
+// Подключение стандартных библиотек
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+
+/// Пул потоков для параллельного выполнения однотипных задач, пронумерованных от 0. Вызывающий поток участвует в выполнении задач. Вызов из потока, уже выполняющего задачу некоторого пула, выполняется последовательно в этом потоке.
+class ThreadPool {
+    
+    // MARK: - Скрытые объекты
+    
+    /// Рабочие потоки.
+    std::vector<std::thread> threads;
+    
+    /// Мьютекс, защищающий состояние пула.
+    std::mutex mutex;
+    
+    /// Условная переменная для ожидания рабочими потоками новой серии задач.
+    std::condition_variable taskCondition;
+    
+    /// Условная переменная для ожидания вызывающим потоком завершения серии задач.
+    std::condition_variable finishCondition;
+    
+    /// Функция, выполняемая для каждого номера задачи текущей серии.
+    const std::function<void(unsigned int)> * taskFunctionP = nullptr;
+    
+    /// Число задач текущей серии.
+    unsigned int tasksCount = 0;
+    
+    /// Номер следующей невыполненной задачи текущей серии.
+    std::atomic<unsigned int> nextTaskIndex { 0 };
+    
+    /// Число рабочих потоков, участвующих в выполнении текущей серии.
+    unsigned int busyThreadsCount = 0;
+    
+    /// Номер текущей серии задач.
+    unsigned long seriesNumber = 0;
+    
+    /// Флаг остановки пула.
+    bool isStopping = false;
+    
+    /// Первое исключение, брошенное при выполнении задач текущей серии.
+    std::exception_ptr exceptionP;
+    
+    /// Флаг выполнения текущим потоком задачи некоторого пула.
+    static thread_local bool isInsideTask;
+    
+public:
+    
+    // MARK: - Конструкторы
+    
+    /// Конструктор.
+    ///
+    /// \param threadsCount Общее число потоков, выполняющих задачи, с учетом вызывающего потока. Если равно 0, используется число аппаратных потоков.
+    explicit ThreadPool(unsigned int threadsCount);
+    
+    /// Деструктор. Дожидается завершения рабочих потоков.
+    ~ThreadPool();
+    
+    /// Конструктор копирования. Копирование пула потоков запрещено.
+    ThreadPool(const ThreadPool &) = delete;
+    
+    // MARK: - Открытые методы
+    
+    /// Оператор копирования. Копирование пула потоков запрещено.
+    ThreadPool & operator=(const ThreadPool &) = delete;
+    
+    /// Выполнить функцию function для каждого номера задачи от 0 до tasksCount - 1 и дождаться завершения всех задач. Порядок выполнения задач не определен. Если некоторая задача бросила исключение, первое из брошенных исключений перебрасывается после завершения всех задач.
+    ///
+    /// \param tasksCount Число задач.
+    /// \param function Функция, принимающая номер задачи.
+    void runForEachIndex(unsigned int tasksCount, const std::function<void(unsigned int)> & function);
+    
+    /// Вернуть общее число потоков, выполняющих задачи, с учетом вызывающего потока.
+    ///
+    /// \return Число потоков.
+    unsigned int threadsCount() const;
+    
+private:
+    
+    // MARK: - Скрытые методы
+    
+    /// Основной цикл рабочего потока.
+    void runWorker();
+    
+    /// Выполнять задачи текущей серии, пока они не закончатся.
+    void runTasksOfCurrentSeries();
+    
+};
+
+// MARK: - Реализация
+
+/// Флаг выполнения текущим потоком задачи некоторого пула.
+thread_local bool ThreadPool::isInsideTask = false;
+
+/// Конструктор.
+///
+/// \param threadsCount Общее число потоков, выполняющих задачи, с учетом вызывающего потока. Если равно 0, используется число аппаратных потоков.
+ThreadPool::ThreadPool(unsigned int threadsCount) {
+    
+    if (threadsCount == 0) {
+        threadsCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    
+    for (unsigned int i = 1; i < threadsCount; i++) {
+        threads.push_back(std::thread(&ThreadPool::runWorker, this));
+    }
+    
+}
+
+/// Деструктор. Дожидается завершения рабочих потоков.
+ThreadPool::~ThreadPool() {
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isStopping = true;
+    }
+    taskCondition.notify_all();
+    
+    for (std::thread & thread : threads) {
+        thread.join();
+    }
+    
+}
+
+/// Выполнить функцию function для каждого номера задачи от 0 до tasksCount - 1 и дождаться завершения всех задач. Порядок выполнения задач не определен. Если некоторая задача бросила исключение, первое из брошенных исключений перебрасывается после завершения всех задач.
+///
+/// \param tasksCount Число задач.
+/// \param function Функция, принимающая номер задачи.
+void ThreadPool::runForEachIndex(unsigned int tasksCount, const std::function<void(unsigned int)> & function) {
+    
+    if (tasksCount == 0) {
+        return;
+    }
+    
+    // вложенный вызов или пул без рабочих потоков - последовательное выполнение
+    if (isInsideTask || threads.size() == 0 || tasksCount == 1) {
+        for (unsigned int i = 0; i < tasksCount; i++) {
+            function(i);
+        }
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        taskFunctionP = &function;
+        this->tasksCount = tasksCount;
+        nextTaskIndex = 0;
+        exceptionP = nullptr;
+        busyThreadsCount = static_cast<unsigned int>(threads.size());
+        seriesNumber++;
+    }
+    taskCondition.notify_all();
+    
+    runTasksOfCurrentSeries();
+    
+    std::unique_lock<std::mutex> lock(mutex);
+    finishCondition.wait(lock, [this] { return busyThreadsCount == 0; });
+    taskFunctionP = nullptr;
+    
+    if (exceptionP != nullptr) {
+        std::exception_ptr thrownExceptionP = exceptionP;
+        exceptionP = nullptr;
+        std::rethrow_exception(thrownExceptionP);
+    }
+    
+}
+
+/// Вернуть общее число потоков, выполняющих задачи, с учетом вызывающего потока.
+///
+/// \return Число потоков.
+unsigned int ThreadPool::threadsCount() const {
+    
+    return static_cast<unsigned int>(threads.size()) + 1;
+    
+}
+
+/// Основной цикл рабочего потока.
+void ThreadPool::runWorker() {
+    
+    unsigned long processedSeriesNumber = 0;
+    
+    while (true) {
+        
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            taskCondition.wait(lock, [this, processedSeriesNumber] { return isStopping || seriesNumber != processedSeriesNumber; });
+            if (isStopping) {
+                return;
+            }
+            processedSeriesNumber = seriesNumber;
+        }
+        
+        runTasksOfCurrentSeries();
+        
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            busyThreadsCount--;
+        }
+        finishCondition.notify_one();
+        
+    }
+    
+}
+
+/// Выполнять задачи текущей серии, пока они не закончатся.
+void ThreadPool::runTasksOfCurrentSeries() {
+    
+    isInsideTask = true;
+    
+    for (unsigned int i = nextTaskIndex++; i < tasksCount; i = nextTaskIndex++) {
+        try {
+            (*taskFunctionP)(i);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (exceptionP == nullptr) {
+                exceptionP = std::current_exception();
+            }
+        }
+    }
+    
+    isInsideTask = false;
+    
+}
+
+#endif /* ThreadPool_hpp */
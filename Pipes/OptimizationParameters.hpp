@@ -3,10 +3,38 @@
 
 // Подключение внутренних типов
 #include "CalcNumber.hpp"
+#include "CancellationToken.hpp"
 
 /// Параметры алгоритма оптимизации.
 struct OptimizationParameters {
     
+    // MARK: - Вспомогательные типы
+    
+    /// Режим поиска путей в графе локации от подключаемого источника до трассы.
+    enum PathSearchMode {
+        
+        /// Полный перебор всех простых путей с последующей оценкой каждого из них.
+        exhaustiveSearch,
+        
+        /// Поиск по первому наилучшему (алгоритм Дейкстры), стоимостью пути является псевдодлина ломаной. Поиск приближенный: каждому узлу соответствует одна метка с единственной точкой входа ломаной, тогда как продолжение ломаной зависит от этой точки. Поэтому путь, входящий в узел по большей псевдодлине, но в более выгодной точке, отбрасывается, и найденный путь может быть длиннее найденного полным перебором. Время поиска полиномиально по числу узлов.
+        bestFirstSearch,
+        
+        /// Поиск ограниченного числа путей наименьшей псевдодлины (алгоритм Йена). Найденные пути предлагаются в качестве альтернатив при принятии решений.
+        kShortestPathsSearch
+        
+    };
+    
+    /// Режим построения трассы.
+    enum EngineMode {
+        
+        /// Последовательное подключение источников в наилучшем из рассмотренных порядков (см. sourceOrdersCount).
+        sequentialEngine,
+        
+        /// Приближенное построение дерева Штейнера с терминалами в точках входа источников и стоке (эвристика кратчайших путей Такахаши-Мацуямы). На каждом шаге к дереву подключается источник, ломаная подключения которого имеет наименьшую псевдодлину.
+        steinerTreeEngine
+        
+    };
+    
     // MARK: - Открытые объекты
     
     /// Минимально расстояние между точками входа разделяемых источников (единица измерения - мм.).
@@ -15,6 +43,36 @@ struct OptimizationParameters {
     /// Максимальная ширина сечения при разделении узлов (единица измерения - мм.).
     CalcNumber maxNodeWidthToSeparate = 150;
     
+    /// Размер ячейки сетки пространственных индексов узлов графа локации и узлов трассы (единица измерения - мм.). Рекомендуется выбирать порядка типичного размера узла графа локации.
+    CalcNumber locationIndexCellSize = 1000;
+    
+    /// Режим построения трассы.
+    EngineMode engineMode = sequentialEngine;
+    
+    /// Режим поиска путей в графе локации от подключаемого источника до трассы. По умолчанию используется приближенный режим bestFirstSearch: полный перебор растет экспоненциально с числом узлов и не завершается на многоэтажных локациях из сотен помещений, а найденный приближенный путь всегда является допустимым. Для небольших локаций и для проверки качества приближения следует использовать режим exhaustiveSearch.
+    PathSearchMode pathSearchMode = bestFirstSearch;
+    
+    /// Флаг использования иерархии зон графа локации в режиме bestFirstSearch. Если равен true, путь сначала находится грубым поиском по порталам между зонами, а точный поиск выполняется только в коридоре найденных зон (при неудаче - по всему графу). Ускоряет поиск в больших локациях, однако найденный путь может отличаться от пути, найденного без иерархии.
+    bool zoneHierarchyIsUsed = false;
+    
+    /// Размер ячейки сетки, по которой узлы графа локации группируются в зоны (единица измерения - мм.). Рекомендуется выбирать порядка размера помещения.
+    CalcNumber zoneSize = 10000;
+    
+    /// Число путей-кандидатов, находимых для каждого подключаемого источника в режиме kShortestPathsSearch.
+    unsigned int candidatePathsCount = 3;
+    
+    /// Число потоков, используемых при оценке путей-кандидатов и порядков подключения источников, с учетом основного потока. Если равно 0, используется число аппаратных потоков.
+    unsigned int threadsCount = 0;
+    
+    /// Число рассматриваемых порядков подключения источников в режиме sequentialEngine. Первым строится трасса для порядка уменьшения диаметров, остальные порядки выбираются случайно и рассматриваются, пока не исчерпан бюджет времени. По умолчанию равно 1 - рассматривается только порядок уменьшения диаметров. Каждый дополнительный порядок требует полного построения трассы, а выбранная трасса может отличаться от трассы для порядка уменьшения диаметров.
+    unsigned int sourceOrdersCount = 1;
+    
+    /// Бюджет времени вычисления оптимальной трассы (единица измерения - мс.). По его истечении вычисление прерывается и возвращается лучшая найденная трасса. Если равен 0, время не ограничено.
+    unsigned long timeBudgetMilliseconds = 0;
+    
+    /// Указатель на признак отмены вычисления оптимальной трассы или nullptr. Отмена может быть запрошена из другого потока, после чего возвращается лучшая найденная трасса.
+    CancellationToken * cancellationTokenP = nullptr;
+    
     // MARK: - Конструкторы
     
     /// Конструктор по умолчанию. Параметры инициализируются значениями по умолчанию.
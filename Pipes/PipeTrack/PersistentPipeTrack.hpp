@@ -0,0 +1,484 @@
+#ifndef PersistentPipeTrack_hpp
+#define PersistentPipeTrack_hpp
+
+// Подключение стандартных библиотек
+#include <vector>
+#include <map>
+#include <set>
+#include <memory>
+#include <limits>
+
+// Подключение внутренних типов
+#include "PipeTrackNode.hpp"
+#include "PipeTrack.hpp"
+
+/// Персистентная трасса системы водоотведения. Предназначена для перебора вариантов трассы (например, при поиске с несколькими частичными трассами). Трасса хранится цепочкой слоев: каждый слой содержит только узлы, добавленные или измененные после ответвления, и идентификаторы удаленных узлов, а остальные узлы берутся из родительских слоев. Ответвление трассы - это копирование объекта без копирования узлов; слой, общий для нескольких трасс, не изменяется, и при первом изменении ответвления над ним создается новый слой. Узлы трассы неизменяемы и совместно используются всеми ответвлениями, а связи между узлами задаются идентификаторами.
+struct PersistentPipeTrack {
+    
+    // MARK: - Вспомогательные типы
+    
+    /// Идентификатор узла трассы. Идентификаторы не используются повторно в пределах одной трассы и ее ответвлений.
+    typedef unsigned int NodeId;
+    
+    /// Запись об узле трассы.
+    struct NodeRecord {
+        
+        /// Указатель на неизменяемый узел трассы. Указатели на смежные узлы и индекс ячейки пула в узле не используются.
+        std::shared_ptr<const PipeTrackNode> nodeP;
+        
+        /// Идентификатор следующего узла трассы или noNodeId.
+        NodeId nextNodeId;
+        
+        /// Идентификатор основного предшествующего узла трассы или noNodeId.
+        NodeId basePrevNodeId;
+        
+        /// Идентификатор второго предшествующего узла трассы или noNodeId.
+        NodeId secondPrevNodeId;
+        
+        /// Идентификатор третьего предшествующего узла трассы или noNodeId.
+        NodeId thirdPrevNodeId;
+        
+    };
+    
+    /// Значение идентификатора, обозначающее отсутствие узла.
+    static constexpr NodeId noNodeId = std::numeric_limits<NodeId>::max();
+    
+private:
+    
+    // MARK: - Вспомогательные типы
+    
+    /// Слой трассы.
+    struct Layer {
+        
+        /// Указатель на родительский слой или nullptr.
+        std::shared_ptr<const Layer> parentLayerP;
+        
+        /// Записи об узлах, добавленных или измененных в данном слое.
+        std::map<NodeId, NodeRecord> nodeRecords;
+        
+        /// Идентификаторы узлов родительских слоев, удаленных в данном слое.
+        std::set<NodeId> removedNodeIds;
+        
+        /// Идентификатор корневого узла трассы или noNodeId.
+        NodeId rootNodeId;
+        
+        /// Идентификатор, который получит следующий добавленный узел.
+        NodeId nextFreeNodeId;
+        
+        /// Число узлов трассы с учетом родительских слоев.
+        unsigned int nodesCount;
+        
+        /// Стоимость трассы с учетом родительских слоев (единица измерения - руб.).
+        CalcNumber cost;
+        
+        /// Число родительских слоев.
+        unsigned int depth;
+        
+    };
+    
+    // MARK: - Скрытые объекты
+    
+    /// Наибольшее число родительских слоев. При превышении данного числа видимые узлы переносятся в один слой, чтобы время поиска узла оставалось ограниченным.
+    static const unsigned int maxLayerDepth = 16;
+    
+    /// Указатель на верхний слой трассы или nullptr для пустой трассы. Слой изменяется только тогда, когда на него нет других ссылок.
+    std::shared_ptr<Layer> layerP;
+    
+public:
+    
+    // MARK: - Конструкторы
+    
+    /// Конструктор. Создается пустая трасса.
+    explicit PersistentPipeTrack();
+    
+    /// Конструктор. Создается трасса, содержащая копии узлов трассы pipeTrack и связей между ними.
+    ///
+    /// \param pipeTrack Трасса системы водоотведения.
+    explicit PersistentPipeTrack(const PipeTrack & pipeTrack);
+    
+    // MARK: - Открытые методы
+    
+    /// Создать ответвление трассы. Узлы данной трассы не копируются.
+    ///
+    /// \return Ответвление трассы.
+    PersistentPipeTrack fork() const;
+    
+    /// Добавить в трассу новый узел. Связи узла со смежными узлами не устанавливаются.
+    ///
+    /// \param type Тип объекта системы водоотведения.
+    /// \param pipeObjectP Указатель на объект системы водоотведения.
+    /// \param centerPoint Центр объекта (для типов "отвод", "тройник", "крестовина"; единица измерения - мм.).
+    /// \param startPoint Начало объекта (для типов "прямая труба", "фановая труба", "редукция"; единица измерения - мм.).
+    /// \param endPoint Конец объекта (для типов "прямая труба", "фановая труба", "редукция"; единица измерения - мм.).
+    /// \param baseDirection Основное направление объекта (для типов "отвод", "тройник", "крестовина").
+    /// \param secondDirection Второе направление объекта (для типов "тройник", "крестовина").
+    /// \param thirdDirection Третье направление объекта (для типа "крестовина").
+    ///
+    /// \return Идентификатор добавленного узла.
+    NodeId addNode(PipeObjectType type, const PipeObject * pipeObjectP, const Point & centerPoint, const Point & startPoint, const Point & endPoint, const Point & baseDirection, const Point & secondDirection, const Point & thirdDirection);
+    
+    /// Удалить узел из трассы. Связи смежных узлов с удаленным узлом далее считаются отсутствующими.
+    ///
+    /// \param nodeId Идентификатор узла. Если узла нет в трассе, метод ничего не делает.
+    void removeNode(NodeId nodeId);
+    
+    /// Установить связи узла трассы со смежными узлами. Сам узел не копируется.
+    ///
+    /// \param nodeId Идентификатор узла трассы. Узел должен присутствовать в трассе.
+    /// \param nextNodeId Идентификатор следующего узла трассы или noNodeId.
+    /// \param basePrevNodeId Идентификатор основного предшествующего узла трассы или noNodeId.
+    /// \param secondPrevNodeId Идентификатор второго предшествующего узла трассы или noNodeId.
+    /// \param thirdPrevNodeId Идентификатор третьего предшествующего узла трассы или noNodeId.
+    void setNodeLinks(NodeId nodeId, NodeId nextNodeId, NodeId basePrevNodeId, NodeId secondPrevNodeId, NodeId thirdPrevNodeId);
+    
+    /// Установить корневой узел трассы.
+    ///
+    /// \param nodeId Идентификатор узла трассы или noNodeId.
+    void setRootNodeId(NodeId nodeId);
+    
+    /// Вернуть идентификатор корневого узла трассы.
+    ///
+    /// \return Идентификатор корневого узла или noNodeId, если корневой узел не задан или удален.
+    NodeId rootNodeId() const;
+    
+    /// Найти запись об узле трассы.
+    ///
+    /// \param nodeId Идентификатор узла.
+    ///
+    /// \return Указатель на запись об узле или nullptr, если узла нет в трассе. Указатель действителен до изменения трассы.
+    const NodeRecord * findNodeRecordP(NodeId nodeId) const;
+    
+    /// Вернуть идентификаторы всех узлов трассы.
+    ///
+    /// \return Идентификаторы узлов в порядке возрастания.
+    std::vector<NodeId> nodeIds() const;
+    
+    /// Вернуть число узлов трассы.
+    ///
+    /// \return Число узлов трассы.
+    unsigned int nodesCount() const;
+    
+    /// Вернуть стоимость трассы как сумму стоимостей входящих в нее объектов. Стоимость поддерживается при добавлении и удалении узлов.
+    ///
+    /// \return Стоимость трассы (единица измерения - руб.).
+    CalcNumber cost() const;
+    
+    /// Вернуть число слоев трассы.
+    ///
+    /// \return Число слоев трассы (0 для пустой трассы без изменений).
+    unsigned int layersCount() const;
+    
+    /// Построить обычную трассу, содержащую копии узлов данной трассы и связи между ними.
+    ///
+    /// \param pipeTrack Пустая трасса системы водоотведения, в которую добавляются узлы.
+    void buildPipeTrack(PipeTrack & pipeTrack) const;
+    
+private:
+    
+    // MARK: - Скрытые методы
+    
+    /// Вернуть верхний слой трассы, доступный для изменения. Если на верхний слой есть другие ссылки, над ним создается новый слой.
+    ///
+    /// \return Ссылка на верхний слой трассы.
+    Layer & writableLayer();
+    
+    /// Собрать записи обо всех узлах трассы с учетом удалений и изменений в слоях.
+    ///
+    /// \return Указатели на записи об узлах трассы по их идентификаторам.
+    std::map<NodeId, const NodeRecord*> collectNodeRecordPs() const;
+    
+};
+
+// MARK: - Реализация
+
+/// Конструктор. Создается пустая трасса.
+PersistentPipeTrack::PersistentPipeTrack(): layerP(nullptr) {}
+
+/// Конструктор. Создается трасса, содержащая копии узлов трассы pipeTrack и связей между ними.
+///
+/// \param pipeTrack Трасса системы водоотведения.
+PersistentPipeTrack::PersistentPipeTrack(const PipeTrack & pipeTrack): layerP(nullptr) {
+    
+    // идентификаторы узлов совпадают с их позициями в массиве nodePs
+    std::map<const PipeTrackNode*, NodeId> nodeIdForNodeP;
+    for (const PipeTrackNode * pipeTrackNodeP : pipeTrack.nodePs) {
+        PipeTrackNode pipeTrackNode = *pipeTrackNodeP;
+        pipeTrackNode.nextNodeP = nullptr;
+        pipeTrackNode.basePrevNodeP = nullptr;
+        pipeTrackNode.secondPrevNodeP = nullptr;
+        pipeTrackNode.thirdPrevNodeP = nullptr;
+        
+        Layer & layer = writableLayer();
+        NodeId nodeId = layer.nextFreeNodeId++;
+        layer.nodeRecords[nodeId] = NodeRecord { std::make_shared<const PipeTrackNode>(pipeTrackNode), noNodeId, noNodeId, noNodeId, noNodeId };
+        layer.nodesCount++;
+        layer.cost += pipeTrackNodeP->calculateCost();
+        nodeIdForNodeP[pipeTrackNodeP] = nodeId;
+    }
+    
+    auto nodeIdOf = [&nodeIdForNodeP](const PipeTrackNode * pipeTrackNodeP) {
+        return (pipeTrackNodeP == nullptr) ? noNodeId : nodeIdForNodeP.at(pipeTrackNodeP);
+    };
+    for (const PipeTrackNode * pipeTrackNodeP : pipeTrack.nodePs) {
+        setNodeLinks(nodeIdOf(pipeTrackNodeP), nodeIdOf(pipeTrackNodeP->nextNodeP), nodeIdOf(pipeTrackNodeP->basePrevNodeP), nodeIdOf(pipeTrackNodeP->secondPrevNodeP), nodeIdOf(pipeTrackNodeP->thirdPrevNodeP));
+    }
+    if (pipeTrack.rootNodeP != nullptr) {
+        setRootNodeId(nodeIdOf(pipeTrack.rootNodeP));
+    }
+    
+}
+
+/// Создать ответвление трассы. Узлы данной трассы не копируются.
+///
+/// \return Ответвление трассы.
+PersistentPipeTrack PersistentPipeTrack::fork() const {
+    
+    return *this;
+    
+}
+
+/// Добавить в трассу новый узел. Связи узла со смежными узлами не устанавливаются.
+///
+/// \param type Тип объекта системы водоотведения.
+/// \param pipeObjectP Указатель на объект системы водоотведения.
+/// \param centerPoint Центр объекта (для типов "отвод", "тройник", "крестовина"; единица измерения - мм.).
+/// \param startPoint Начало объекта (для типов "прямая труба", "фановая труба", "редукция"; единица измерения - мм.).
+/// \param endPoint Конец объекта (для типов "прямая труба", "фановая труба", "редукция"; единица измерения - мм.).
+/// \param baseDirection Основное направление объекта (для типов "отвод", "тройник", "крестовина").
+/// \param secondDirection Второе направление объекта (для типов "тройник", "крестовина").
+/// \param thirdDirection Третье направление объекта (для типа "крестовина").
+///
+/// \return Идентификатор добавленного узла.
+PersistentPipeTrack::NodeId PersistentPipeTrack::addNode(PipeObjectType type, const PipeObject * pipeObjectP, const Point & centerPoint, const Point & startPoint, const Point & endPoint, const Point & baseDirection, const Point & secondDirection, const Point & thirdDirection) {
+    
+    std::shared_ptr<const PipeTrackNode> nodeP = std::make_shared<const PipeTrackNode>(type, pipeObjectP, centerPoint, startPoint, endPoint, baseDirection, secondDirection, thirdDirection);
+    
+    Layer & layer = writableLayer();
+    NodeId nodeId = layer.nextFreeNodeId++;
+    layer.nodeRecords[nodeId] = NodeRecord { nodeP, noNodeId, noNodeId, noNodeId, noNodeId };
+    layer.nodesCount++;
+    layer.cost += nodeP->calculateCost();
+    
+    return nodeId;
+    
+}
+
+/// Удалить узел из трассы. Связи смежных узлов с удаленным узлом далее считаются отсутствующими.
+///
+/// \param nodeId Идентификатор узла. Если узла нет в трассе, метод ничего не делает.
+void PersistentPipeTrack::removeNode(NodeId nodeId) {
+    
+    const NodeRecord * nodeRecordP = findNodeRecordP(nodeId);
+    if (nodeRecordP == nullptr) {
+        return;
+    }
+    CalcNumber nodeCost = nodeRecordP->nodeP->calculateCost();
+    
+    Layer & layer = writableLayer();
+    // Запись, созданная в верхнем слое, удаляется из него. Если узел есть в родительских слоях, его удаление дополнительно отмечается.
+    layer.nodeRecords.erase(nodeId);
+    const Layer * parentLayerP = layer.parentLayerP.get();
+    while (parentLayerP != nullptr && parentLayerP->removedNodeIds.count(nodeId) == 0 && parentLayerP->nodeRecords.count(nodeId) == 0) {
+        parentLayerP = parentLayerP->parentLayerP.get();
+    }
+    if (parentLayerP != nullptr && parentLayerP->nodeRecords.count(nodeId) > 0) {
+        layer.removedNodeIds.insert(nodeId);
+    }
+    
+    layer.nodesCount--;
+    layer.cost -= nodeCost;
+    if (layer.rootNodeId == nodeId) {
+        layer.rootNodeId = noNodeId;
+    }
+    
+}
+
+/// Установить связи узла трассы со смежными узлами. Сам узел не копируется.
+///
+/// \param nodeId Идентификатор узла трассы. Узел должен присутствовать в трассе.
+/// \param nextNodeId Идентификатор следующего узла трассы или noNodeId.
+/// \param basePrevNodeId Идентификатор основного предшествующего узла трассы или noNodeId.
+/// \param secondPrevNodeId Идентификатор второго предшествующего узла трассы или noNodeId.
+/// \param thirdPrevNodeId Идентификатор третьего предшествующего узла трассы или noNodeId.
+void PersistentPipeTrack::setNodeLinks(NodeId nodeId, NodeId nextNodeId, NodeId basePrevNodeId, NodeId secondPrevNodeId, NodeId thirdPrevNodeId) {
+    
+    const NodeRecord * nodeRecordP = findNodeRecordP(nodeId);
+    assert(nodeRecordP != nullptr);
+    std::shared_ptr<const PipeTrackNode> nodeP = nodeRecordP->nodeP;
+    
+    writableLayer().nodeRecords[nodeId] = NodeRecord { nodeP, nextNodeId, basePrevNodeId, secondPrevNodeId, thirdPrevNodeId };
+    
+}
+
+/// Установить корневой узел трассы.
+///
+/// \param nodeId Идентификатор узла трассы или noNodeId.
+void PersistentPipeTrack::setRootNodeId(NodeId nodeId) {
+    
+    assert(nodeId == noNodeId || findNodeRecordP(nodeId) != nullptr);
+    writableLayer().rootNodeId = nodeId;
+    
+}
+
+/// Вернуть идентификатор корневого узла трассы.
+///
+/// \return Идентификатор корневого узла или noNodeId, если корневой узел не задан или удален.
+PersistentPipeTrack::NodeId PersistentPipeTrack::rootNodeId() const {
+    
+    return (layerP == nullptr) ? noNodeId : layerP->rootNodeId;
+    
+}
+
+/// Найти запись об узле трассы.
+///
+/// \param nodeId Идентификатор узла.
+///
+/// \return Указатель на запись об узле или nullptr, если узла нет в трассе. Указатель действителен до изменения трассы.
+const PersistentPipeTrack::NodeRecord * PersistentPipeTrack::findNodeRecordP(NodeId nodeId) const {
+    
+    // слои просматриваются сверху вниз до первого упоминания узла
+    for (const Layer * currentLayerP = layerP.get(); currentLayerP != nullptr; currentLayerP = currentLayerP->parentLayerP.get()) {
+        if (currentLayerP->removedNodeIds.count(nodeId) > 0) {
+            return nullptr;
+        }
+        auto nodeRecordIt = currentLayerP->nodeRecords.find(nodeId);
+        if (nodeRecordIt != currentLayerP->nodeRecords.end()) {
+            return &nodeRecordIt->second;
+        }
+    }
+    return nullptr;
+    
+}
+
+/// Вернуть идентификаторы всех узлов трассы.
+///
+/// \return Идентификаторы узлов в порядке возрастания.
+std::vector<PersistentPipeTrack::NodeId> PersistentPipeTrack::nodeIds() const {
+    
+    std::vector<NodeId> resultNodeIds;
+    resultNodeIds.reserve(nodesCount());
+    for (const auto & nodeRecordPForId : collectNodeRecordPs()) {
+        resultNodeIds.push_back(nodeRecordPForId.first);
+    }
+    return resultNodeIds;
+    
+}
+
+/// Вернуть число узлов трассы.
+///
+/// \return Число узлов трассы.
+unsigned int PersistentPipeTrack::nodesCount() const {
+    
+    return (layerP == nullptr) ? 0 : layerP->nodesCount;
+    
+}
+
+/// Вернуть стоимость трассы как сумму стоимостей входящих в нее объектов. Стоимость поддерживается при добавлении и удалении узлов.
+///
+/// \return Стоимость трассы (единица измерения - руб.).
+CalcNumber PersistentPipeTrack::cost() const {
+    
+    return (layerP == nullptr) ? 0 : layerP->cost;
+    
+}
+
+/// Вернуть число слоев трассы.
+///
+/// \return Число слоев трассы (0 для пустой трассы без изменений).
+unsigned int PersistentPipeTrack::layersCount() const {
+    
+    return (layerP == nullptr) ? 0 : layerP->depth + 1;
+    
+}
+
+/// Построить обычную трассу, содержащую копии узлов данной трассы и связи между ними.
+///
+/// \param pipeTrack Пустая трасса системы водоотведения, в которую добавляются узлы.
+void PersistentPipeTrack::buildPipeTrack(PipeTrack & pipeTrack) const {
+    
+    assert(pipeTrack.nodePs.size() == 0);
+    
+    std::map<NodeId, const NodeRecord*> nodeRecordPs = collectNodeRecordPs();
+    std::map<NodeId, PipeTrackNode*> pipeTrackNodePForId;
+    for (const auto & nodeRecordPForId : nodeRecordPs) {
+        pipeTrackNodePForId[nodeRecordPForId.first] = pipeTrack.createNodeCopyAndReturnP(*nodeRecordPForId.second->nodeP);
+    }
+    
+    // связи с удаленными узлами не переносятся
+    auto nodePOf = [&pipeTrackNodePForId](NodeId nodeId) {
+        auto nodePIt = pipeTrackNodePForId.find(nodeId);
+        return (nodePIt == pipeTrackNodePForId.end()) ? nullptr : nodePIt->second;
+    };
+    for (const auto & nodeRecordPForId : nodeRecordPs) {
+        PipeTrackNode * pipeTrackNodeP = pipeTrackNodePForId[nodeRecordPForId.first];
+        pipeTrackNodeP->nextNodeP = nodePOf(nodeRecordPForId.second->nextNodeId);
+        pipeTrackNodeP->basePrevNodeP = nodePOf(nodeRecordPForId.second->basePrevNodeId);
+        pipeTrackNodeP->secondPrevNodeP = nodePOf(nodeRecordPForId.second->secondPrevNodeId);
+        pipeTrackNodeP->thirdPrevNodeP = nodePOf(nodeRecordPForId.second->thirdPrevNodeId);
+    }
+    pipeTrack.rootNodeP = nodePOf(rootNodeId());
+    
+}
+
+/// Вернуть верхний слой трассы, доступный для изменения. Если на верхний слой есть другие ссылки, над ним создается новый слой.
+///
+/// \return Ссылка на верхний слой трассы.
+PersistentPipeTrack::Layer & PersistentPipeTrack::writableLayer() {
+    
+    if (layerP == nullptr) {
+        layerP = std::make_shared<Layer>();
+        layerP->parentLayerP = nullptr;
+        layerP->rootNodeId = noNodeId;
+        layerP->nextFreeNodeId = 0;
+        layerP->nodesCount = 0;
+        layerP->cost = 0;
+        layerP->depth = 0;
+        return *layerP;
+    }
+    
+    if (layerP.use_count() == 1) {
+        return *layerP;
+    }
+    
+    std::shared_ptr<Layer> newLayerP = std::make_shared<Layer>();
+    newLayerP->rootNodeId = layerP->rootNodeId;
+    newLayerP->nextFreeNodeId = layerP->nextFreeNodeId;
+    newLayerP->nodesCount = layerP->nodesCount;
+    newLayerP->cost = layerP->cost;
+    if (layerP->depth + 1 < maxLayerDepth) {
+        newLayerP->parentLayerP = layerP;
+        newLayerP->depth = layerP->depth + 1;
+    } else {
+        // цепочка слоев сворачивается в один слой, узлы при этом не копируются
+        for (const auto & nodeRecordPForId : collectNodeRecordPs()) {
+            newLayerP->nodeRecords.emplace_hint(newLayerP->nodeRecords.end(), nodeRecordPForId.first, *nodeRecordPForId.second);
+        }
+        newLayerP->parentLayerP = nullptr;
+        newLayerP->depth = 0;
+    }
+    layerP = newLayerP;
+    return *layerP;
+    
+}
+
+/// Собрать записи обо всех узлах трассы с учетом удалений и изменений в слоях.
+///
+/// \return Указатели на записи об узлах трассы по их идентификаторам.
+std::map<PersistentPipeTrack::NodeId, const PersistentPipeTrack::NodeRecord*> PersistentPipeTrack::collectNodeRecordPs() const {
+    
+    // Слои просматриваются сверху вниз. Узел, уже упомянутый в верхнем слое (записью или удалением), в нижних слоях пропускается.
+    std::map<NodeId, const NodeRecord*> resultNodeRecordPs;
+    std::set<NodeId> removedNodeIds;
+    for (const Layer * currentLayerP = layerP.get(); currentLayerP != nullptr; currentLayerP = currentLayerP->parentLayerP.get()) {
+        for (const auto & nodeRecordForId : currentLayerP->nodeRecords) {
+            if (removedNodeIds.count(nodeRecordForId.first) == 0) {
+                resultNodeRecordPs.emplace(nodeRecordForId.first, &nodeRecordForId.second);
+            }
+        }
+        removedNodeIds.insert(currentLayerP->removedNodeIds.begin(), currentLayerP->removedNodeIds.end());
+    }
+    return resultNodeRecordPs;
+    
+}
+
+#endif /* PersistentPipeTrack_hpp */
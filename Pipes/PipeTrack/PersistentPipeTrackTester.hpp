@@ -0,0 +1,99 @@
+#ifndef PersistentPipeTrackTester_hpp
+#define PersistentPipeTrackTester_hpp
+
+// Подключение стандартных библиотек
+#include <string>
+#include <iostream>
+#include <map>
+#include <cassert>
+
+// Подключение внутренних типов
+#include "PersistentPipeTrack.hpp"
+#include "DirectPipe.hpp"
+
+/// Тестер для класса PersistentPipeTrack.
+class PersistentPipeTrackTester {
+    
+public:
+    
+    // MARK: - Открытые методы
+    
+    /// Тестировать класс PersistentPipeTrack.
+    void test();
+    
+};
+
+// MARK: - Реализация
+
+/// Тестировать класс PersistentPipeTrack.
+void PersistentPipeTrackTester::test() {
+    
+    typedef PersistentPipeTrack::NodeId NodeId;
+    const NodeId noNodeId = PersistentPipeTrack::noNodeId;
+    
+    std::map<unsigned int, unsigned int> externalDiameterForDiameter = { { 50, 54 } };
+    DirectPipe directPipe(50, 1, "Труба", 2, &externalDiameterForDiameter);
+    Point zero = Point(0, 0, 0), ox = Point(1, 0, 0);
+    
+    // ствол: 0 -> 1 (корень)
+    PersistentPipeTrack trunk;
+    assert(trunk.nodesCount() == 0 && trunk.rootNodeId() == noNodeId && trunk.layersCount() == 0);
+    NodeId rootId = trunk.addNode(direct, &directPipe, zero, Point(100, 0, 0), Point(200, 0, 0), ox, ox, ox);
+    NodeId leafId = trunk.addNode(direct, &directPipe, zero, Point(0, 0, 0), Point(100, 0, 0), ox, ox, ox);
+    trunk.setNodeLinks(leafId, rootId, noNodeId, noNodeId, noNodeId);
+    trunk.setNodeLinks(rootId, noNodeId, leafId, noNodeId, noNodeId);
+    trunk.setRootNodeId(rootId);
+    assert(trunk.nodesCount() == 2 && trunk.cost() == 400 && trunk.layersCount() == 1);
+    
+    // ответвления не копируют узлы ствола и не влияют друг на друга
+    PersistentPipeTrack branch1 = trunk.fork();
+    PersistentPipeTrack branch2 = trunk.fork();
+    NodeId branchId = branch1.addNode(direct, &directPipe, zero, Point(100, -50, 0), Point(100, 0, 0), ox, ox, ox);
+    assert(branch1.layersCount() == 2);
+    assert(branch1.findNodeRecordP(rootId)->nodeP == trunk.findNodeRecordP(rootId)->nodeP);
+    branch2.removeNode(leafId);
+    
+    assert(trunk.nodesCount() == 2 && trunk.findNodeRecordP(leafId) != nullptr && trunk.findNodeRecordP(branchId) == nullptr);
+    assert(branch1.nodesCount() == 3 && branch1.cost() == 500 && branch1.findNodeRecordP(leafId) != nullptr);
+    assert(branch2.nodesCount() == 1 && branch2.cost() == 200 && branch2.findNodeRecordP(leafId) == nullptr);
+    assert(branch2.nodeIds() == std::vector<NodeId>({ rootId }));
+    
+    // изменение связей узла ствола в ответвлении
+    branch1.setNodeLinks(branchId, rootId, noNodeId, noNodeId, noNodeId);
+    branch1.setNodeLinks(rootId, noNodeId, leafId, branchId, noNodeId);
+    assert(branch1.findNodeRecordP(rootId)->secondPrevNodeId == branchId);
+    assert(trunk.findNodeRecordP(rootId)->secondPrevNodeId == noNodeId);
+    
+    // построение обычной трассы: связь с удаленным узлом не переносится
+    PipeTrack pipeTrack(nullptr, 1000);
+    branch2.buildPipeTrack(pipeTrack);
+    assert(pipeTrack.nodePs.size() == 1 && pipeTrack.rootNodeP == pipeTrack.nodePs[0]);
+    assert(pipeTrack.rootNodeP->basePrevNodeP == nullptr);
+    
+    PipeTrack anotherPipeTrack(nullptr, 1000);
+    branch1.buildPipeTrack(anotherPipeTrack);
+    assert(anotherPipeTrack.nodePs.size() == 3 && anotherPipeTrack.calculateCost() == 500);
+    assert(anotherPipeTrack.rootNodeP->basePrevNodeP->nextNodeP == anotherPipeTrack.rootNodeP);
+    assert(anotherPipeTrack.rootNodeP->secondPrevNodeP->startPoint == Point(100, -50, 0));
+    
+    // обратное преобразование сохраняет узлы и связи
+    PersistentPipeTrack copiedTrack(anotherPipeTrack);
+    assert(copiedTrack.nodesCount() == 3 && copiedTrack.cost() == 500);
+    const PersistentPipeTrack::NodeRecord * rootRecordP = copiedTrack.findNodeRecordP(copiedTrack.rootNodeId());
+    assert(rootRecordP->basePrevNodeId != noNodeId && rootRecordP->secondPrevNodeId != noNodeId && rootRecordP->nextNodeId == noNodeId);
+    
+    // длинная цепочка ответвлений сворачивается
+    PersistentPipeTrack chain = trunk;
+    for (unsigned int i = 0; i < 40; i++) {
+        PersistentPipeTrack previousChain = chain; // предыдущий вариант остается доступным, поэтому каждое изменение создает новый слой
+        chain.addNode(direct, &directPipe, zero, Point(0, 10 * i, 0), Point(0, 10 * i + 10, 0), ox, ox, ox);
+        assert(chain.layersCount() <= 16);
+    }
+    assert(chain.nodesCount() == 42 && chain.cost() == 400 + 40 * 20);
+    assert(chain.findNodeRecordP(leafId) != nullptr && trunk.nodesCount() == 2);
+    
+    std::cout << "Тестирование класса PersistentPipeTrack завершилось успешно.\n";
+    
+}
+
+#endif /* PersistentPipeTrackTester_hpp */
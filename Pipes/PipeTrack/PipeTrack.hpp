@@ -3,7 +3,7 @@
 
 // Подключение стандартных библиотек
 #include <vector>
-#include <map>
+#include <limits>
 #include <sstream>
 #include <string>
 #include <fstream>
@@ -11,23 +11,55 @@
 // Подключение внутренних типов
 #include "Exception.hpp"
 #include "PipeTrackNode.hpp"
+#include "PipeTrackSpatialIndex.hpp"
 #include "View.hpp"
 
-/// Трасса системы водоотведения. Состоит из расположенных в пространстве объектов системы водоотведения (прямых труб, фановых труб, редукций, отводов, тройников, крестовин). Имеет вид дерева.
+/// Трасса системы водоотведения. Состоит из расположенных в пространстве объектов системы водоотведения (прямых труб, фановых труб, редукций, отводов, тройников, крестовин). Имеет вид дерева. Узлы трассы размещаются в пуле, состоящем из блоков фиксированной емкости: узлы не перемещаются в памяти до удаления, ячейки удаленных узлов используются повторно, а копирование трассы выполняется по индексам ячеек.
 struct PipeTrack {
     
+    // MARK: - Вспомогательные типы
+    
+    /// Дескриптор узла трассы. После удаления узла дескриптор становится недействительным, даже если ячейка пула занята новым узлом.
+    struct NodeHandle {
+        
+        /// Индекс ячейки пула узлов трассы.
+        unsigned int slotIndex;
+        
+        /// Поколение ячейки пула на момент получения дескриптора.
+        unsigned int generation;
+        
+    };
+    
 private:
     
     // MARK: - Скрытые объекты
     
+    /// Число ячеек в одном блоке пула узлов трассы.
+    static const unsigned int nodesBlockSize = 64;
+    
     /// Указатель на объект, отвечающий за вывод сообщений и ошибок.
     View * viewP;
     
+    /// Блоки пула узлов трассы. Емкость каждого блока резервируется заранее и не превышается, поэтому указатели на узлы остаются действительными при добавлении новых узлов.
+    std::vector<std::vector<PipeTrackNode>> nodeBlocks;
+    
+    /// Поколения ячеек пула узлов трассы. Поколение ячейки увеличивается при удалении размещенного в ней узла.
+    std::vector<unsigned int> slotGenerations;
+    
+    /// Позиции узлов в массиве nodePs для ячеек пула узлов трассы (для свободных ячеек значения не используются).
+    std::vector<unsigned int> slotPositions;
+    
+    /// Индексы свободных ячеек пула узлов трассы.
+    std::vector<unsigned int> freeSlotIndexes;
+    
+    /// Пространственный индекс узлов трассы. Обновляется при создании и удалении узлов.
+    PipeTrackSpatialIndex spatialIndex;
+    
 public:
     
     // MARK: - Открытые объекты
     
-    /// Указатели на узлы трассы.
+    /// Указатели на узлы трассы. При удалении узла на его место переносится последний узел массива.
     std::vector<PipeTrackNode*> nodePs;
     
     /// Указатель на корневой узел трассы или nullptr. Данный узел соответствует стоку (стояку) трассы.
@@ -38,16 +70,14 @@ public:
     /// Конструктор. Создается пустая трасса.
     ///
     /// \param viewP Указатель на объект, отвечающий за вывод сообщений и ошибок.
-    explicit PipeTrack(View * viewP);
+    /// \param spatialIndexCellSize Размер ячейки сетки пространственного индекса узлов трассы (единица измерения - мм.).
+    explicit PipeTrack(View * viewP, CalcNumber spatialIndexCellSize);
     
     /// Конструктор копирования.
     ///
     /// \param anotherPipeTrack Копируемая трасса системы водоотведения.
     PipeTrack(const PipeTrack & anotherPipeTrack);
     
-    /// Деструктор.
-    ~PipeTrack();
-    
     // MARK: - Открытые методы
     
     /// Оператор копирования.
@@ -69,11 +99,41 @@ public:
     /// \return Указатель на созданный узел трассы.
     PipeTrackNode * createNodeAndReturnP(PipeObjectType type, const PipeObject * pipeObjectP, const Point & centerPoint, const Point & startPoint, const Point & endPoint, const Point & baseDirection, const Point & secondDirection, const Point & thirdDirection);
     
-    /// Удалить узел из трассы. При удалении узла устраняются связи данного узла со смежными.
+    /// Создать в трассе копию узла и вернуть указатель на нее. Связи копии со смежными узлами не устанавливаются.
+    ///
+    /// \param pipeTrackNode Копируемый узел (может не принадлежать трассе).
+    ///
+    /// \return Указатель на созданный узел трассы.
+    PipeTrackNode * createNodeCopyAndReturnP(const PipeTrackNode & pipeTrackNode);
+    
+    /// Удалить узел из трассы. При удалении узла устраняются связи данного узла со смежными. Ячейка пула, занимаемая узлом, освобождается для повторного использования.
     ///
-    /// \param pipeTrackNodeP Указатель на удаляемый узел или nullptr.
+    /// \param pipeTrackNodeP Указатель на удаляемый узел или nullptr. Если узел не принадлежит трассе, метод ничего не делает.
     void removeNode(PipeTrackNode * pipeTrackNodeP);
     
+    /// Вернуть дескриптор узла трассы.
+    ///
+    /// \param pipeTrackNodeP Указатель на узел данной трассы.
+    ///
+    /// \return Дескриптор узла.
+    NodeHandle handleOf(const PipeTrackNode * pipeTrackNodeP) const;
+    
+    /// Вернуть указатель на узел трассы по его дескриптору.
+    ///
+    /// \param handle Дескриптор узла.
+    ///
+    /// \return Указатель на узел или nullptr, если узел был удален из трассы.
+    PipeTrackNode * nodePForHandle(const NodeHandle & handle);
+    
+    /// Найти ближайшую к точке point точку центральных отрезков прямых и фановых труб трассы. Узлы просматриваются кольцами ячеек пространственного индекса в порядке удаления от точки, пока расстояние до очередного кольца не превысит расстояние до уже найденной точки. Z-координаты не учитываются.
+    ///
+    /// \param point Точка (единица измерения - мм.).
+    /// \param nearestCenterPoint Найденная точка с нулевой Z-координатой (единица измерения - мм.).
+    /// \param nearestNodeP Указатель на узел трассы, которому принадлежит найденная точка.
+    ///
+    /// \return true, если точка найдена, иначе false (в трассе нет прямых и фановых труб).
+    bool findNearestCenterPoint2D(const Point & point, Point & nearestCenterPoint, const PipeTrackNode * & nearestNodeP) const;
+    
     /// Вычислить стоимость трассы как сумму стоимостей входящих в нее объектов.
     ///
     /// \return Стоимость трассы (единица измерения - руб.).
@@ -91,6 +151,27 @@ private:
     
     // MARK: - Скрытые методы
     
+    /// Вернуть узел, размещенный в ячейке пула.
+    ///
+    /// \param slotIndex Индекс ячейки пула узлов трассы.
+    ///
+    /// \return Ссылка на узел.
+    PipeTrackNode & nodeInSlot(unsigned int slotIndex);
+    
+    /// Вернуть узел, размещенный в ячейке пула.
+    ///
+    /// \param slotIndex Индекс ячейки пула узлов трассы.
+    ///
+    /// \return Константная ссылка на узел.
+    const PipeTrackNode & nodeInSlot(unsigned int slotIndex) const;
+    
+    /// Проверить, принадлежит ли узел данной трассе.
+    ///
+    /// \param pipeTrackNodeP Указатель на узел.
+    ///
+    /// \return true, если узел размещен в занятой ячейке пула данной трассы, иначе false.
+    bool containsNode(const PipeTrackNode * pipeTrackNodeP) const;
+    
     /// Вернуть число в виде форматированной строки.
     ///
     /// \param number Число.
@@ -106,51 +187,54 @@ private:
 /// Конструктор. Создается пустая трасса.
 ///
 /// \param viewP Указатель на объект, отвечающий за вывод сообщений и ошибок.
-PipeTrack::PipeTrack(View * viewP): viewP(viewP), rootNodeP(nullptr) {}
+/// \param spatialIndexCellSize Размер ячейки сетки пространственного индекса узлов трассы (единица измерения - мм.).
+PipeTrack::PipeTrack(View * viewP, CalcNumber spatialIndexCellSize): viewP(viewP), spatialIndex(spatialIndexCellSize), rootNodeP(nullptr) {}
 
 /// Конструктор копирования.
 ///
 /// \param anotherPipeTrack Копируемая трасса системы водоотведения.
-PipeTrack::PipeTrack(const PipeTrack & anotherPipeTrack) {
+PipeTrack::PipeTrack(const PipeTrack & anotherPipeTrack): viewP(nullptr), spatialIndex(anotherPipeTrack.spatialIndex), rootNodeP(nullptr) {
     
     *this = anotherPipeTrack;
     
 }
 
-/// Деструктор.
-PipeTrack::~PipeTrack() {
-    
-    for (PipeTrackNode * nodeP : nodePs) {
-        delete nodeP;
-    }
-    nodePs.clear();
-    
-}
-
 /// Оператор копирования.
 ///
 /// \param anotherPipeTrack Копируемая трасса системы водоотведения.
 PipeTrack & PipeTrack::operator=(const PipeTrack & anotherPipeTrack) {
     
-    viewP = anotherPipeTrack.viewP;
+    if (this == &anotherPipeTrack) {
+        return *this;
+    }
     
-    std::map<const PipeTrackNode*, int> indexForAnotherPipeNodeP;
+    viewP = anotherPipeTrack.viewP;
     
-    for (int i = 0; i < anotherPipeTrack.nodePs.size(); i++) {
-        const PipeTrackNode * anotherPipeTrackNodeP = anotherPipeTrack.nodePs[i];
-        indexForAnotherPipeNodeP[anotherPipeTrackNodeP] = i;
-        nodePs.push_back(new PipeTrackNode(*anotherPipeTrackNodeP));
+    // блоки, уже выделенные под данную трассу, используются повторно
+    nodeBlocks.resize(anotherPipeTrack.nodeBlocks.size());
+    for (unsigned int i = 0; i < nodeBlocks.size(); i++) {
+        nodeBlocks[i].reserve(nodesBlockSize);
+        nodeBlocks[i].assign(anotherPipeTrack.nodeBlocks[i].begin(), anotherPipeTrack.nodeBlocks[i].end());
     }
+    slotGenerations = anotherPipeTrack.slotGenerations;
+    slotPositions = anotherPipeTrack.slotPositions;
+    freeSlotIndexes = anotherPipeTrack.freeSlotIndexes;
+    spatialIndex = anotherPipeTrack.spatialIndex;
     
-    for (int i = 0; i < anotherPipeTrack.nodePs.size(); i++) {
-        const PipeTrackNode * anotherPipeTrackNodeP = anotherPipeTrack.nodePs[i];
-        PipeTrackNode * nodeP = nodePs[i];
-        nodeP->nextNodeP = (anotherPipeTrackNodeP->nextNodeP == nullptr) ? nullptr : nodePs[indexForAnotherPipeNodeP[anotherPipeTrackNodeP->nextNodeP]];
-        nodeP->basePrevNodeP = (anotherPipeTrackNodeP->basePrevNodeP == nullptr) ? nullptr : nodePs[indexForAnotherPipeNodeP[anotherPipeTrackNodeP->basePrevNodeP]];
-        nodeP->secondPrevNodeP = (anotherPipeTrackNodeP->secondPrevNodeP == nullptr) ? nullptr : nodePs[indexForAnotherPipeNodeP[anotherPipeTrackNodeP->secondPrevNodeP]];
-        nodeP->thirdPrevNodeP = (anotherPipeTrackNodeP->thirdPrevNodeP == nullptr) ? nullptr : nodePs[indexForAnotherPipeNodeP[anotherPipeTrackNodeP->thirdPrevNodeP]];
+    // связи скопированных узлов указывают на узлы копируемой трассы и заменяются узлами тех же ячеек данной трассы
+    nodePs.clear();
+    nodePs.reserve(anotherPipeTrack.nodePs.size());
+    for (const PipeTrackNode * anotherPipeTrackNodeP : anotherPipeTrack.nodePs) {
+        PipeTrackNode * nodeP = &nodeInSlot(anotherPipeTrackNodeP->slotIndex);
+        nodeP->nextNodeP = (nodeP->nextNodeP == nullptr) ? nullptr : &nodeInSlot(nodeP->nextNodeP->slotIndex);
+        nodeP->basePrevNodeP = (nodeP->basePrevNodeP == nullptr) ? nullptr : &nodeInSlot(nodeP->basePrevNodeP->slotIndex);
+        nodeP->secondPrevNodeP = (nodeP->secondPrevNodeP == nullptr) ? nullptr : &nodeInSlot(nodeP->secondPrevNodeP->slotIndex);
+        nodeP->thirdPrevNodeP = (nodeP->thirdPrevNodeP == nullptr) ? nullptr : &nodeInSlot(nodeP->thirdPrevNodeP->slotIndex);
+        nodePs.push_back(nodeP);
     }
     
+    rootNodeP = (anotherPipeTrack.rootNodeP == nullptr) ? nullptr : &nodeInSlot(anotherPipeTrack.rootNodeP->slotIndex);
+    
     return *this;
     
 }
@@ -169,19 +253,56 @@ PipeTrack & PipeTrack::operator=(const PipeTrack & anotherPipeTrack) {
 /// \return Указатель на созданный узел трассы.
 PipeTrackNode * PipeTrack::createNodeAndReturnP(PipeObjectType type, const PipeObject * pipeObjectP, const Point & centerPoint, const Point & startPoint, const Point & endPoint, const Point & baseDirection, const Point & secondDirection, const Point & thirdDirection) {
     
-    PipeTrackNode * newNodeP = new PipeTrackNode(type, pipeObjectP, centerPoint, startPoint, endPoint, baseDirection, secondDirection, thirdDirection);
+    return createNodeCopyAndReturnP(PipeTrackNode(type, pipeObjectP, centerPoint, startPoint, endPoint, baseDirection, secondDirection, thirdDirection));
+    
+}
+
+/// Создать в трассе копию узла и вернуть указатель на нее. Связи копии со смежными узлами не устанавливаются.
+///
+/// \param pipeTrackNode Копируемый узел (может не принадлежать трассе).
+///
+/// \return Указатель на созданный узел трассы.
+PipeTrackNode * PipeTrack::createNodeCopyAndReturnP(const PipeTrackNode & pipeTrackNode) {
+    
+    unsigned int slotIndex;
+    if (freeSlotIndexes.size() > 0) {
+        slotIndex = freeSlotIndexes[freeSlotIndexes.size() - 1];
+        freeSlotIndexes.pop_back();
+        nodeInSlot(slotIndex) = pipeTrackNode;
+    } else {
+        slotIndex = static_cast<unsigned int>(slotGenerations.size());
+        if (nodeBlocks.size() == 0 || nodeBlocks[nodeBlocks.size() - 1].size() == nodesBlockSize) {
+            nodeBlocks.emplace_back();
+            nodeBlocks[nodeBlocks.size() - 1].reserve(nodesBlockSize);
+        }
+        nodeBlocks[nodeBlocks.size() - 1].push_back(pipeTrackNode);
+        slotGenerations.push_back(0);
+        slotPositions.push_back(0);
+    }
+    
+    PipeTrackNode * newNodeP = &nodeInSlot(slotIndex);
+    newNodeP->nextNodeP = nullptr;
+    newNodeP->basePrevNodeP = nullptr;
+    newNodeP->secondPrevNodeP = nullptr;
+    newNodeP->thirdPrevNodeP = nullptr;
+    newNodeP->slotIndex = slotIndex;
+    slotPositions[slotIndex] = static_cast<unsigned int>(nodePs.size());
     nodePs.push_back(newNodeP);
     
+    if (newNodeP->footprintSegmentsCount > 0) {
+        spatialIndex.insert(slotIndex, PipeTrackSpatialIndex::BoundingBox { newNodeP->footprintLeft, newNodeP->footprintRight, newNodeP->footprintBottom, newNodeP->footprintTop });
+    }
+    
     return newNodeP;
     
 }
 
-/// Удалить узел из трассы. При удалении узла устраняются связи данного узла со смежными.
+/// Удалить узел из трассы. При удалении узла устраняются связи данного узла со смежными. Ячейка пула, занимаемая узлом, освобождается для повторного использования.
 ///
-/// \param pipeTrackNodeP Указатель на удаляемый узел или nullptr.
+/// \param pipeTrackNodeP Указатель на удаляемый узел или nullptr. Если узел не принадлежит трассе, метод ничего не делает.
 void PipeTrack::removeNode(PipeTrackNode * pipeTrackNodeP) {
     
-    if (pipeTrackNodeP == nullptr) {
+    if (pipeTrackNodeP == nullptr || containsNode(pipeTrackNodeP) == false) {
         return;
     }
     
@@ -207,18 +328,44 @@ void PipeTrack::removeNode(PipeTrackNode * pipeTrackNodeP) {
         pipeTrackNodeP->thirdPrevNodeP->nextNodeP = nullptr;
     }
     
-    for (int i = 0; i < nodePs.size(); i++) {
-        if (nodePs[i] == pipeTrackNodeP) {
-            nodePs.erase(nodePs.begin() + i);
-            break;
-        }
-    }
+    unsigned int slotIndex = pipeTrackNodeP->slotIndex;
+    PipeTrackNode * lastNodeP = nodePs[nodePs.size() - 1];
+    nodePs[slotPositions[slotIndex]] = lastNodeP;
+    slotPositions[lastNodeP->slotIndex] = slotPositions[slotIndex];
+    nodePs.pop_back();
     
     if (rootNodeP == pipeTrackNodeP) {
         rootNodeP = nullptr;
     }
     
-    delete pipeTrackNodeP;
+    spatialIndex.remove(slotIndex);
+    slotGenerations[slotIndex]++;
+    freeSlotIndexes.push_back(slotIndex);
+    
+}
+
+/// Вернуть дескриптор узла трассы.
+///
+/// \param pipeTrackNodeP Указатель на узел данной трассы.
+///
+/// \return Дескриптор узла.
+PipeTrack::NodeHandle PipeTrack::handleOf(const PipeTrackNode * pipeTrackNodeP) const {
+    
+    return NodeHandle { pipeTrackNodeP->slotIndex, slotGenerations[pipeTrackNodeP->slotIndex] };
+    
+}
+
+/// Вернуть указатель на узел трассы по его дескриптору.
+///
+/// \param handle Дескриптор узла.
+///
+/// \return Указатель на узел или nullptr, если узел был удален из трассы.
+PipeTrackNode * PipeTrack::nodePForHandle(const NodeHandle & handle) {
+    
+    if (handle.slotIndex >= slotGenerations.size() || slotGenerations[handle.slotIndex] != handle.generation) {
+        return nullptr;
+    }
+    return &nodeInSlot(handle.slotIndex);
     
 }
 
@@ -278,6 +425,82 @@ void PipeTrack::print2DDataToFile(const std::string & fileName) {
     
 }
 
+/// Найти ближайшую к точке point точку центральных отрезков прямых и фановых труб трассы. Узлы просматриваются кольцами ячеек пространственного индекса в порядке удаления от точки, пока расстояние до очередного кольца не превысит расстояние до уже найденной точки. Z-координаты не учитываются.
+///
+/// \param point Точка (единица измерения - мм.).
+/// \param nearestCenterPoint Найденная точка с нулевой Z-координатой (единица измерения - мм.).
+/// \param nearestNodeP Указатель на узел трассы, которому принадлежит найденная точка.
+///
+/// \return true, если точка найдена, иначе false (в трассе нет прямых и фановых труб).
+bool PipeTrack::findNearestCenterPoint2D(const Point & point, Point & nearestCenterPoint, const PipeTrackNode * & nearestNodeP) const {
+    
+    Point point2D = Point(point.x, point.y, 0);
+    CalcNumber minDistance = std::numeric_limits<CalcNumber>::max();
+    nearestNodeP = nullptr;
+    
+    long long lastRing = spatialIndex.calculateLastRing(point2D);
+    for (long long ring = 0; ring <= lastRing; ring++) {
+        // точки ячеек данного и следующих колец удалены от точки не менее чем на (ring - 1) * cellSize
+        if (nearestNodeP != nullptr && minDistance <= (ring - 1) * spatialIndex.getCellSize()) {
+            break;
+        }
+        for (unsigned int slotIndex : spatialIndex.findSlotIndexesInRing(point2D, static_cast<unsigned int>(ring))) {
+            const PipeTrackNode & node = nodeInSlot(slotIndex);
+            if (node.type != direct && node.type != fan) {
+                continue;
+            }
+            Point centerPoint = node.calculateNearestCenterPoint2D(point2D);
+            CalcNumber distance = (centerPoint - point2D).length();
+            if (distance < minDistance) {
+                minDistance = distance;
+                nearestCenterPoint = centerPoint;
+                nearestNodeP = &node;
+            }
+        }
+    }
+    
+    return nearestNodeP != nullptr;
+    
+}
+
+/// Вернуть узел, размещенный в ячейке пула.
+///
+/// \param slotIndex Индекс ячейки пула узлов трассы.
+///
+/// \return Ссылка на узел.
+PipeTrackNode & PipeTrack::nodeInSlot(unsigned int slotIndex) {
+    
+    return nodeBlocks[slotIndex / nodesBlockSize][slotIndex % nodesBlockSize];
+    
+}
+
+/// Вернуть узел, размещенный в ячейке пула.
+///
+/// \param slotIndex Индекс ячейки пула узлов трассы.
+///
+/// \return Константная ссылка на узел.
+const PipeTrackNode & PipeTrack::nodeInSlot(unsigned int slotIndex) const {
+    
+    return nodeBlocks[slotIndex / nodesBlockSize][slotIndex % nodesBlockSize];
+    
+}
+
+/// Проверить, принадлежит ли узел данной трассе.
+///
+/// \param pipeTrackNodeP Указатель на узел.
+///
+/// \return true, если узел размещен в занятой ячейке пула данной трассы, иначе false.
+bool PipeTrack::containsNode(const PipeTrackNode * pipeTrackNodeP) const {
+    
+    unsigned int slotIndex = pipeTrackNodeP->slotIndex;
+    if (slotIndex >= slotGenerations.size() || &nodeInSlot(slotIndex) != pipeTrackNodeP) {
+        return false;
+    }
+    unsigned int position = slotPositions[slotIndex];
+    return position < nodePs.size() && nodePs[position] == pipeTrackNodeP;
+    
+}
+
 /// Вернуть число в виде форматированной строки.
 ///
 /// \param number Число.
@@ -1,6 +1,11 @@
 #ifndef PipeTrackNode_hpp
 #define PipeTrackNode_hpp
 
+// Подключение стандартных библиотек
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
 // Подключение внутренних типов
 #include "Point.hpp"
 #include "SoLESolver.hpp"
@@ -11,6 +16,50 @@
 /// Узел трассы системы водоотведения. Представляет собой расположенный в пространстве объект системы водоотведения (прямая труба, фановая труба, редукция, отвод, тройник или крестовина).
 struct PipeTrackNode {
     
+    // MARK: - Вспомогательные типы
+    
+    /// Участок проекции узла на плоскость Oxy - прямоугольник, заданный концами главной оси и половиной ширины. Прямые трубы, фановые трубы и редукции состоят из одного участка, отводы и тройники - из двух, крестовины - из трех. Помимо исходных данных участок хранит величины, необходимые для проверки пересечения по теореме о разделяющей оси.
+    struct FootprintSegment {
+        
+        /// Первый конец главной оси участка (единица измерения - мм.).
+        Point startPoint;
+        
+        /// Второй конец главной оси участка (единица измерения - мм.).
+        Point endPoint;
+        
+        /// Половина ширины участка - половина внешнего диаметра трубы (единица измерения - мм.).
+        CalcNumber halfWidth;
+        
+        /// Половина длины главной оси участка (единица измерения - мм.).
+        CalcNumber halfLength;
+        
+        /// Координаты центра участка (единица измерения - мм.).
+        CalcNumber centerX, centerY;
+        
+        /// Координаты единичного направляющего вектора главной оси участка (для участка нулевой длины - вектор (1, 0)).
+        CalcNumber axisX, axisY;
+        
+        /// Осевые границы ограничивающего прямоугольника участка (единица измерения - мм.). Для участка, главная ось которого параллельна оси Ox или Oy, совпадают с границами самого участка.
+        CalcNumber left, right, bottom, top;
+        
+        /// Флаг участка, главная ось которого не параллельна осям Ox и Oy.
+        bool isOblique;
+        
+        /// Конструктор. Создается пустой участок нулевой длины и ширины.
+        explicit FootprintSegment();
+        
+        /// Конструктор.
+        ///
+        /// \param startPoint Первый конец главной оси участка (единица измерения - мм.).
+        /// \param endPoint Второй конец главной оси участка (единица измерения - мм.).
+        /// \param width Ширина участка (единица измерения - мм.).
+        explicit FootprintSegment(const Point & startPoint, const Point & endPoint, CalcNumber width);
+        
+    };
+    
+    /// Наибольшее число участков проекции узла.
+    static constexpr unsigned int maxFootprintSegmentsCount = 3;
+    
     // MARK: - Открытые объекты
     
     /// Тип объекта системы водоотведения.
@@ -49,6 +98,18 @@ struct PipeTrackNode {
     /// Указатель на третий предшествующий узел трассы или nullptr. Под третьим предшествующим узлом понимается узел, соединенный с третьим м-входом данного объекта (используется для типа "крестовина").
     PipeTrackNode * thirdPrevNodeP;
     
+    /// Индекс ячейки пула узлов трассы, в которой размещен узел. Устанавливается трассой при создании узла.
+    unsigned int slotIndex;
+    
+    /// Участки проекции узла на плоскость Oxy. Вычисляются при создании узла.
+    FootprintSegment footprintSegments[maxFootprintSegmentsCount];
+    
+    /// Число участков проекции узла (0, если объект системы водоотведения не задан).
+    unsigned int footprintSegmentsCount;
+    
+    /// Осевые границы ограничивающего прямоугольника всех участков проекции узла (единица измерения - мм.). Для узла без участков левая граница больше правой, а нижняя - больше верхней.
+    CalcNumber footprintLeft, footprintRight, footprintBottom, footprintTop;
+    
     // MARK: - Конструкторы
     
     /// Конструктор.
@@ -65,7 +126,7 @@ struct PipeTrackNode {
     
     // MARK: - Открытые методы
     
-    /// Проверить, пересекает ли проекция данного узла на плоскость Oxy прямоугольник данной плоскости. Касание границами пересечением не считается.
+    /// Проверить, пересекает ли проекция данного узла на плоскость Oxy прямоугольник данной плоскости. Касание границами пересечением не считается. Проверяются заранее вычисленные участки проекции узла.
     ///
     /// \param left X-координата левой границы прямоугольника (единица измерения - мм.).
     /// \param right X-координата правой границы прямоугольника (единица измерения - мм.).
@@ -87,27 +148,39 @@ struct PipeTrackNode {
     /// \return Вычисленная точка с нулевой Z-координатой (единица измерения - мм.).
     Point calculateNearestCenterPoint2D(const Point & point) const;
     
-    // MARK: - Скрытые методы
-    
-    /// Найти нормаль единичной длины к вектору vector в двумерном пространстве.
+    /// Проверить, пересекаются ли участок проекции узла и прямоугольник с параллельными осям Ox и Oy ребрами (теорема о разделяющей оси). Разделяющая ось ищется среди осей Ox, Oy, главной оси участка и нормали к ней; для участков, параллельных осям Ox и Oy, сравниваются только осевые границы, поэтому касание определяется точно. Касание границами пересечением не считается.
     ///
-    /// vector Вектор в двумерном пространстве (Z-координата не учитывается). Должен быть ненулевым.
+    /// \param segment1 Участок проекции узла.
+    /// \param left2 X-координата левой границы прямоугольника (единица измерения - мм.).
+    /// \param right2 X-координата правой границы прямоугольника (единица измерения - мм.).
+    /// \param bottom2 Y-координата нижней границы прямоугольника (единица измерения - мм.).
+    /// \param top2 Y-координата верхней границы прямоугольника (единица измерения - мм.).
     ///
-    /// \return Номальный вектор единичной длины к вектору vector. Z-координата возвращается равной 0.
-    Point calculateNormal2D(const Point & vector) const;
+    /// \return true, если пересечение есть, иначе false.
+    static bool rectanglesAreIntersected(const FootprintSegment & segment1, CalcNumber left2, CalcNumber right2, CalcNumber bottom2, CalcNumber top2);
     
-    /// Проверить, пересекаются ли два прямоугольника в двумерном пространстве. Первый прямоугольник задается концами его главной оси startPoint1 и endPoint1 и шириной width1. Второй прямоугольник содержит параллельные осям Ox и Oy ребра и задается осевыми границами left2, right2, bottom2, top2. Касание границами пересечением не считается.
+    /// Проверить пересечение одного прямоугольника с параллельными осям Ox и Oy ребрами с каждым из участков массива. Проверка выполняется тем же способом, что и для одного участка, но без ветвлений внутри цикла.
     ///
-    /// \param startPoint1 Первый конец главной оси первого прямоугольника.
-    /// \param endPoint1 Второй конец главной оси первого прямоугольника.
-    /// \param width1 Ширина первого прямоугольника.
-    /// \param left2 X-координата левой границы второго прямоугольника (единица измерения - мм.).
-    /// \param right2 X-координата правой границы второго прямоугольника (единица измерения - мм.).
-    /// \param bottom2 Y-координата нижней границы второго прямоугольника (единица измерения - мм.).
-    /// \param top2 Y-координата верхней границы второго прямоугольника (единица измерения - мм.).
+    /// \param segments1 Указатель на первый элемент массива участков.
+    /// \param segmentsCount Число участков.
+    /// \param left2 X-координата левой границы прямоугольника (единица измерения - мм.).
+    /// \param right2 X-координата правой границы прямоугольника (единица измерения - мм.).
+    /// \param bottom2 Y-координата нижней границы прямоугольника (единица измерения - мм.).
+    /// \param top2 Y-координата верхней границы прямоугольника (единица измерения - мм.).
+    /// \param results Указатель на первый элемент массива результатов длины segmentsCount. Для каждого участка записывается 1, если пересечение есть, иначе 0.
+    static void rectanglesAreIntersected(const FootprintSegment * segments1, unsigned int segmentsCount, CalcNumber left2, CalcNumber right2, CalcNumber bottom2, CalcNumber top2, unsigned char * results);
+    
+    // MARK: - Скрытые методы
+    
+    /// Вычислить участки проекции узла на плоскость Oxy и их ограничивающий прямоугольник.
+    void calculateFootprint();
+    
+    /// Добавить участок проекции узла и расширить ограничивающий прямоугольник так, чтобы он содержал участок.
     ///
-    /// \return true, если пересечение есть, иначе false.
-    bool rectanglesAreIntersected(const Point & startPoint1, const Point & endPoint1, CalcNumber width1, CalcNumber left2, CalcNumber right2, CalcNumber bottom2, CalcNumber top2) const;
+    /// \param startPoint1 Первый конец главной оси участка (единица измерения - мм.).
+    /// \param endPoint1 Второй конец главной оси участка (единица измерения - мм.).
+    /// \param width1 Ширина участка (единица измерения - мм.).
+    void addFootprintSegment(const Point & startPoint1, const Point & endPoint1, CalcNumber width1);
     
 };
 
@@ -123,15 +196,58 @@ struct PipeTrackNode {
 /// \param baseDirection Основное направление объекта (для типов "отвод", "тройник", "крестовина"). Вектор, задающий направление от центра объекта в сторону центра его п-выхода.
 /// \param secondDirection Второе направление объекта (для типов "отвод", "тройник", "крестовина"). Вектор, задающий направление второго м-входа объекта (или просто м-входа для типа "отвод") от центра данного м-входа в сторону центра объекта.
 /// \param thirdDirection Третье направление объекта (для типа "крестовина"). Вектор, задающий направление третьего м-входа объекта от центра данного м-входа в сторону центра объекта.
-PipeTrackNode::PipeTrackNode(PipeObjectType type, const PipeObject * pipeObjectP, const Point & centerPoint, const Point & startPoint, const Point & endPoint, const Point & baseDirection, const Point & secondDirection, const Point & thirdDirection): type(type), pipeObjectP(pipeObjectP), centerPoint(centerPoint), startPoint(startPoint), endPoint(endPoint), nextNodeP(nullptr), basePrevNodeP(nullptr), secondPrevNodeP(nullptr), thirdPrevNodeP(nullptr) {
+PipeTrackNode::PipeTrackNode(PipeObjectType type, const PipeObject * pipeObjectP, const Point & centerPoint, const Point & startPoint, const Point & endPoint, const Point & baseDirection, const Point & secondDirection, const Point & thirdDirection): type(type), pipeObjectP(pipeObjectP), centerPoint(centerPoint), startPoint(startPoint), endPoint(endPoint), nextNodeP(nullptr), basePrevNodeP(nullptr), secondPrevNodeP(nullptr), thirdPrevNodeP(nullptr), slotIndex(0) {
     
     this->baseDirection = baseDirection/baseDirection.length();
     this->secondDirection = secondDirection/secondDirection.length();
     this->thirdDirection = thirdDirection/thirdDirection.length();
     
+    calculateFootprint();
+    
 }
 
-/// Проверить, пересекает ли проекция данного узла на плоскость Oxy прямоугольник данной плоскости. Касание границами пересечением не считается.
+/// Конструктор. Создается пустой участок нулевой длины и ширины.
+PipeTrackNode::FootprintSegment::FootprintSegment(): halfWidth(0), halfLength(0), centerX(0), centerY(0), axisX(1), axisY(0), left(0), right(0), bottom(0), top(0), isOblique(false) {}
+
+/// Конструктор.
+///
+/// \param startPoint Первый конец главной оси участка (единица измерения - мм.).
+/// \param endPoint Второй конец главной оси участка (единица измерения - мм.).
+/// \param width Ширина участка (единица измерения - мм.).
+PipeTrackNode::FootprintSegment::FootprintSegment(const Point & startPoint, const Point & endPoint, CalcNumber width): startPoint(startPoint), endPoint(endPoint), halfWidth(width / 2) {
+    
+    CalcNumber directionX = endPoint.x - startPoint.x, directionY = endPoint.y - startPoint.y;
+    CalcNumber length = std::sqrt(directionX * directionX + directionY * directionY);
+    halfLength = length / 2;
+    centerX = (startPoint.x + endPoint.x) / 2;
+    centerY = (startPoint.y + endPoint.y) / 2;
+    axisX = (length == 0) ? 1 : directionX / length;
+    axisY = (length == 0) ? 0 : directionY / length;
+    isOblique = (directionX != 0 && directionY != 0);
+    
+    if (isOblique) {
+        // ограничивающий прямоугольник повернутого прямоугольника
+        CalcNumber extentX = halfLength * std::fabs(axisX) + halfWidth * std::fabs(axisY);
+        CalcNumber extentY = halfLength * std::fabs(axisY) + halfWidth * std::fabs(axisX);
+        left = centerX - extentX;
+        right = centerX + extentX;
+        bottom = centerY - extentY;
+        top = centerY + extentY;
+    } else if (directionX == 0) {
+        left = startPoint.x - halfWidth;
+        right = startPoint.x + halfWidth;
+        bottom = std::min(startPoint.y, endPoint.y);
+        top = std::max(startPoint.y, endPoint.y);
+    } else {
+        left = std::min(startPoint.x, endPoint.x);
+        right = std::max(startPoint.x, endPoint.x);
+        bottom = startPoint.y - halfWidth;
+        top = startPoint.y + halfWidth;
+    }
+    
+}
+
+/// Проверить, пересекает ли проекция данного узла на плоскость Oxy прямоугольник данной плоскости. Касание границами пересечением не считается. Проверяются заранее вычисленные участки проекции узла.
 ///
 /// \param left X-координата левой границы прямоугольника (единица измерения - мм.).
 /// \param right X-координата правой границы прямоугольника (единица измерения - мм.).
@@ -141,42 +257,17 @@ PipeTrackNode::PipeTrackNode(PipeObjectType type, const PipeObject * pipeObjectP
 /// \return true, если пересечение есть, иначе false.
 bool PipeTrackNode::isIntersectedWithRectangle(CalcNumber left, CalcNumber right, CalcNumber bottom, CalcNumber top) const {
     
-    unsigned int diameter, externalDiameter, baseDiameter, baseExternalDiameter, extraDiameter, extraExternalDiameter, secondDiameter, secondExternalDiameter, thirdDiameter, thirdExternalDiameter;
-    
-    switch (type) {
-            
-        case direct:
-        case fan:
-        case reduction:
-            diameter = (type == direct) ? static_cast<const DirectPipe*>(pipeObjectP)->diameter : (type == fan) ? static_cast<const FanPipe*>(pipeObjectP)->diameter : static_cast<const ReductionPipe*>(pipeObjectP)->fDiameter;
-            externalDiameter = pipeObjectP->externalDiameterForDiameterP->find(diameter)->second;
-            return rectanglesAreIntersected(startPoint, endPoint, externalDiameter, left, right, bottom, top);
-        case angle:
-            diameter = static_cast<const AnglePipe*>(pipeObjectP)->diameter();
-            externalDiameter = pipeObjectP->externalDiameterForDiameterP->find(diameter)->second;
-            return rectanglesAreIntersected(centerPoint, centerPoint + baseDirection * static_cast<const AnglePipe*>(pipeObjectP)->fLength(), externalDiameter, left, right, bottom, top)
-            || rectanglesAreIntersected(centerPoint, centerPoint - secondDirection * static_cast<const AnglePipe*>(pipeObjectP)->mLength(), externalDiameter, left, right, bottom, top);
-        case tee:
-            baseDiameter = static_cast<const TeePipe*>(pipeObjectP)->baseDiameter;
-            baseExternalDiameter = pipeObjectP->externalDiameterForDiameterP->find(baseDiameter)->second;
-            extraDiameter = static_cast<const TeePipe*>(pipeObjectP)->extraDiameter;
-            extraExternalDiameter = pipeObjectP->externalDiameterForDiameterP->find(extraDiameter)->second;
-            return rectanglesAreIntersected(centerPoint + baseDirection * static_cast<const TeePipe*>(pipeObjectP)->fLength, centerPoint - baseDirection * static_cast<const TeePipe*>(pipeObjectP)->baseMLength, baseExternalDiameter, left, right, bottom, top)
-            || rectanglesAreIntersected(centerPoint, centerPoint - secondDirection * static_cast<const TeePipe*>(pipeObjectP)->extraMLength, extraExternalDiameter, left, right, bottom, top);
-        case cross:
-            baseDiameter = static_cast<const CrossPipe*>(pipeObjectP)->baseDiameter;
-            baseExternalDiameter = pipeObjectP->externalDiameterForDiameterP->find(baseDiameter)->second;
-            secondDiameter = static_cast<const CrossPipe*>(pipeObjectP)->secondDiameter;
-            secondExternalDiameter = pipeObjectP->externalDiameterForDiameterP->find(secondDiameter)->second;
-            thirdDiameter = static_cast<const CrossPipe*>(pipeObjectP)->thirdDiameter;
-            thirdExternalDiameter = pipeObjectP->externalDiameterForDiameterP->find(thirdDiameter)->second;
-            return rectanglesAreIntersected(centerPoint + baseDirection * static_cast<const CrossPipe*>(pipeObjectP)->fLength, centerPoint - baseDirection * static_cast<const CrossPipe*>(pipeObjectP)->baseMLength, baseExternalDiameter, left, right, bottom, top)
-            || rectanglesAreIntersected(centerPoint, centerPoint - secondDirection * static_cast<const CrossPipe*>(pipeObjectP)->secondMLength, secondExternalDiameter, left, right, bottom, top)
-            || rectanglesAreIntersected(centerPoint, centerPoint - thirdDirection * static_cast<const CrossPipe*>(pipeObjectP)->thirdMLength, thirdExternalDiameter, left, right, bottom, top);
-            
+    if (footprintLeft >= right || footprintRight <= left || footprintBottom >= top || footprintTop <= bottom) {
+        return false;
     }
     
-    assert(false);
+    for (unsigned int i = 0; i < footprintSegmentsCount; i++) {
+        const FootprintSegment & segment = footprintSegments[i];
+        if (rectanglesAreIntersected(segment, left, right, bottom, top)) {
+            return true;
+        }
+    }
+    return false;
     
 }
 
@@ -258,173 +349,118 @@ CalcNumber PipeTrackNode::calculateCost() const {
     
 }
 
-/// Найти нормаль единичной длины к вектору vector в двумерном пространстве.
+/// Проверить, пересекаются ли участок проекции узла и прямоугольник с параллельными осям Ox и Oy ребрами (теорема о разделяющей оси). Разделяющая ось ищется среди осей Ox, Oy, главной оси участка и нормали к ней; для участков, параллельных осям Ox и Oy, сравниваются только осевые границы, поэтому касание определяется точно. Касание границами пересечением не считается.
 ///
-/// vector Вектор в двумерном пространстве (Z-координата не учитывается). Должен быть ненулевым.
+/// \param segment1 Участок проекции узла.
+/// \param left2 X-координата левой границы прямоугольника (единица измерения - мм.).
+/// \param right2 X-координата правой границы прямоугольника (единица измерения - мм.).
+/// \param bottom2 Y-координата нижней границы прямоугольника (единица измерения - мм.).
+/// \param top2 Y-координата верхней границы прямоугольника (единица измерения - мм.).
 ///
-/// \return Номальный вектор единичной длины к вектору vector. Z-координата возвращается равной 0.
-Point PipeTrackNode::calculateNormal2D(const Point & vector) const {
-    
-    CalcNumber x = vector.x, y = vector.y;
-    Point resultVector = Point(0, 0, 0);
+/// \return true, если пересечение есть, иначе false.
+bool PipeTrackNode::rectanglesAreIntersected(const FootprintSegment & segment1, CalcNumber left2, CalcNumber right2, CalcNumber bottom2, CalcNumber top2) {
     
-    assert(x != 0 || y != 0);
+    unsigned char result;
+    rectanglesAreIntersected(&segment1, 1, left2, right2, bottom2, top2, &result);
+    return result != 0;
     
-    if (x != 0) {
-        resultVector.x = -y/x;
-        resultVector.y = 1;
-    } else {
-        resultVector.x = 1;
-        resultVector.y = -x/y;
+}
+
+/// Проверить пересечение одного прямоугольника с параллельными осям Ox и Oy ребрами с каждым из участков массива. Проверка выполняется тем же способом, что и для одного участка, но без ветвлений внутри цикла.
+///
+/// \param segments1 Указатель на первый элемент массива участков.
+/// \param segmentsCount Число участков.
+/// \param left2 X-координата левой границы прямоугольника (единица измерения - мм.).
+/// \param right2 X-координата правой границы прямоугольника (единица измерения - мм.).
+/// \param bottom2 Y-координата нижней границы прямоугольника (единица измерения - мм.).
+/// \param top2 Y-координата верхней границы прямоугольника (единица измерения - мм.).
+/// \param results Указатель на первый элемент массива результатов длины segmentsCount. Для каждого участка записывается 1, если пересечение есть, иначе 0.
+void PipeTrackNode::rectanglesAreIntersected(const FootprintSegment * segments1, unsigned int segmentsCount, CalcNumber left2, CalcNumber right2, CalcNumber bottom2, CalcNumber top2, unsigned char * results) {
+    
+    // центр и половины размеров прямоугольника
+    CalcNumber centerX2 = (left2 + right2) / 2, centerY2 = (bottom2 + top2) / 2;
+    CalcNumber halfSizeX2 = (right2 - left2) / 2, halfSizeY2 = (top2 - bottom2) / 2;
+    
+    for (unsigned int i = 0; i < segmentsCount; i++) {
+        const FootprintSegment & segment1 = segments1[i];
+        
+        // оси Ox и Oy: сравнение осевых границ (для наклонного участка - границ его ограничивающего прямоугольника)
+        bool isSeparatedByAxes = (segment1.left >= right2) | (segment1.right <= left2) | (segment1.bottom >= top2) | (segment1.top <= bottom2);
+        
+        // главная ось участка и нормаль к ней (проверяются только для наклонного участка)
+        CalcNumber dx = segment1.centerX - centerX2, dy = segment1.centerY - centerY2;
+        CalcNumber absAxisX = std::fabs(segment1.axisX), absAxisY = std::fabs(segment1.axisY);
+        bool isSeparatedByAxis = std::fabs(dx * segment1.axisX + dy * segment1.axisY) >= segment1.halfLength + halfSizeX2 * absAxisX + halfSizeY2 * absAxisY;
+        bool isSeparatedByNormal = std::fabs(dy * segment1.axisX - dx * segment1.axisY) >= segment1.halfWidth + halfSizeX2 * absAxisY + halfSizeY2 * absAxisX;
+        
+        results[i] = !(isSeparatedByAxes | (segment1.isOblique & (isSeparatedByAxis | isSeparatedByNormal)));
     }
     
-    return resultVector/resultVector.length();
-    
 }
 
-/// Проверить, пересекаются ли два прямоугольника в двумерном пространстве. Первый прямоугольник задается концами его главной оси startPoint1 и endPoint1 и шириной width1. Второй прямоугольник содержит параллельные осям Ox и Oy ребра и задается осевыми границами left2, right2, bottom2, top2. Касание границами пересечением не считается.
-///
-/// \param startPoint1 Первый конец главной оси первого прямоугольника.
-/// \param endPoint1 Второй конец главной оси первого прямоугольника.
-/// \param width1 Ширина первого прямоугольника.
-/// \param left2 X-координата левой границы второго прямоугольника (единица измерения - мм.).
-/// \param right2 X-координата правой границы второго прямоугольника (единица измерения - мм.).
-/// \param bottom2 Y-координата нижней границы второго прямоугольника (единица измерения - мм.).
-/// \param top2 Y-координата верхней границы второго прямоугольника (единица измерения - мм.).
-///
-/// \return true, если пересечение есть, иначе false.
-bool PipeTrackNode::rectanglesAreIntersected(const Point & startPoint1, const Point & endPoint1, CalcNumber width1, CalcNumber left2, CalcNumber right2, CalcNumber bottom2, CalcNumber top2) const {
+/// Вычислить участки проекции узла на плоскость Oxy и их ограничивающий прямоугольник.
+void PipeTrackNode::calculateFootprint() {
     
-    // направляющий вектор главной оси первого прямоугольника
-    Point direction = endPoint - startPoint;
+    footprintSegmentsCount = 0;
+    footprintLeft = footprintBottom = std::numeric_limits<CalcNumber>::max();
+    footprintRight = footprintTop = std::numeric_limits<CalcNumber>::lowest();
     
-    // Рассматриваются два случая. Первый случай - ребра первого прямоугольника параллельны осям Ox и Oy. Второй случай - обратный.
+    if (pipeObjectP == nullptr) {
+        return;
+    }
     
-    if (direction.x == 0 || direction.y == 0) {
-        
-        // первый случай (у первого прямоугольника прямые ребра)
-        
-        // Шаг 1. Для первого прямоугольника находятся осевые границы left1, right1, bottom1, top1.
-        CalcNumber left1, right1, bottom1, top1;
-        if (direction.x == 0) {
-            left1 = startPoint.x - width1 / 2;
-            right1 = startPoint.x + width1 / 2;
-            bottom1 = std::min(startPoint.y, endPoint.y);
-            top1 = std::max(startPoint.y, endPoint.y);
-        } else {
-            left1 = std::min(startPoint.x, endPoint.x);
-            right1 = std::max(startPoint.x, endPoint.x);
-            bottom1 = startPoint.y - width1 / 2;
-            top1 = startPoint.y + width1 / 2;
-        }
-        
-        // Шаг 2. Попытка определить отсутствие пересечения.
-        if (left1 >= right2 || right1 <= left2 || bottom1 >= top2 || top1 <= bottom2) {
-            return false;
-        }
-        
-        // Шаг 3. Проверяются условия пересечения прямоугольников.
-        if (left1 == left2 || right1 == right2) {
-            if (bottom1 == bottom2 || top1 == top2) {
-                return true;
-            }
-            if (bottom1 < bottom2) {
-                return (top1 > bottom2);
-            } else {
-                // bottom1 > bottom2
-                return (bottom1 < top2);
-            }
-        } else if (top1 == top2 || bottom1 == bottom2) {
-            if (left1 == left2 || right1 == right2) {
-                return true;
-            }
-            if (left1 < left2) {
-                return (right1 > left2);
-            } else {
-                // left1 > left2
-                return (left1 < right2);
-            }
-        } else {
-            if (left1 < left2 && left2 < right1 && bottom1 < bottom2 && bottom2 < top1) {
-                return true;
-            }
-            if (left1 < left2 && left2 < right1 && bottom1 < top2 && top2 < top1) {
-                return true;
-            }
-            if (left1 < right2 && right2 < right1 && bottom1 < bottom2 && bottom2 < top1) {
-                return true;
-            }
-            if (left1 < right2 && right2 < right1 && bottom1 < top2 && top2 < top1) {
-                return true;
-            }
-            if (left2 < left1 && left1 < right2 && bottom2 < bottom1 && bottom1 < top2) {
-                return true;
-            }
-            if (left2 < left1 && left1 < right2 && bottom2 < top1 && top1 < top2) {
-                return true;
-            }
-            if (left2 < right1 && right1 < right2 && bottom2 < bottom1 && bottom1 < top2) {
-                return true;
-            }
-            if (left2 < right1 && right1 < right2 && bottom2 < top1 && top1 < top2) {
-                return true;
-            }
-            return false;
-        }
-        
-    } else {
-        
-        // второй случай (у первого прямоугольника косые ребра)
-        
-        // Для этого случая прямоугольники пересекаются тогда и только тогда, когда пересекается (не касается) некоторая пара ребер этих прямоугольников.
-        
-        // Шаг 1. Попытка определить отсутствие пересечения.
-        CalcNumber left1WithReserve = std::min(startPoint1.x, endPoint1.x) - width1;
-        CalcNumber right1WithReserve = std::max(startPoint1.x, endPoint1.x) + width1;
-        CalcNumber bottom1WithReserve = std::min(startPoint1.y, endPoint1.y) - width1;
-        CalcNumber top1WithReserve = std::max(startPoint1.y, endPoint1.y) + width1;
-        if (left1WithReserve >= right2 || right1WithReserve <= left2 || bottom1WithReserve >= top2 || top1WithReserve <= bottom2) {
-            return false;
-        }
-        
-        // Шаг 2. Для каждой пары ребер проверяется, пересекаются ли они.
-        Point direction1 = endPoint1 - startPoint1;
-        Point normal1 = calculateNormal2D(direction1) * (CalcNumber(width1) / 2);
-        std::vector<std::pair<Point, Point>> edges1 = {
-            std::pair(startPoint1 + normal1, startPoint1 - normal1),
-            std::pair(endPoint1 + normal1, endPoint1 - normal1),
-            std::pair(startPoint1 + normal1, endPoint1 + normal1),
-            std::pair(startPoint1 - normal1, endPoint1 - normal1)
-        };
-        std::vector<std::pair<Point, Point>> edges2 = {
-            std::pair(Point(left2, bottom2, 0), Point(left2, top2, 0)),
-            std::pair(Point(right2, bottom2, 0), Point(right2, top2, 0)),
-            std::pair(Point(left2, bottom2, 0), Point(right2, bottom2, 0)),
-            std::pair(Point(left2, top2, 0), Point(right2, top2, 0))
-        };
-        for (const std::pair<Point, Point> & edge1 : edges1) {
-            for (const std::pair<Point, Point> & edge2 : edges2) {
-                // проверка пересечения ребер edge1 и edge2
-                CalcNumber a11 = edge1.first.x - edge1.second.x;
-                CalcNumber a12 = edge2.second.x - edge2.first.x;
-                CalcNumber a21 = edge1.first.y - edge1.second.y;
-                CalcNumber a22 = edge2.second.y - edge2.first.y;
-                CalcNumber b1 = edge2.second.x - edge1.second.x;
-                CalcNumber b2 = edge2.second.y - edge1.second.y;
-                CalcNumber betta = (a11 * a22 - a21 * a12) / (a11 * b2 - a21 * b1);
-                CalcNumber alfa = (b1 - a12 * betta) / a11;
-                if (0 <= alfa && alfa <= 1 && 0 <= betta && betta <= 1) {
-                    // касание ребер есть
-                    // возможны выожденные случаи, когда метод вернет true в случае касания прямоугольников границами, что не соответствует описанию метода
-                    // \todo исправить данный недочет
-                    return true;
-                }
-            }
-        }
-        return false;
-        
+    unsigned int diameter, externalDiameter, baseExternalDiameter, extraExternalDiameter, secondExternalDiameter, thirdExternalDiameter;
+    
+    switch (type) {
+            
+        case direct:
+        case fan:
+        case reduction:
+            diameter = (type == direct) ? static_cast<const DirectPipe*>(pipeObjectP)->diameter : (type == fan) ? static_cast<const FanPipe*>(pipeObjectP)->diameter : static_cast<const ReductionPipe*>(pipeObjectP)->fDiameter;
+            externalDiameter = pipeObjectP->externalDiameterForDiameterP->find(diameter)->second;
+            addFootprintSegment(startPoint, endPoint, externalDiameter);
+            return;
+        case angle:
+            externalDiameter = pipeObjectP->externalDiameterForDiameterP->find(static_cast<const AnglePipe*>(pipeObjectP)->diameter())->second;
+            addFootprintSegment(centerPoint, centerPoint + baseDirection * static_cast<const AnglePipe*>(pipeObjectP)->fLength(), externalDiameter);
+            addFootprintSegment(centerPoint, centerPoint - secondDirection * static_cast<const AnglePipe*>(pipeObjectP)->mLength(), externalDiameter);
+            return;
+        case tee:
+            baseExternalDiameter = pipeObjectP->externalDiameterForDiameterP->find(static_cast<const TeePipe*>(pipeObjectP)->baseDiameter)->second;
+            extraExternalDiameter = pipeObjectP->externalDiameterForDiameterP->find(static_cast<const TeePipe*>(pipeObjectP)->extraDiameter)->second;
+            addFootprintSegment(centerPoint + baseDirection * static_cast<const TeePipe*>(pipeObjectP)->fLength, centerPoint - baseDirection * static_cast<const TeePipe*>(pipeObjectP)->baseMLength, baseExternalDiameter);
+            addFootprintSegment(centerPoint, centerPoint - secondDirection * static_cast<const TeePipe*>(pipeObjectP)->extraMLength, extraExternalDiameter);
+            return;
+        case cross:
+            baseExternalDiameter = pipeObjectP->externalDiameterForDiameterP->find(static_cast<const CrossPipe*>(pipeObjectP)->baseDiameter)->second;
+            secondExternalDiameter = pipeObjectP->externalDiameterForDiameterP->find(static_cast<const CrossPipe*>(pipeObjectP)->secondDiameter)->second;
+            thirdExternalDiameter = pipeObjectP->externalDiameterForDiameterP->find(static_cast<const CrossPipe*>(pipeObjectP)->thirdDiameter)->second;
+            addFootprintSegment(centerPoint + baseDirection * static_cast<const CrossPipe*>(pipeObjectP)->fLength, centerPoint - baseDirection * static_cast<const CrossPipe*>(pipeObjectP)->baseMLength, baseExternalDiameter);
+            addFootprintSegment(centerPoint, centerPoint - secondDirection * static_cast<const CrossPipe*>(pipeObjectP)->secondMLength, secondExternalDiameter);
+            addFootprintSegment(centerPoint, centerPoint - thirdDirection * static_cast<const CrossPipe*>(pipeObjectP)->thirdMLength, thirdExternalDiameter);
+            return;
+            
     }
     
+    assert(false);
+    
+}
+
+/// Добавить участок проекции узла и расширить ограничивающий прямоугольник так, чтобы он содержал участок.
+///
+/// \param startPoint1 Первый конец главной оси участка (единица измерения - мм.).
+/// \param endPoint1 Второй конец главной оси участка (единица измерения - мм.).
+/// \param width1 Ширина участка (единица измерения - мм.).
+void PipeTrackNode::addFootprintSegment(const Point & startPoint1, const Point & endPoint1, CalcNumber width1) {
+    
+    assert(footprintSegmentsCount < maxFootprintSegmentsCount);
+    const FootprintSegment & segment = footprintSegments[footprintSegmentsCount++] = FootprintSegment(startPoint1, endPoint1, width1);
+    
+    footprintLeft = std::min(footprintLeft, segment.left);
+    footprintRight = std::max(footprintRight, segment.right);
+    footprintBottom = std::min(footprintBottom, segment.bottom);
+    footprintTop = std::max(footprintTop, segment.top);
+    
 }
 
 #endif /* PipeTrackNode_hpp */
@@ -0,0 +1,71 @@
+#ifndef PipeTrackNodeTester_hpp
+#define PipeTrackNodeTester_hpp
+
+// Подключение стандартных библиотек
+#include <string>
+#include <iostream>
+#include <cassert>
+
+// Подключение внутренних типов
+#include "PipeTrackNode.hpp"
+
+/// Тестер для класса PipeTrackNode.
+class PipeTrackNodeTester {
+    
+public:
+    
+    // MARK: - Открытые методы
+    
+    /// Тестировать класс PipeTrackNode.
+    void test();
+    
+};
+
+// MARK: - Реализация
+
+/// Тестировать класс PipeTrackNode.
+void PipeTrackNodeTester::test() {
+    
+    typedef PipeTrackNode::FootprintSegment Segment;
+    
+    // участок, параллельный оси Ox: прямоугольник [0, 100] x [-10, 10]
+    Segment horizontal(Point(0, 0, 0), Point(100, 0, 0), 20);
+    assert(horizontal.left == 0 && horizontal.right == 100 && horizontal.bottom == -10 && horizontal.top == 10);
+    assert(PipeTrackNode::rectanglesAreIntersected(horizontal, 100, 200, -10, 10) == false);
+    assert(PipeTrackNode::rectanglesAreIntersected(horizontal, 20, 40, 10, 30) == false);
+    assert(PipeTrackNode::rectanglesAreIntersected(horizontal, 40, 60, -50, 50) == true);
+    assert(PipeTrackNode::rectanglesAreIntersected(horizontal, 10, 20, -5, 5) == true);
+    assert(PipeTrackNode::rectanglesAreIntersected(horizontal, -50, 150, -50, 50) == true);
+    
+    // участок, параллельный оси Oy: прямоугольник [-10, 10] x [0, 100]
+    Segment vertical(Point(0, 100, 0), Point(0, 0, 0), 20);
+    assert(PipeTrackNode::rectanglesAreIntersected(vertical, -50, 50, 40, 60) == true);
+    assert(PipeTrackNode::rectanglesAreIntersected(vertical, 10, 20, 0, 100) == false);
+    
+    // наклонный участок вдоль прямой y = x шириной 2 * sqrt(2)
+    Segment oblique(Point(0, 0, 0), Point(100, 100, 0), 2 * sqrt(2));
+    assert(oblique.isOblique);
+    assert(PipeTrackNode::rectanglesAreIntersected(oblique, 45, 55, 45, 55) == true);
+    assert(PipeTrackNode::rectanglesAreIntersected(oblique, 60, 100, 0, 30) == false);
+    assert(PipeTrackNode::rectanglesAreIntersected(oblique, 49, 51, 51, 53) == true);
+    assert(PipeTrackNode::rectanglesAreIntersected(oblique, 50, 52, 55, 57) == false);
+    assert(PipeTrackNode::rectanglesAreIntersected(oblique, 102, 110, 102, 110) == false);
+    
+    // прямоугольник выше наклонного участка, но внутри его ограничивающего прямоугольника
+    Segment longOblique(Point(6929.6, -82.7973, 0), Point(-3016.62, -1157.33, 0), 54);
+    assert(PipeTrackNode::rectanglesAreIntersected(longOblique, 6841.51, 7977.15, -30.7785, 85.8272) == false);
+    
+    // пакетная проверка совпадает с проверкой отдельных участков
+    Segment segments[] = { horizontal, vertical, oblique, longOblique };
+    unsigned char results[4];
+    PipeTrackNode::rectanglesAreIntersected(segments, 4, 40, 60, -50, 50, results);
+    for (unsigned int i = 0; i < 4; i++) {
+        assert((results[i] != 0) == PipeTrackNode::rectanglesAreIntersected(segments[i], 40, 60, -50, 50));
+    }
+    assert(results[0] == 1 && results[1] == 0 && results[2] == 1 && results[3] == 0);
+    
+    std::cout << "Тестирование класса PipeTrackNode завершилось успешно.\n";
+    
+}
+
+#endif /* PipeTrackNodeTester_hpp */
@@ -0,0 +1,292 @@
+#ifndef PipeTrackSpatialIndex_hpp
+#define PipeTrackSpatialIndex_hpp
+
+// Подключение стандартных библиотек
+#include <vector>
+#include <map>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+
+// Подключение внутренних типов
+#include "CalcNumber.hpp"
+#include "Point.hpp"
+
+/// Пространственный индекс узлов трассы на плоскости Oxy (поиск ближайших узлов). Плоскость разбита на квадратные ячейки одинакового размера; каждый узел, заданный индексом ячейки пула трассы, регистрируется во всех ячейках, которые пересекает его ограничивающий прямоугольник. Индекс позволяет перебирать узлы кольцами ячеек вокруг точки в порядке удаления колец. Индекс хранит индексы ячеек пула, а не указатели, поэтому копируется вместе с трассой без изменений.
+class PipeTrackSpatialIndex {
+    
+public:
+    
+    // MARK: - Вспомогательные типы
+    
+    /// Ограничивающий прямоугольник с ребрами, параллельными осям Ox и Oy (единица измерения - мм.).
+    struct BoundingBox {
+        
+        /// X-координата левой границы.
+        CalcNumber left;
+        
+        /// X-координата правой границы.
+        CalcNumber right;
+        
+        /// Y-координата нижней границы.
+        CalcNumber bottom;
+        
+        /// Y-координата верхней границы.
+        CalcNumber top;
+        
+    };
+    
+private:
+    
+    // MARK: - Скрытые объекты
+    
+    /// Размер ячейки сетки (единица измерения - мм.).
+    CalcNumber cellSize;
+    
+    /// Ограничивающие прямоугольники узлов по индексам ячеек пула трассы.
+    std::vector<BoundingBox> boundingBoxes;
+    
+    /// Флаги наличия узлов в индексе по индексам ячеек пула трассы.
+    std::vector<unsigned char> slotIsIndexed;
+    
+    /// Словарь, в котором для каждой непустой ячейки сетки, заданной парой номеров (столбец, строка), содержится массив индексов ячеек пула зарегистрированных в ней узлов.
+    std::map<std::pair<long long, long long>, std::vector<unsigned int>> slotIndexesForCell;
+    
+    /// Номера крайних столбцов и строк ячеек сетки, в которых когда-либо регистрировались узлы. При удалении узлов границы не сужаются.
+    long long minColumn, maxColumn, minRow, maxRow;
+    
+public:
+    
+    // MARK: - Конструкторы
+    
+    /// Конструктор. Создается пустой индекс.
+    ///
+    /// \param cellSize Размер ячейки сетки (единица измерения - мм.). Должен быть положительным.
+    explicit PipeTrackSpatialIndex(CalcNumber cellSize);
+    
+    // MARK: - Открытые методы
+    
+    /// Добавить узел в индекс.
+    ///
+    /// \param slotIndex Индекс ячейки пула трассы, в которой размещен узел. Узел не должен содержаться в индексе.
+    /// \param boundingBox Ограничивающий прямоугольник проекции узла на плоскость Oxy.
+    void insert(unsigned int slotIndex, const BoundingBox & boundingBox);
+    
+    /// Удалить узел из индекса.
+    ///
+    /// \param slotIndex Индекс ячейки пула трассы, в которой размещен узел. Если узел не содержится в индексе, метод ничего не делает.
+    void remove(unsigned int slotIndex);
+    
+    /// Вернуть ограничивающий прямоугольник узла.
+    ///
+    /// \param slotIndex Индекс ячейки пула трассы, в которой размещен узел. Узел должен содержаться в индексе.
+    ///
+    /// \return Ограничивающий прямоугольник проекции узла на плоскость Oxy.
+    const BoundingBox & boundingBoxOf(unsigned int slotIndex) const;
+    
+    /// Вернуть размер ячейки сетки.
+    ///
+    /// \return Размер ячейки сетки (единица измерения - мм.).
+    CalcNumber getCellSize() const;
+    
+    /// Найти узлы, зарегистрированные в кольце ячеек сетки вокруг точки. Кольцо с номером ring состоит из ячеек, номера столбца и строки которых отличаются от номеров ячейки точки не более чем на ring, причем хотя бы один - ровно на ring. Расстояние от точки до любой точки ячеек кольца не меньше (ring - 1) * cellSize.
+    ///
+    /// \param point Точка (единица измерения - мм.). Z-координата не учитывается.
+    /// \param ring Номер кольца.
+    ///
+    /// \return Индексы ячеек пула найденных узлов в порядке возрастания.
+    std::vector<unsigned int> findSlotIndexesInRing(const Point & point, unsigned int ring) const;
+    
+    /// Вычислить наибольший номер кольца ячеек вокруг точки, содержащего ячейки, в которых регистрировались узлы.
+    ///
+    /// \param point Точка (единица измерения - мм.). Z-координата не учитывается.
+    ///
+    /// \return Номер кольца или -1, если в индексе никогда не было узлов.
+    long long calculateLastRing(const Point & point) const;
+    
+private:
+    
+    // MARK: - Скрытые методы
+    
+    /// Вычислить номер столбца или строки ячейки сетки, содержащей координату.
+    ///
+    /// \param coordinate Координата (единица измерения - мм.).
+    ///
+    /// \return Номер столбца или строки.
+    long long cellNumberOf(CalcNumber coordinate) const;
+    
+    /// Добавить к массиву индексы ячеек пула узлов, зарегистрированных в ячейке сетки.
+    ///
+    /// \param column Номер столбца ячейки.
+    /// \param row Номер строки ячейки.
+    /// \param slotIndexes Массив, к которому добавляются индексы.
+    void appendSlotIndexesOfCell(long long column, long long row, std::vector<unsigned int> & slotIndexes) const;
+    
+};
+
+// MARK: - Реализация
+
+/// Конструктор. Создается пустой индекс.
+///
+/// \param cellSize Размер ячейки сетки (единица измерения - мм.). Должен быть положительным.
+PipeTrackSpatialIndex::PipeTrackSpatialIndex(CalcNumber cellSize): cellSize(cellSize), minColumn(0), maxColumn(-1), minRow(0), maxRow(-1) {}
+
+/// Добавить узел в индекс.
+///
+/// \param slotIndex Индекс ячейки пула трассы, в которой размещен узел. Узел не должен содержаться в индексе.
+/// \param boundingBox Ограничивающий прямоугольник проекции узла на плоскость Oxy.
+void PipeTrackSpatialIndex::insert(unsigned int slotIndex, const BoundingBox & boundingBox) {
+    
+    if (slotIndex >= boundingBoxes.size()) {
+        boundingBoxes.resize(slotIndex + 1);
+        slotIsIndexed.resize(slotIndex + 1, 0);
+    }
+    boundingBoxes[slotIndex] = boundingBox;
+    slotIsIndexed[slotIndex] = 1;
+    
+    long long firstColumn = cellNumberOf(boundingBox.left), lastColumn = cellNumberOf(boundingBox.right);
+    long long firstRow = cellNumberOf(boundingBox.bottom), lastRow = cellNumberOf(boundingBox.top);
+    for (long long column = firstColumn; column <= lastColumn; column++) {
+        for (long long row = firstRow; row <= lastRow; row++) {
+            slotIndexesForCell[std::make_pair(column, row)].push_back(slotIndex);
+        }
+    }
+    
+    if (minColumn > maxColumn) {
+        minColumn = firstColumn;
+        maxColumn = lastColumn;
+        minRow = firstRow;
+        maxRow = lastRow;
+    } else {
+        minColumn = std::min(minColumn, firstColumn);
+        maxColumn = std::max(maxColumn, lastColumn);
+        minRow = std::min(minRow, firstRow);
+        maxRow = std::max(maxRow, lastRow);
+    }
+    
+}
+
+/// Удалить узел из индекса.
+///
+/// \param slotIndex Индекс ячейки пула трассы, в которой размещен узел. Если узел не содержится в индексе, метод ничего не делает.
+void PipeTrackSpatialIndex::remove(unsigned int slotIndex) {
+    
+    if (slotIndex >= slotIsIndexed.size() || slotIsIndexed[slotIndex] == 0) {
+        return;
+    }
+    slotIsIndexed[slotIndex] = 0;
+    
+    const BoundingBox & boundingBox = boundingBoxes[slotIndex];
+    long long firstColumn = cellNumberOf(boundingBox.left), lastColumn = cellNumberOf(boundingBox.right);
+    long long firstRow = cellNumberOf(boundingBox.bottom), lastRow = cellNumberOf(boundingBox.top);
+    for (long long column = firstColumn; column <= lastColumn; column++) {
+        for (long long row = firstRow; row <= lastRow; row++) {
+            auto cellIter = slotIndexesForCell.find(std::make_pair(column, row));
+            std::vector<unsigned int> & slotIndexes = cellIter->second;
+            slotIndexes.erase(std::find(slotIndexes.begin(), slotIndexes.end(), slotIndex));
+            if (slotIndexes.size() == 0) {
+                slotIndexesForCell.erase(cellIter);
+            }
+        }
+    }
+    
+}
+
+/// Вернуть ограничивающий прямоугольник узла.
+///
+/// \param slotIndex Индекс ячейки пула трассы, в которой размещен узел. Узел должен содержаться в индексе.
+///
+/// \return Ограничивающий прямоугольник проекции узла на плоскость Oxy.
+const PipeTrackSpatialIndex::BoundingBox & PipeTrackSpatialIndex::boundingBoxOf(unsigned int slotIndex) const {
+    
+    return boundingBoxes[slotIndex];
+    
+}
+
+/// Вернуть размер ячейки сетки.
+///
+/// \return Размер ячейки сетки (единица измерения - мм.).
+CalcNumber PipeTrackSpatialIndex::getCellSize() const {
+    
+    return cellSize;
+    
+}
+
+/// Найти узлы, зарегистрированные в кольце ячеек сетки вокруг точки. Кольцо с номером ring состоит из ячеек, номера столбца и строки которых отличаются от номеров ячейки точки не более чем на ring, причем хотя бы один - ровно на ring. Расстояние от точки до любой точки ячеек кольца не меньше (ring - 1) * cellSize.
+///
+/// \param point Точка (единица измерения - мм.). Z-координата не учитывается.
+/// \param ring Номер кольца.
+///
+/// \return Индексы ячеек пула найденных узлов в порядке возрастания.
+std::vector<unsigned int> PipeTrackSpatialIndex::findSlotIndexesInRing(const Point & point, unsigned int ring) const {
+    
+    std::vector<unsigned int> slotIndexes;
+    long long pointColumn = cellNumberOf(point.x), pointRow = cellNumberOf(point.y);
+    long long firstColumn = pointColumn - ring, lastColumn = pointColumn + ring;
+    long long firstRow = pointRow - ring, lastRow = pointRow + ring;
+    
+    for (long long column = std::max(firstColumn, minColumn); column <= std::min(lastColumn, maxColumn); column++) {
+        if (column == firstColumn || column == lastColumn) {
+            // крайний столбец кольца просматривается целиком
+            for (long long row = std::max(firstRow, minRow); row <= std::min(lastRow, maxRow); row++) {
+                appendSlotIndexesOfCell(column, row, slotIndexes);
+            }
+        } else {
+            // для остальных столбцов просматриваются только нижняя и верхняя ячейки кольца
+            if (minRow <= firstRow && firstRow <= maxRow) {
+                appendSlotIndexesOfCell(column, firstRow, slotIndexes);
+            }
+            if (ring > 0 && minRow <= lastRow && lastRow <= maxRow) {
+                appendSlotIndexesOfCell(column, lastRow, slotIndexes);
+            }
+        }
+    }
+    
+    std::sort(slotIndexes.begin(), slotIndexes.end());
+    slotIndexes.erase(std::unique(slotIndexes.begin(), slotIndexes.end()), slotIndexes.end());
+    return slotIndexes;
+    
+}
+
+/// Вычислить наибольший номер кольца ячеек вокруг точки, содержащего ячейки, в которых регистрировались узлы.
+///
+/// \param point Точка (единица измерения - мм.). Z-координата не учитывается.
+///
+/// \return Номер кольца или -1, если в индексе никогда не было узлов.
+long long PipeTrackSpatialIndex::calculateLastRing(const Point & point) const {
+    
+    if (minColumn > maxColumn) {
+        return -1;
+    }
+    
+    long long pointColumn = cellNumberOf(point.x), pointRow = cellNumberOf(point.y);
+    return std::max(std::max(pointColumn - minColumn, maxColumn - pointColumn), std::max(pointRow - minRow, maxRow - pointRow));
+    
+}
+
+/// Вычислить номер столбца или строки ячейки сетки, содержащей координату.
+///
+/// \param coordinate Координата (единица измерения - мм.).
+///
+/// \return Номер столбца или строки.
+long long PipeTrackSpatialIndex::cellNumberOf(CalcNumber coordinate) const {
+    
+    return static_cast<long long>(std::floor(coordinate / cellSize));
+    
+}
+
+/// Добавить к массиву индексы ячеек пула узлов, зарегистрированных в ячейке сетки.
+///
+/// \param column Номер столбца ячейки.
+/// \param row Номер строки ячейки.
+/// \param slotIndexes Массив, к которому добавляются индексы.
+void PipeTrackSpatialIndex::appendSlotIndexesOfCell(long long column, long long row, std::vector<unsigned int> & slotIndexes) const {
+    
+    auto cellIter = slotIndexesForCell.find(std::make_pair(column, row));
+    if (cellIter != slotIndexesForCell.end()) {
+        slotIndexes.insert(slotIndexes.end(), cellIter->second.begin(), cellIter->second.end());
+    }
+    
+}
+
+#endif /* PipeTrackSpatialIndex_hpp */
@@ -0,0 +1,114 @@
+#ifndef PipeTrackTester_hpp
+#define PipeTrackTester_hpp
+
+// Подключение стандартных библиотек
+#include <string>
+#include <iostream>
+#include <vector>
+#include <map>
+#include <cassert>
+
+// Подключение внутренних типов
+#include "PipeTrack.hpp"
+#include "DirectPipe.hpp"
+
+/// Тестер для пула узлов класса PipeTrack.
+class PipeTrackTester {
+    
+public:
+    
+    // MARK: - Открытые методы
+    
+    /// Тестировать пул узлов класса PipeTrack.
+    void test();
+    
+};
+
+// MARK: - Реализация
+
+/// Тестировать пул узлов класса PipeTrack.
+void PipeTrackTester::test() {
+    
+    typedef PipeTrack::NodeHandle NodeHandle;
+    
+    std::map<unsigned int, unsigned int> externalDiameterForDiameter = { { 50, 54 } };
+    DirectPipe directPipe(50, 1, "Труба", 2, &externalDiameterForDiameter);
+    Point zero = Point(0, 0, 0), ox = Point(1, 0, 0);
+    
+    // три узла: 0 -> 1 -> 2 (корень)
+    PipeTrack pipeTrack(nullptr, 1000);
+    PipeTrackNode * node0P = pipeTrack.createNodeAndReturnP(direct, &directPipe, zero, Point(0, 0, 0), Point(100, 0, 0), ox, ox, ox);
+    PipeTrackNode * node1P = pipeTrack.createNodeAndReturnP(direct, &directPipe, zero, Point(100, 0, 0), Point(200, 0, 0), ox, ox, ox);
+    PipeTrackNode * node2P = pipeTrack.createNodeAndReturnP(direct, &directPipe, zero, Point(200, 0, 0), Point(300, 0, 0), ox, ox, ox);
+    node0P->nextNodeP = node1P;
+    node1P->basePrevNodeP = node0P;
+    node1P->nextNodeP = node2P;
+    node2P->basePrevNodeP = node1P;
+    pipeTrack.rootNodeP = node2P;
+    NodeHandle handle0 = pipeTrack.handleOf(node0P);
+    NodeHandle handle1 = pipeTrack.handleOf(node1P);
+    NodeHandle handle2 = pipeTrack.handleOf(node2P);
+    assert(pipeTrack.nodePForHandle(handle0) == node0P && pipeTrack.nodePForHandle(handle1) == node1P && pipeTrack.nodePForHandle(handle2) == node2P);
+    
+    // удаление среднего узла: связи разрываются, на его место в nodePs переносится последний узел
+    pipeTrack.removeNode(node1P);
+    assert(pipeTrack.nodePs.size() == 2);
+    assert(pipeTrack.nodePs[0] == node0P && pipeTrack.nodePs[1] == node2P);
+    assert(node0P->nextNodeP == nullptr && node2P->basePrevNodeP == nullptr);
+    
+    // дескриптор удаленного узла недействителен, дескрипторы остальных узлов действительны
+    assert(pipeTrack.nodePForHandle(handle1) == nullptr);
+    assert(pipeTrack.nodePForHandle(handle0) == node0P && pipeTrack.nodePForHandle(handle2) == node2P);
+    
+    // ближайшая точка центральных отрезков не ищется в удаленном узле
+    Point nearestCenterPoint;
+    const PipeTrackNode * nearestNodeP = nullptr;
+    assert(pipeTrack.findNearestCenterPoint2D(Point(150, 50, 0), nearestCenterPoint, nearestNodeP));
+    assert(nearestNodeP != node1P);
+    
+    // повторное удаление и удаление nullptr ничего не меняют
+    pipeTrack.removeNode(node1P);
+    pipeTrack.removeNode(nullptr);
+    assert(pipeTrack.nodePs.size() == 2);
+    
+    // новый узел занимает освободившуюся ячейку, но старый дескриптор ячейки остается недействительным
+    PipeTrackNode * node3P = pipeTrack.createNodeAndReturnP(direct, &directPipe, zero, Point(0, 100, 0), Point(0, 200, 0), ox, ox, ox);
+    assert(node3P == node1P);
+    NodeHandle handle3 = pipeTrack.handleOf(node3P);
+    assert(handle3.slotIndex == handle1.slotIndex && handle3.generation != handle1.generation);
+    assert(pipeTrack.nodePForHandle(handle1) == nullptr);
+    assert(pipeTrack.nodePForHandle(handle3) == node3P);
+    assert(pipeTrack.nodePs.size() == 3 && pipeTrack.nodePs[2] == node3P);
+    assert(node3P->nextNodeP == nullptr && node3P->basePrevNodeP == nullptr && node3P->startPoint == Point(0, 100, 0));
+    
+    // рост пула за границу блока из 64 ячеек: узлы не перемещаются, дескрипторы остаются действительными
+    std::vector<PipeTrackNode*> grownNodePs;
+    std::vector<NodeHandle> grownHandles;
+    for (int i = 0; i < 200; i++) {
+        PipeTrackNode * nodeP = pipeTrack.createNodeAndReturnP(direct, &directPipe, zero, Point(i * 10, 1000, 0), Point(i * 10 + 10, 1000, 0), ox, ox, ox);
+        grownNodePs.push_back(nodeP);
+        grownHandles.push_back(pipeTrack.handleOf(nodeP));
+    }
+    assert(pipeTrack.nodePs.size() == 203);
+    assert(pipeTrack.nodePForHandle(handle0) == node0P && node0P->startPoint == Point(0, 0, 0));
+    for (int i = 0; i < 200; i++) {
+        assert(pipeTrack.nodePForHandle(grownHandles[i]) == grownNodePs[i]);
+        assert(grownNodePs[i]->startPoint == Point(i * 10, 1000, 0));
+    }
+    
+    // копия трассы разрешает те же дескрипторы в собственные узлы
+    PipeTrack copiedPipeTrack(pipeTrack);
+    assert(copiedPipeTrack.nodePs.size() == 203);
+    assert(copiedPipeTrack.nodePForHandle(handle1) == nullptr);
+    for (int i = 0; i < 200; i += 61) {
+        PipeTrackNode * copiedNodeP = copiedPipeTrack.nodePForHandle(grownHandles[i]);
+        assert(copiedNodeP != nullptr && copiedNodeP != grownNodePs[i]);
+        assert(copiedNodeP->startPoint == grownNodePs[i]->startPoint);
+    }
+    assert(copiedPipeTrack.rootNodeP == copiedPipeTrack.nodePForHandle(handle2));
+    
+    std::cout << "Тестирование пула узлов класса PipeTrack завершилось успешно.\n";
+    
+}
+
+#endif /* PipeTrackTester_hpp */
@@ -32,6 +32,12 @@ int main(int argc, const char * argv[]) {
     LineTester().test();
     PlaneTester().test();
     SimplePipeTrackTester().test();
+    PortalFunnelTester().test();
+    LocationPolygonDecomposerTester().test();
+    PipeTrackNodeTester().test();
+    PersistentPipeTrackTester().test();
+    PipeTrackTester().test();
+    PipeTrackLocationIndexTester().test();
     */
     
     /// Объект, отвечающий за вывод сообщений и ошибок.
@@ -92,7 +98,11 @@ int main(int argc, const char * argv[]) {
         view.printMessage("\n----------------------------------------------------------------------------------------------------------");
         
         // Вычисление оптимальной трассы системы водоотведения.
-        PipeTrack optimalPipeTrack = optimalPipeTrackFinder.calculateOptimalPipeTrack();
+        OptimalPipeTrackResult optimalPipeTrackResult = optimalPipeTrackFinder.calculateOptimalPipeTrack();
+        PipeTrack & optimalPipeTrack = optimalPipeTrackResult.pipeTrack;
+        if (optimalPipeTrackResult.isCompleted == false) {
+            view.printMessage("\nВычисление оптимальной трассы не завершено, выводится лучшая найденная трасса.");
+        }
         
         // Вывод найденной трассы.
         optimalPipeTrack.print2D();